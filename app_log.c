@@ -0,0 +1,703 @@
+/*******************************************************************************
+ * File Name:   app_log.c
+ *
+ * Description: This file contains the binary deferred logger. Instead of
+ * formatting the message on the target, a log call writes a record with the
+ * address of the format string and the raw argument words into a lock-free
+ * ring. A low priority task drains the ring to the debug UART as binary
+ * frames, and app_log_decode.py rebuilds the text on the host from the
+ * format strings in the application ELF file.
+ *
+ * String arguments which are in the flash are logged by their address, like
+ * the format string. Other strings, such as the ones in a RAM buffer, are
+ * copied into the record.
+ *
+ * While the network stack is suspended, records less severe than
+ * APP_LOG_SUSPENDED_LEVEL stay in the ring without waking up the drain task,
+ * and are sent in one burst on the next wake.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+
+/* Include header files */
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdarg.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* BSP & HAL includes. */
+#include "cy_device_headers.h"
+#include "cyhal.h"
+#include "cy_retarget_io.h"
+
+#include "app_log.h"
+#include "log_uart_dma.h"
+#include "retained_log.h"
+#include "wifi_config.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Record header: sync (bits 31:24), level (23:20), flags (19:16), and the size
+ * of the record in words including the header (15:0). The header is written
+ * last, so a record is complete once its header is valid. The ring words are
+ * zero until they are reserved, since the drain task clears every word of the
+ * records it releases.
+ */
+#define APP_LOG_RECORD_SYNC                  (0xA5UL)
+#define APP_LOG_HEADER(level, flags, words)  ((APP_LOG_RECORD_SYNC << 24) | \
+                                              (((uint32_t)(level) & 0xFUL) << 20) | \
+                                              (((uint32_t)(flags) & 0xFUL) << 16) | \
+                                              ((uint32_t)(words) & 0xFFFFUL))
+#define APP_LOG_HEADER_IS_VALID(header)      (APP_LOG_RECORD_SYNC == ((header) >> 24))
+#define APP_LOG_HEADER_FLAGS(header)         (((header) >> 16) & 0xFUL)
+#define APP_LOG_HEADER_WORDS(header)         ((header) & 0xFFFFUL)
+
+/* Record flags. */
+#define APP_LOG_FLAG_PADDING                 (0x1UL) /* Unused space at the end of the ring. */
+#define APP_LOG_FLAG_TRUNCATED               (0x2UL) /* Arguments did not fit in the record. */
+#define APP_LOG_FLAG_DROPPED                 (0x4UL) /* Number of records dropped on a full ring. */
+
+/* Words of a record before the format string: header and tick count. */
+#define APP_LOG_RECORD_PREFIX_WORDS          (2)
+
+/* A string outside the flash is copied into the record after a word which
+ * holds this tag and the string length. Flash addresses never match the tag.
+ */
+#define APP_LOG_INLINE_STRING_TAG            (0xA5000000UL)
+#define APP_LOG_IN_FLASH(ptr)                (((uint32_t)(ptr) >= CY_FLASH_BASE) && \
+                                              ((uint32_t)(ptr) < (CY_FLASH_BASE + CY_FLASH_SIZE)))
+
+/* UART frame: two sync bytes, the record size in words, the record in little
+ * endian, and the 8-bit sum of the size and the record bytes.
+ */
+#define APP_LOG_FRAME_SYNC_0                 (0xA5)
+#define APP_LOG_FRAME_SYNC_1                 (0x5A)
+#define APP_LOG_FRAME_OVERHEAD               (4)
+
+#define APP_LOG_TX_BUFFER_SIZE               (512)
+
+#define APP_LOG_RING_MASK                    (APP_LOG_RING_WORDS - 1)
+
+/*******************************************************************************
+ * Static Global Structures and variables
+ ******************************************************************************/
+/* Record under construction. */
+typedef struct
+{
+    uint32_t words[APP_LOG_MAX_RECORD_WORDS];
+    uint32_t count;
+    bool truncated;
+} app_log_record_t;
+
+static uint32_t app_log_ring[APP_LOG_RING_WORDS];
+
+/* Free running word indexes. The head is advanced by the producers when they
+ * reserve a record, and the tail by the drain task.
+ */
+static volatile uint32_t app_log_head = 0;
+static volatile uint32_t app_log_tail = 0;
+static volatile uint32_t app_log_dropped = 0;
+
+static TaskHandle_t app_log_task_handle = NULL;
+
+/* Set while the network stack is suspended. */
+static volatile bool app_log_deferred = false;
+
+/*******************************************************************************
+ * Function definitions
+ ******************************************************************************/
+/*******************************************************************************
+* Function Name: app_log_put_word
+********************************************************************************
+* Summary:
+*  Appends a word to the record, or marks it truncated if it is full.
+*
+* Parameters:
+*  record : Record under construction.
+*  word   : Word to append.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void app_log_put_word(app_log_record_t *record, uint32_t word)
+{
+    if (APP_LOG_MAX_RECORD_WORDS > record->count)
+    {
+        record->words[record->count++] = word;
+    }
+    else
+    {
+        record->truncated = true;
+    }
+}
+
+/*******************************************************************************
+* Function Name: app_log_put_string
+********************************************************************************
+* Summary:
+*  Appends a string to the record, by its address if it is in the flash, or
+*  copied into the record otherwise.
+*
+* Parameters:
+*  record : Record under construction.
+*  str    : String to append.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void app_log_put_string(app_log_record_t *record, const char *str)
+{
+    uint32_t room;
+    uint32_t length;
+
+    if ((NULL == str) || APP_LOG_IN_FLASH(str))
+    {
+        app_log_put_word(record, (uint32_t)str);
+        return;
+    }
+
+    if (APP_LOG_MAX_RECORD_WORDS <= (record->count + 1))
+    {
+        record->truncated = true;
+        return;
+    }
+
+    room = (APP_LOG_MAX_RECORD_WORDS - record->count - 1) * sizeof(uint32_t);
+    length = strnlen(str, room);
+    if ((room == length) && ('\0' != str[length]))
+    {
+        record->truncated = true;
+    }
+
+    record->words[record->count++] = APP_LOG_INLINE_STRING_TAG | length;
+    if (0 != (length & 0x3))
+    {
+        record->words[record->count + (length >> 2)] = 0;
+    }
+    memcpy(&record->words[record->count], str, length);
+    record->count += (length + 3) >> 2;
+}
+
+/*******************************************************************************
+* Function Name: app_log_put_args
+********************************************************************************
+* Summary:
+*  Appends the raw arguments of the format string to the record. The format
+*  string is only scanned for the size of each argument, nothing is formatted.
+*
+* Parameters:
+*  record : Record under construction.
+*  fmt    : printf style format string.
+*  args   : Arguments of the format string.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void app_log_put_args(app_log_record_t *record, const char *fmt, va_list args)
+{
+    const char *ptr = fmt;
+    bool wide;
+    bool long_double;
+    uint64_t value64;
+    double value_double;
+
+    while (('\0' != *ptr) && !record->truncated)
+    {
+        if ('%' != *ptr++)
+        {
+            continue;
+        }
+
+        if ('%' == *ptr)
+        {
+            ptr++;
+            continue;
+        }
+
+        /* Flags, width, and precision. A '*' takes an int argument. */
+        while (('\0' != *ptr) && (NULL != strchr("-+ #0", *ptr)))
+        {
+            ptr++;
+        }
+        if ('*' == *ptr)
+        {
+            app_log_put_word(record, (uint32_t)va_arg(args, int));
+            ptr++;
+        }
+        while (('0' <= *ptr) && ('9' >= *ptr))
+        {
+            ptr++;
+        }
+        if ('.' == *ptr)
+        {
+            ptr++;
+            if ('*' == *ptr)
+            {
+                app_log_put_word(record, (uint32_t)va_arg(args, int));
+                ptr++;
+            }
+            while (('0' <= *ptr) && ('9' >= *ptr))
+            {
+                ptr++;
+            }
+        }
+
+        /* Length modifier. Only long long and intmax_t are wider than a word. */
+        wide = false;
+        long_double = false;
+        while (('\0' != *ptr) && (NULL != strchr("hlLjzt", *ptr)))
+        {
+            wide = wide || ('j' == *ptr) || (('l' == *ptr) && ('l' == *(ptr + 1)));
+            long_double = long_double || ('L' == *ptr);
+            ptr++;
+        }
+
+        switch (*ptr)
+        {
+            case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': case 'c':
+                if (wide)
+                {
+                    value64 = va_arg(args, uint64_t);
+                    app_log_put_word(record, (uint32_t)value64);
+                    app_log_put_word(record, (uint32_t)(value64 >> 32));
+                }
+                else
+                {
+                    app_log_put_word(record, va_arg(args, uint32_t));
+                }
+                break;
+
+            case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+                value_double = long_double ? (double)va_arg(args, long double) : va_arg(args, double);
+                memcpy(&value64, &value_double, sizeof(value64));
+                app_log_put_word(record, (uint32_t)value64);
+                app_log_put_word(record, (uint32_t)(value64 >> 32));
+                break;
+
+            case 's':
+                app_log_put_string(record, va_arg(args, const char *));
+                break;
+
+            case 'p':
+                app_log_put_word(record, (uint32_t)va_arg(args, void *));
+                break;
+
+            case 'n':
+                (void)va_arg(args, void *);
+                break;
+
+            default:
+                /* Unknown conversion. The rest of the arguments can not be sized. */
+                record->truncated = true;
+                return;
+        }
+
+        ptr++;
+    }
+}
+
+/*******************************************************************************
+* Function Name: app_log_reserve
+********************************************************************************
+* Summary:
+*  Reserves space for a record in the ring. This is lock-free, and can be
+*  called from any task or interrupt. If the record does not fit before the
+*  end of the ring, the remaining space is filled with a padding record and the
+*  record is placed at the start of the ring.
+*
+* Parameters:
+*  words : Size of the record in words.
+*  index : Ring index of the reserved space.
+*
+* Return:
+*  bool: true if the space is reserved, false if the ring is full.
+*
+*******************************************************************************/
+static bool app_log_reserve(uint32_t words, uint32_t *index)
+{
+    uint32_t head;
+    uint32_t position;
+    uint32_t padding;
+    uint32_t next;
+
+    do
+    {
+        head = __LDREXW(&app_log_head);
+        position = head & APP_LOG_RING_MASK;
+        padding = ((position + words) > APP_LOG_RING_WORDS) ? (APP_LOG_RING_WORDS - position) : 0;
+        next = head + padding + words;
+
+        if ((next - app_log_tail) > APP_LOG_RING_WORDS)
+        {
+            __CLREX();
+            return false;
+        }
+    } while (0 != __STREXW(next, &app_log_head));
+
+    if (0 != padding)
+    {
+        app_log_ring[position] = APP_LOG_HEADER(0, APP_LOG_FLAG_PADDING, padding);
+    }
+
+    *index = (head + padding) & APP_LOG_RING_MASK;
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: app_log_count_dropped
+********************************************************************************
+* Summary:
+*  Atomically adds to the number of records dropped on a full ring.
+*
+* Parameters:
+*  count : Number of records to add. A negative value subtracts.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void app_log_count_dropped(int32_t count)
+{
+    uint32_t dropped;
+
+    do
+    {
+        dropped = __LDREXW(&app_log_dropped);
+    } while (0 != __STREXW(dropped + (uint32_t)count, &app_log_dropped));
+}
+
+/*******************************************************************************
+* Function Name: app_log_write
+********************************************************************************
+* Summary:
+*  Writes a log record with the format string and the raw arguments to the
+*  ring, and wakes up the drain task. The record is dropped if the ring is
+*  full. This can be called from any task or interrupt.
+*
+* Parameters:
+*  level : APP_LOG_LEVEL_ERROR or APP_LOG_LEVEL_INFO.
+*  fmt   : printf style format string.
+*  ...   : Arguments of the format string.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void app_log_write(uint8_t level, const char *fmt, ...)
+{
+    app_log_record_t record;
+    BaseType_t in_isr = xPortIsInsideInterrupt();
+    BaseType_t higher_priority_task_woken = pdFALSE;
+    uint32_t index;
+    va_list args;
+
+    record.count = APP_LOG_RECORD_PREFIX_WORDS;
+    record.truncated = false;
+    record.words[1] = in_isr ? xTaskGetTickCountFromISR() : xTaskGetTickCount();
+
+    app_log_put_string(&record, fmt);
+    va_start(args, fmt);
+    app_log_put_args(&record, fmt, args);
+    va_end(args);
+
+    record.words[0] = APP_LOG_HEADER(level, (record.truncated ? APP_LOG_FLAG_TRUNCATED : 0), record.count);
+    retained_log_capture_record(level, record.words, record.count);
+
+    if (!app_log_reserve(record.count, &index))
+    {
+        app_log_count_dropped(1);
+        return;
+    }
+
+    /* The ring index is word aligned and the record never wraps. */
+    memcpy(&app_log_ring[index + 1], &record.words[1], (record.count - 1) * sizeof(uint32_t));
+    __DMB();
+    app_log_ring[index] = record.words[0];
+
+    if ((NULL != app_log_task_handle) && (!app_log_deferred || (APP_LOG_SUSPENDED_LEVEL >= level)))
+    {
+        if (in_isr)
+        {
+            vTaskNotifyGiveFromISR(app_log_task_handle, &higher_priority_task_woken);
+            portYIELD_FROM_ISR(higher_priority_task_woken);
+        }
+        else if (taskSCHEDULER_RUNNING == xTaskGetSchedulerState())
+        {
+            xTaskNotifyGive(app_log_task_handle);
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: app_log_put_frame
+********************************************************************************
+* Summary:
+*  Appends a record to the transmit buffer as a UART frame.
+*
+* Parameters:
+*  buffer : Transmit buffer.
+*  length : Current length of the transmit buffer.
+*  record : Record words.
+*  words  : Size of the record in words.
+*
+* Return:
+*  size_t: New length of the transmit buffer.
+*
+*******************************************************************************/
+static size_t app_log_put_frame(uint8_t *buffer, size_t length, const volatile uint32_t *record, uint32_t words)
+{
+    uint8_t checksum = (uint8_t)words;
+    uint32_t word;
+    uint32_t index;
+    uint32_t byte;
+
+    buffer[length++] = APP_LOG_FRAME_SYNC_0;
+    buffer[length++] = APP_LOG_FRAME_SYNC_1;
+    buffer[length++] = (uint8_t)words;
+
+    for (index = 0; index < words; index++)
+    {
+        word = record[index];
+        for (byte = 0; byte < sizeof(uint32_t); byte++)
+        {
+            buffer[length] = (uint8_t)(word >> (8 * byte));
+            checksum += buffer[length++];
+        }
+    }
+
+    buffer[length++] = checksum;
+
+    return length;
+}
+
+/*******************************************************************************
+* Function Name: app_log_fill_tx_buffer
+********************************************************************************
+* Summary:
+*  Moves the complete records from the ring to the transmit buffer as UART
+*  frames, and releases their space in the ring. A record for the number of
+*  dropped records is added first, if any were dropped.
+*
+* Parameters:
+*  buffer : Transmit buffer.
+*  size   : Size of the transmit buffer.
+*
+* Return:
+*  size_t: Number of bytes in the transmit buffer.
+*
+*******************************************************************************/
+static size_t app_log_fill_tx_buffer(uint8_t *buffer, size_t size)
+{
+    uint32_t dropped_record[APP_LOG_RECORD_PREFIX_WORDS + 2];
+    uint32_t dropped = app_log_dropped;
+    size_t length = 0;
+    uint32_t tail;
+    uint32_t position;
+    uint32_t header;
+    uint32_t words;
+
+    if (0 != dropped)
+    {
+        dropped_record[0] = APP_LOG_HEADER(APP_LOG_LEVEL_ERROR, APP_LOG_FLAG_DROPPED, sizeof(dropped_record) / sizeof(uint32_t));
+        dropped_record[1] = xTaskGetTickCount();
+        dropped_record[2] = 0;
+        dropped_record[3] = dropped;
+        length = app_log_put_frame(buffer, length, dropped_record, sizeof(dropped_record) / sizeof(uint32_t));
+        app_log_count_dropped(-(int32_t)dropped);
+    }
+
+    while (app_log_tail != app_log_head)
+    {
+        tail = app_log_tail;
+        position = tail & APP_LOG_RING_MASK;
+        header = app_log_ring[position];
+
+        /* The record is reserved but not written yet. */
+        if (!APP_LOG_HEADER_IS_VALID(header))
+        {
+            break;
+        }
+        __DMB();
+
+        words = APP_LOG_HEADER_WORDS(header);
+        if (0 == (APP_LOG_HEADER_FLAGS(header) & APP_LOG_FLAG_PADDING))
+        {
+            if ((length + (words * sizeof(uint32_t)) + APP_LOG_FRAME_OVERHEAD) > size)
+            {
+                break;
+            }
+            length = app_log_put_frame(buffer, length, &app_log_ring[position], words);
+        }
+
+        /* Clears the whole record, not only its header. A later record can
+         * be reserved at any word of it, and a stale word there must not read
+         * as a valid header before the producer has written the real one.
+         */
+        memset(&app_log_ring[position], 0, words * sizeof(uint32_t));
+        __DMB();
+        app_log_tail = tail + words;
+    }
+
+    return length;
+}
+
+/*******************************************************************************
+* Function Name: app_log_flush
+********************************************************************************
+* Summary:
+*  Sends all the complete records in the ring to the debug UART, without DMA.
+*  This is called by the drain task if LOG_UART_DMA is disabled, and can be
+*  called directly before a reset or in
+*  a fatal error handler, when the drain task does not run anymore.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void app_log_flush(void)
+{
+    static uint8_t tx_buffer[APP_LOG_TX_BUFFER_SIZE];
+    size_t length;
+
+    while (0 != (length = app_log_fill_tx_buffer(tx_buffer, sizeof(tx_buffer))))
+    {
+        (void)cyhal_uart_write(&cy_retarget_io_uart_obj, tx_buffer, &length);
+    }
+}
+
+/*******************************************************************************
+* Function Name: app_log_set_deferred
+********************************************************************************
+* Summary:
+*  Defers the draining of the records less severe than APP_LOG_SUSPENDED_LEVEL
+*  while the network stack is suspended. When the deferral ends, the drain task
+*  sends all the buffered records in one burst.
+*
+* Parameters:
+*  deferred : true before the network stack is suspended, false after it has
+*             resumed.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void app_log_set_deferred(bool deferred)
+{
+    bool was_deferred = app_log_deferred;
+
+    app_log_deferred = deferred;
+
+    if (was_deferred && !deferred && (NULL != app_log_task_handle))
+    {
+        xTaskNotifyGive(app_log_task_handle);
+    }
+}
+
+/*******************************************************************************
+* Function Name: app_log_task
+********************************************************************************
+* Summary:
+*  Drains the log ring to the debug UART whenever a record is written.
+*
+* Parameters:
+*  arg : Unused.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void app_log_task(void *arg)
+{
+#if LOG_UART_DMA
+    static uint8_t tx_buffer[APP_LOG_TX_BUFFER_SIZE];
+    size_t length;
+#endif
+
+    (void)arg;
+
+    while (true)
+    {
+        (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+#if LOG_UART_DMA
+        /* Shares the DMA output with the logging task, so that the frames are
+         * not interleaved with the text output. */
+        while (0 != (length = app_log_fill_tx_buffer(tx_buffer, sizeof(tx_buffer))))
+        {
+            log_uart_dma_write(tx_buffer, length);
+        }
+#else
+        app_log_flush();
+#endif
+    }
+}
+
+/*******************************************************************************
+* Function Name: app_log_init
+********************************************************************************
+* Summary:
+*  Creates the task which drains the log ring. Records written before this are
+*  kept in the ring and sent with the first records after it.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  cy_rslt_t: Returns CY_RSLT_SUCCESS if the drain task is created. Otherwise,
+*  it returns CY_RSLT_TYPE_ERROR.
+*
+*******************************************************************************/
+cy_rslt_t app_log_init(void)
+{
+    if (pdPASS != xTaskCreate(app_log_task, "AppLog", APP_LOG_TASK_STACK_SIZE, NULL,
+                              APP_LOG_TASK_PRIORITY, &app_log_task_handle))
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    /* Sends the records written before the drain task was created. */
+    xTaskNotifyGive(app_log_task_handle);
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+/* [] END OF FILE */
+
@@ -0,0 +1,76 @@
+/******************************************************************************
+* File Name: app_log.h
+*
+* Description: This file contains the interface of the binary deferred logger
+* used by the APP_INFO and ERR_INFO macros when APP_LOG_BINARY is enabled.
+*
+******************************************************************************
+* Copyright (2020), Cypress Semiconductor Corporation.
+******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death (“High Risk Product”). By
+* including Cypress’s product in a High Risk Product, the manufacturer of such
+* system or application assumes all risk of such use and in doing so agrees to
+* indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef _APP_LOG_H_
+#define _APP_LOG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_result.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Size of the log ring in 32-bit words. Must be a power of two. */
+#define APP_LOG_RING_WORDS                   (1024)
+
+/* Maximum size of one log record in 32-bit words, including the header.
+ * Arguments which do not fit are dropped and the record is marked truncated.
+ */
+#define APP_LOG_MAX_RECORD_WORDS             (64)
+
+/* Stack size and priority of the task which drains the log ring to the UART. */
+#define APP_LOG_TASK_STACK_SIZE              (configMINIMAL_STACK_SIZE * 2)
+#define APP_LOG_TASK_PRIORITY                (tskIDLE_PRIORITY)
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+cy_rslt_t app_log_init(void);
+void app_log_write(uint8_t level, const char *fmt, ...);
+void app_log_flush(void);
+void app_log_set_deferred(bool deferred);
+
+#endif /* _APP_LOG_H_ */
+
+
+/* [] END OF FILE */
+
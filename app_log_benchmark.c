@@ -0,0 +1,154 @@
+/*******************************************************************************
+ * File Name:   app_log_benchmark.c
+ *
+ * Description: This file contains the logging benchmark. It measures the CPU
+ * cycles spent by the calling task per log line with the DWT cycle counter,
+ * for the former two-call form of APP_INFO (level prefix and message sent as
+ * separate logging task records), the single-record text form which also
+ * keeps the record in the retained log, and the binary deferred logger when
+ * it is enabled. The time spent later by the
+ * logging task is not included.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+
+/* Include header files */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* BSP & HAL includes. */
+#include "cy_device_headers.h"
+
+#include "app_log_benchmark.h"
+#include "wifi_config.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Number of log lines per method. The two-call form uses two logging task
+ * queue entries per line, which must fit in the logging queue.
+ */
+#define APP_LOG_BENCHMARK_LINES              (16)
+
+/* Time for the logging task to print the lines of a method. */
+#define APP_LOG_BENCHMARK_DRAIN_MS           (1000)
+
+/*******************************************************************************
+ * Function definitions
+ ******************************************************************************/
+/*******************************************************************************
+* Function Name: app_log_benchmark_start_cycle_counter
+********************************************************************************
+* Summary:
+*  Enables the DWT cycle counter.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void app_log_benchmark_start_cycle_counter(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/*******************************************************************************
+* Function Name: app_log_benchmark_run
+********************************************************************************
+* Summary:
+*  Logs APP_LOG_BENCHMARK_LINES lines with each logging method and prints the
+*  average number of CPU cycles per line. The scheduler is suspended while a
+*  line is written, so that only the cost of the log call is counted.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void app_log_benchmark_run(void)
+{
+    uint32_t two_call_cycles = 0;
+    uint32_t single_record_cycles = 0;
+    uint32_t binary_cycles = 0;
+    uint32_t start;
+    uint32_t line;
+
+    app_log_benchmark_start_cycle_counter();
+
+    for (line = 0; line < APP_LOG_BENCHMARK_LINES; line++)
+    {
+        vTaskSuspendAll();
+        start = DWT->CYCCNT;
+        configPRINTF(("Info: "));
+        configPRINTF(("Log benchmark line %lu\n", (unsigned long)line));
+        two_call_cycles += DWT->CYCCNT - start;
+        (void)xTaskResumeAll();
+    }
+    vTaskDelay(pdMS_TO_TICKS(APP_LOG_BENCHMARK_DRAIN_MS));
+
+    for (line = 0; line < APP_LOG_BENCHMARK_LINES; line++)
+    {
+        vTaskSuspendAll();
+        start = DWT->CYCCNT;
+        APP_LOG_TEXT_INFO("Log benchmark line %lu\n", (unsigned long)line);
+        single_record_cycles += DWT->CYCCNT - start;
+        (void)xTaskResumeAll();
+    }
+    vTaskDelay(pdMS_TO_TICKS(APP_LOG_BENCHMARK_DRAIN_MS));
+
+#if APP_LOG_BINARY
+    for (line = 0; line < APP_LOG_BENCHMARK_LINES; line++)
+    {
+        vTaskSuspendAll();
+        start = DWT->CYCCNT;
+        app_log_write(APP_LOG_LEVEL_INFO, "Log benchmark line %lu\n", (unsigned long)line);
+        binary_cycles += DWT->CYCCNT - start;
+        (void)xTaskResumeAll();
+    }
+    vTaskDelay(pdMS_TO_TICKS(APP_LOG_BENCHMARK_DRAIN_MS));
+#endif
+
+    APP_LOG_TEXT_INFO("Log benchmark: two-call %lu, single-record %lu, binary %lu cycles per line\n",
+                      (unsigned long)(two_call_cycles / APP_LOG_BENCHMARK_LINES),
+                      (unsigned long)(single_record_cycles / APP_LOG_BENCHMARK_LINES),
+                      (unsigned long)(binary_cycles / APP_LOG_BENCHMARK_LINES));
+}
+
+
+/* [] END OF FILE */
+
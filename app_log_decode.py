@@ -0,0 +1,292 @@
+#******************************************************************************
+# File Name:   app_log_decode.py
+#
+# Description: Host decoder for the binary deferred logs of app_log.c.
+# It reads the debug UART output, or a capture of it, rebuilds the text of
+# the binary log records from the format strings in the application ELF file,
+# and passes any other text through unchanged.
+#
+#******************************************************************************
+# (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+#******************************************************************************
+# This software, including source code, documentation and related materials
+# ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+# subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+# protection (United States and foreign), United States copyright laws and
+# international treaty provisions. Therefore, you may use this Software only
+# as provided in the license agreement accompanying the software package from
+# which you obtained this Software ("EULA").
+#
+# If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+# non-transferable license to copy, modify, and compile the Software source
+# code solely for use in connection with Cypress's integrated circuit products.
+# Any reproduction, modification, translation, compilation, or representation
+# of this Software except as specified above is prohibited without the express
+# written permission of Cypress.
+#
+# Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+# EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+# reserves the right to make changes to the Software without notice. Cypress
+# does not assume any liability arising out of the application or use of the
+# Software or any product or circuit described in the Software. Cypress does
+# not authorize its products for use in any products where a malfunction or
+# failure of the Cypress product may reasonably be expected to result in
+# significant property damage, injury or death ("High Risk Product"). By
+# including Cypress's product in a High Risk Product, the manufacturer of such
+# system or application assumes all risk of such use and in doing so agrees to
+# indemnify Cypress against all liability.
+#******************************************************************************/
+
+#!/usr/bin/python
+
+"""
+Host decoder for the binary deferred logs of app_log.c.
+
+Usage:
+    python app_log_decode.py -e <application>.elf -p COM3
+    python app_log_decode.py -e <application>.elf -f capture.bin
+    python app_log_decode.py -e <application>.elf -r crash_report.txt
+
+The serial port option needs the pyserial package.
+"""
+
+import optparse
+import re
+import struct
+import sys
+
+# Must match app_log.c.
+RECORD_SYNC = 0xA5
+FLAG_PADDING = 0x1
+FLAG_TRUNCATED = 0x2
+FLAG_DROPPED = 0x4
+INLINE_STRING_TAG = 0xA5000000
+INLINE_STRING_MASK = 0xFF000000
+FRAME_SYNC = b'\xa5\x5a'
+LEVEL_NAMES = {1: "Error", 2: "Info"}
+
+# printf conversion specification.
+REPORT_RECORD = re.compile(r'Log: (\d+) bin ([0-9a-f]+)')
+
+CONVERSION = re.compile(r'%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d*))?([hlLjzt]*)([diouxXcsfFeEgGaApn%])')
+
+class ElfImage:
+    """Loadable sections of an ELF32 little endian file, used to read the
+    format strings and the constant string arguments by their address."""
+
+    SHT_PROGBITS = 1
+    SHF_ALLOC = 0x2
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+
+        if self.data[0:4] != b'\x7fELF' or self.data[4] != 1 or self.data[5] != 1:
+            raise ValueError("%s is not an ELF32 little endian file" % path)
+
+        e_shoff, = struct.unpack_from('<I', self.data, 0x20)
+        e_shentsize, e_shnum = struct.unpack_from('<HH', self.data, 0x2E)
+
+        self.sections = []
+        for index in range(e_shnum):
+            (sh_name, sh_type, sh_flags, sh_addr, sh_offset, sh_size) = \
+                struct.unpack_from('<IIIIII', self.data, e_shoff + index * e_shentsize)
+            if sh_type == self.SHT_PROGBITS and (sh_flags & self.SHF_ALLOC) and sh_size:
+                self.sections.append((sh_addr, sh_size, sh_offset))
+
+    def read_string(self, address):
+        for (sh_addr, sh_size, sh_offset) in self.sections:
+            if sh_addr <= address < sh_addr + sh_size:
+                start = sh_offset + address - sh_addr
+                end = self.data.find(b'\0', start, sh_offset + sh_size)
+                if end < 0:
+                    end = sh_offset + sh_size
+                return self.data[start:end].decode('utf-8', 'replace')
+        return "<unknown string 0x%08x>" % address
+
+class RecordDecoder:
+    """Rebuilds the text of one log record."""
+
+    def __init__(self, elf):
+        self.elf = elf
+
+    def decode(self, words):
+        header = words[0]
+        level = (header >> 20) & 0xF
+        flags = (header >> 16) & 0xF
+        tick = words[1]
+        level_name = LEVEL_NAMES.get(level, "Log")
+
+        if flags & FLAG_DROPPED:
+            return "%d %s: %d log records dropped\n" % (tick, level_name, words[3])
+
+        self.words = words
+        self.index = 2
+        self.truncated = False
+        fmt = self.next_string()
+        text = CONVERSION.sub(self.convert, fmt)
+        if flags & FLAG_TRUNCATED:
+            text = text.rstrip('\r\n') + " <truncated>\n"
+
+        return "%d %s: %s" % (tick, level_name, text)
+
+    def next_word(self):
+        if self.index >= len(self.words):
+            self.truncated = True
+            return 0
+        word = self.words[self.index]
+        self.index += 1
+        return word
+
+    def next_wide(self):
+        low = self.next_word()
+        return (self.next_word() << 32) | low
+
+    def next_string(self):
+        word = self.next_word()
+        if word == 0:
+            return "(null)"
+        if (word & INLINE_STRING_MASK) != INLINE_STRING_TAG:
+            return self.elf.read_string(word)
+
+        length = word & ~INLINE_STRING_MASK
+        count = (length + 3) // 4
+        words = list(self.words[self.index:self.index + count])
+        if len(words) < count:
+            # Record cut short in the retained log.
+            self.truncated = True
+            words += [0] * (count - len(words))
+        raw = struct.pack('<%dI' % count, *words)
+        self.index += count
+        return raw[:length].decode('utf-8', 'replace')
+
+    def convert(self, match):
+        (flags, width, precision, length, conversion) = match.groups()
+
+        if conversion == '%':
+            return '%'
+
+        if width == '*':
+            width = str(struct.unpack('<i', struct.pack('<I', self.next_word()))[0])
+        if precision == '*':
+            precision = str(struct.unpack('<i', struct.pack('<I', self.next_word()))[0])
+        spec = '%' + flags + (width or '') + ('.' + precision if precision is not None else '')
+        wide = ('ll' in length) or ('j' in length)
+
+        if conversion in 'diuoxX':
+            value = self.next_wide() if wide else self.next_word()
+            if conversion in 'di':
+                bits = 64 if wide else 32
+                if value & (1 << (bits - 1)):
+                    value -= (1 << bits)
+                conversion = 'd'
+            elif conversion == 'u':
+                conversion = 'd'
+            result = (spec + conversion) % value
+        elif conversion == 'c':
+            result = (spec + 'c') % chr(self.next_word() & 0xFF)
+        elif conversion in 'fFeEgGaA':
+            value = struct.unpack('<d', struct.pack('<Q', self.next_wide()))[0]
+            if conversion in 'aA':
+                result = float.hex(value)
+            else:
+                result = (spec + conversion) % value
+        elif conversion == 's':
+            result = (spec + 's') % self.next_string()
+        elif conversion == 'p':
+            result = "0x%08x" % self.next_word()
+        else:
+            result = ''
+
+        return "<?>" if self.truncated else result
+
+def decode_stream(read, write, elf):
+    """Splits the byte stream into binary frames and plain text."""
+    decoder = RecordDecoder(elf)
+    pending = b''
+
+    while True:
+        data = read()
+        if data is None:
+            break
+        pending += data
+
+        while pending:
+            start = pending.find(FRAME_SYNC)
+            if start < 0:
+                # Keeps a trailing first sync byte for the next read.
+                keep = 1 if pending[-1:] == FRAME_SYNC[:1] else 0
+                write(pending[:len(pending) - keep].decode('utf-8', 'replace'))
+                pending = pending[len(pending) - keep:]
+                break
+
+            if start > 0:
+                write(pending[:start].decode('utf-8', 'replace'))
+                pending = pending[start:]
+
+            if len(pending) < 3:
+                break
+            count = pending[2]
+            frame_length = 3 + count * 4 + 1
+            if len(pending) < frame_length:
+                break
+
+            payload = pending[2:frame_length - 1]
+            words = struct.unpack_from('<%dI' % count, pending, 3) if count else ()
+            if (count >= 3 and (sum(payload) & 0xFF) == pending[frame_length - 1] and
+                    (words[0] >> 24) == RECORD_SYNC and (words[0] & 0xFFFF) == count and
+                    not ((words[0] >> 16) & FLAG_PADDING)):
+                write(decoder.decode(words))
+                pending = pending[frame_length:]
+            else:
+                # Not a frame. The sync bytes are plain text.
+                write(pending[:1].decode('utf-8', 'replace'))
+                pending = pending[1:]
+
+def decode_report(lines, write, elf):
+    """Replaces the binary records of a crash report, which the retained log
+    prints in hexadecimal, with their text."""
+    decoder = RecordDecoder(elf)
+
+    for line in lines:
+        match = REPORT_RECORD.search(line)
+        if match:
+            digits = match.group(2)
+            words = [int(digits[i:i + 8], 16) for i in range(0, len(digits) - 7, 8)]
+            if len(words) >= 2:
+                line = line[:match.start()] + "Log: " + decoder.decode(words)
+        write(line)
+
+def write_text(text):
+    sys.stdout.write(text)
+    sys.stdout.flush()
+
+if __name__ == '__main__':
+    parser = optparse.OptionParser()
+    parser.add_option("-e", "--elf", dest="elf", help="Application ELF file with the format strings.")
+    parser.add_option("-p", "--port", dest="port", help="Serial port of the debug UART.")
+    parser.add_option("-b", "--baud", dest="baud", type="int", default=115200, help="Baud rate [default: %default].")
+    parser.add_option("-f", "--file", dest="file", help="Capture of the debug UART output.")
+    parser.add_option("-r", "--report", dest="report", help="Crash report with binary records from the retained log.")
+
+    (options, args) = parser.parse_args()
+
+    if not options.elf or (not options.port and not options.file and not options.report):
+        parser.error("the ELF file and either a serial port, a capture file, or a crash report are required")
+
+    elf = ElfImage(options.elf)
+
+    try:
+        if options.report:
+            with open(options.report, 'r') as report:
+                decode_report(report, write_text, elf)
+        elif options.file:
+            with open(options.file, 'rb') as capture:
+                decode_stream(lambda: capture.read(4096) or None, write_text, elf)
+        else:
+            import serial
+            port = serial.Serial(options.port, options.baud, timeout=0.1)
+            decode_stream(lambda: port.read(4096), write_text, elf)
+    except KeyboardInterrupt:
+        sys.exit(0)
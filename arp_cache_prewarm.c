@@ -0,0 +1,216 @@
+/*******************************************************************************
+ * File Name:   arp_cache_prewarm.c
+ *
+ * Description: This file contains the ARP cache pre-warm. Before the network
+ * stack is suspended, it takes a snapshot of the resolved gateway and peer
+ * entries of the lwIP ARP cache. When the network stack resumes, the entries
+ * which have aged out in the meantime are imported back, so that the first
+ * packet after the wake goes out without waiting for an ARP round-trip.
+ *
+ * The WLAN ARP agent learns the same peers through IP snoop, but the WHD API
+ * does not provide read access to the WLAN ARP peer cache. The snapshot is
+ * therefore kept on the host, and is invalidated together with the WLAN ARP
+ * peer cache after a roam or an IP address change.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+
+/* Include header files */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "iot_wifi.h"
+#include "iot_wifi_common.h"
+#include <stdbool.h>
+#include <lwip/netif.h>
+#include <lwip/etharp.h>
+#include <lwip/tcpip.h>
+
+/* Low Power Assistant header files. */
+#include "network_activity_handler.h"
+
+/* Low Power Assistant offload and the network configuration. */
+#include "wlan_offload.h"
+#include "arp_cache_prewarm.h"
+#include "wifi_config.h"
+
+/*******************************************************************************
+ * Static Global Structures and variables
+ ******************************************************************************/
+/* Resolved ARP entry taken from the lwIP ARP cache. */
+typedef struct
+{
+    ip4_addr_t ipaddr;
+    struct eth_addr ethaddr;
+    bool imported;                 /* Imported as a static entry on resume. */
+} arp_prewarm_entry_t;
+
+static arp_prewarm_entry_t arp_prewarm_table[ARP_TABLE_SIZE];
+static uint32_t arp_prewarm_count = 0;
+
+/*******************************************************************************
+ * Function definitions
+ ******************************************************************************/
+/*******************************************************************************
+* Function Name: arp_cache_prewarm_remove_imported
+********************************************************************************
+* Summary:
+*  Removes the static entries imported on the last resume from the lwIP ARP
+*  cache, so that lwIP ages and re-resolves them normally. Must be called with
+*  the lwIP core locked.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void arp_cache_prewarm_remove_imported(void)
+{
+    uint32_t index;
+
+    for (index = 0; index < arp_prewarm_count; index++)
+    {
+        if (arp_prewarm_table[index].imported)
+        {
+            (void)etharp_remove_static_entry(&arp_prewarm_table[index].ipaddr);
+            arp_prewarm_table[index].imported = false;
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: arp_cache_prewarm_on_suspend
+********************************************************************************
+* Summary:
+*  Takes a snapshot of the resolved entries of the lwIP ARP cache for the
+*  Wi-Fi interface. This is called before the network stack is suspended.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void arp_cache_prewarm_on_suspend(void)
+{
+    struct netif *wifi = cy_lwip_get_interface();
+    ip4_addr_t *ipaddr;
+    struct netif *netif;
+    struct eth_addr *ethaddr;
+    size_t index;
+
+    LOCK_TCPIP_CORE();
+
+    arp_cache_prewarm_remove_imported();
+    arp_prewarm_count = 0;
+
+    for (index = 0; index < ARP_TABLE_SIZE; index++)
+    {
+        if ((1 == etharp_get_entry(index, &ipaddr, &netif, &ethaddr)) && (wifi == netif))
+        {
+            ip4_addr_copy(arp_prewarm_table[arp_prewarm_count].ipaddr, *ipaddr);
+            SMEMCPY(&arp_prewarm_table[arp_prewarm_count].ethaddr, ethaddr, ETH_HWADDR_LEN);
+            arp_prewarm_table[arp_prewarm_count].imported = false;
+            arp_prewarm_count++;
+        }
+    }
+
+    UNLOCK_TCPIP_CORE();
+}
+
+/*******************************************************************************
+* Function Name: arp_cache_prewarm_on_resume
+********************************************************************************
+* Summary:
+*  Imports the snapshot entries which are no longer in the lwIP ARP cache as
+*  static entries. They are removed again before the next suspend. This is
+*  called after the network stack resumes.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void arp_cache_prewarm_on_resume(void)
+{
+    struct netif *wifi = cy_lwip_get_interface();
+    struct eth_addr *eth_ret;
+    const ip4_addr_t *ip_ret;
+    uint32_t index;
+
+    LOCK_TCPIP_CORE();
+
+    for (index = 0; index < arp_prewarm_count; index++)
+    {
+        if ((etharp_find_addr(wifi, &arp_prewarm_table[index].ipaddr, &eth_ret, &ip_ret) < 0) &&
+            (ERR_OK == etharp_add_static_entry(&arp_prewarm_table[index].ipaddr,
+                                               &arp_prewarm_table[index].ethaddr)))
+        {
+            arp_prewarm_table[index].imported = true;
+        }
+    }
+
+    UNLOCK_TCPIP_CORE();
+}
+
+/*******************************************************************************
+* Function Name: arp_cache_prewarm_invalidate
+********************************************************************************
+* Summary:
+*  Discards the snapshot and the imported entries. This is called when the
+*  peers learned earlier are no longer valid, such as after a roam or an IP
+*  address change.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void arp_cache_prewarm_invalidate(void)
+{
+    LOCK_TCPIP_CORE();
+
+    arp_cache_prewarm_remove_imported();
+    arp_prewarm_count = 0;
+
+    UNLOCK_TCPIP_CORE();
+}
+
+
+/* [] END OF FILE */
+
@@ -0,0 +1,312 @@
+/*******************************************************************************
+ * File Name:   arp_offload_policy.c
+ *
+ * Description: This file contains the ARP offload policy. It selects the WLAN
+ * ARP peer age from the DHCP lease time and the host IP address stability, and
+ * refreshes the WLAN host IP table in the host wake windows before it ages out,
+ * so that ARP requests are never forwarded to the host because of an expired
+ * table entry.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+
+/* Include header files */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "iot_wifi.h"
+#include "iot_wifi_common.h"
+#include <stdbool.h>
+#include <lwip/netif.h>
+#include <lwip/dhcp.h>
+
+/* Low Power Assistant header files. */
+#include "network_activity_handler.h"
+#include "cy_lpa_wifi_arp_ol.h"
+
+/* LPA offload manager (OLM) header file. */
+#include "cy_OlmInterface.h"
+
+/* Wi-Fi Host Driver (WHD) header files. */
+#include "whd_wifi_api.h"
+
+/* Low Power Assistant offload and the network configuration. */
+#include "wlan_offload.h"
+#include "arp_offload_policy.h"
+#include "wifi_config.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* The WLAN firmware supports up to 8 host IP addresses in its ARP table. */
+#define ARP_POLICY_MAX_HOST_IP               (8)
+
+/* DHCP lease time of an infinite lease. */
+#define ARP_POLICY_INFINITE_LEASE            (0xFFFFFFFFUL)
+
+#define ARP_POLICY_SEC_TO_TICKS(sec)         ((TickType_t)(sec) * configTICK_RATE_HZ)
+
+/*******************************************************************************
+ * Static Global Structures and variables
+ ******************************************************************************/
+/* Runtime state of the ARP offload policy. */
+typedef struct
+{
+    ip4_addr_t host_ip;            /* Host IP address in the WLAN host IP table. */
+    TickType_t host_ip_since;      /* Tick at which the host IP address last changed. */
+    TickType_t last_refresh;       /* Tick at which the host IP table was last refreshed. */
+    uint32_t peer_age_sec;         /* Peer age currently set in the WLAN ARP agent. */
+} arp_offload_policy_t;
+
+static arp_offload_policy_t arp_policy;
+
+/*******************************************************************************
+ * Function definitions
+ ******************************************************************************/
+/*******************************************************************************
+* Function Name: arp_offload_policy_get_config
+********************************************************************************
+* Summary:
+*  Returns the ARP offload configuration of the active offload list.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  const arp_ol_cfg_t *: ARP offload configuration, or NULL if the ARP offload
+*  is not enabled.
+*
+*******************************************************************************/
+static const arp_ol_cfg_t *arp_offload_policy_get_config(void)
+{
+    const ol_desc_t *arp_desc;
+
+    arp_desc = cylpa_find_my_descriptor(ARP_NAME, (ol_desc_t *)olm_get_active_offload_list());
+
+    return (NULL != arp_desc) ? (const arp_ol_cfg_t *)arp_desc->cfg : NULL;
+}
+
+/*******************************************************************************
+* Function Name: arp_offload_policy_select_peer_age
+********************************************************************************
+* Summary:
+*  Selects the ARP peer age. The host IP address is guaranteed until the DHCP
+*  lease renewal at T1 (half the lease time), so the peer age follows it. A
+*  recently changed address uses the minimum peer age until it is stable.
+*
+* Parameters:
+*  netif   : lwIP network interface.
+*  arp_cfg : ARP offload configuration.
+*  now     : Current tick count.
+*
+* Return:
+*  uint32_t: Peer age in seconds.
+*
+*******************************************************************************/
+static uint32_t arp_offload_policy_select_peer_age(struct netif *netif,
+                                                   const arp_ol_cfg_t *arp_cfg,
+                                                   TickType_t now)
+{
+#if ARP_OL_ADAPTIVE_PEER_AGE
+    uint32_t peer_age = ARP_OL_PEER_AGE_MAX_SEC;
+#if LWIP_DHCP
+    struct dhcp *dhcp = netif_dhcp_data(netif);
+
+    if ((NULL != dhcp) && (0 != dhcp->offered_t0_lease) &&
+        (ARP_POLICY_INFINITE_LEASE != dhcp->offered_t0_lease))
+    {
+        peer_age = dhcp->offered_t0_lease / 2;
+    }
+#else
+    (void)netif;
+#endif
+    (void)arp_cfg;
+
+    if ((now - arp_policy.host_ip_since) < ARP_POLICY_SEC_TO_TICKS(ARP_OL_ADDRESS_STABLE_SEC))
+    {
+        peer_age = ARP_OL_PEER_AGE_MIN_SEC;
+    }
+
+    if (peer_age < ARP_OL_PEER_AGE_MIN_SEC)
+    {
+        peer_age = ARP_OL_PEER_AGE_MIN_SEC;
+    }
+    else if (peer_age > ARP_OL_PEER_AGE_MAX_SEC)
+    {
+        peer_age = ARP_OL_PEER_AGE_MAX_SEC;
+    }
+
+    return peer_age;
+#else
+    (void)netif;
+    (void)now;
+
+    return arp_cfg->peerage;
+#endif
+}
+
+/*******************************************************************************
+* Function Name: arp_offload_policy_refresh_host_ip
+********************************************************************************
+* Summary:
+*  Writes the given host IP address to the WLAN host IP table. Unless forced,
+*  the table is left untouched if it already holds only the given address.
+*  The refresh time is taken only when the table is written, since finding the
+*  table up to date does not restart the aging of its entry.
+*
+* Parameters:
+*  ifp     : WHD interface.
+*  host_ip : Current host IPv4 address.
+*  force   : Rewrite the table even if it is up to date. This restarts the
+*            aging of the table entry.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void arp_offload_policy_refresh_host_ip(whd_interface_t ifp, const ip4_addr_t *host_ip, bool force)
+{
+    uint32_t host_ip_list[ARP_POLICY_MAX_HOST_IP] = {0};
+    uint32_t filled = 0;
+    uint32_t ipv4_addr = ip4_addr_get_u32(host_ip);
+    whd_result_t whd_result = WHD_SUCCESS;
+
+    if (!ip4_addr_cmp(host_ip, &arp_policy.host_ip))
+    {
+        arp_policy.host_ip_since = xTaskGetTickCount();
+        ip4_addr_copy(arp_policy.host_ip, *host_ip);
+        force = true;
+    }
+
+    if (!force)
+    {
+        whd_result = whd_arp_hostip_list_get(ifp, ARP_POLICY_MAX_HOST_IP, host_ip_list, &filled);
+        force = ((WHD_SUCCESS != whd_result) || (1 != filled) || (ipv4_addr != host_ip_list[0]));
+    }
+
+    if (force)
+    {
+        (void)whd_arp_hostip_list_clear(ifp);
+        whd_result = whd_arp_hostip_list_add(ifp, &ipv4_addr, 1);
+        if (WHD_SUCCESS == whd_result)
+        {
+            arp_policy.last_refresh = xTaskGetTickCount();
+        }
+        else
+        {
+            ERR_INFO(("Failed to update the WLAN ARP host IP table.\n"));
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: arp_offload_policy_on_wake
+********************************************************************************
+* Summary:
+*  Runs the periodic ARP offload work. This is run by the wake scheduler in a
+*  host wake window when the refresh is due, so that it does not need a wake
+*  of its own. Updates the WLAN ARP peer age if the selected value has changed,
+*  and rewrites the host IP table, which restarts the aging of the entry.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void arp_offload_policy_on_wake(void)
+{
+    struct netif *netif = cy_lwip_get_interface();
+    whd_interface_t ifp = (whd_interface_t)netif->state;
+    const arp_ol_cfg_t *arp_cfg = arp_offload_policy_get_config();
+    TickType_t now = xTaskGetTickCount();
+    uint32_t peer_age;
+    ip4_addr_t host_ip;
+
+    ip4_addr_copy(host_ip, *netif_ip4_addr(netif));
+
+    if ((NULL == arp_cfg) || ip4_addr_isany_val(host_ip))
+    {
+        return;
+    }
+
+    peer_age = arp_offload_policy_select_peer_age(netif, arp_cfg, now);
+    if (peer_age != arp_policy.peer_age_sec)
+    {
+        if (WHD_SUCCESS == whd_arp_peerage_set(ifp, peer_age))
+        {
+            APP_INFO(("ARP offload peer age set to %lu seconds.\n", (unsigned long)peer_age));
+            arp_policy.peer_age_sec = peer_age;
+        }
+        else
+        {
+            ERR_INFO(("Failed to set the ARP offload peer age.\n"));
+        }
+    }
+
+    arp_offload_policy_refresh_host_ip(ifp, &host_ip, true);
+}
+
+/*******************************************************************************
+* Function Name: arp_offload_policy_get_next_refresh_ms
+********************************************************************************
+* Summary:
+*  Returns the time until the WLAN host IP table needs to be refreshed. The
+*  network stack must not stay suspended longer than this.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  uint32_t: Time in milliseconds until the next refresh, or portMAX_DELAY if
+*  no refresh is needed.
+*
+*******************************************************************************/
+uint32_t arp_offload_policy_get_next_refresh_ms(void)
+{
+    TickType_t refresh_ticks;
+    TickType_t elapsed;
+
+    if ((NULL == arp_offload_policy_get_config()) || (0 == arp_policy.peer_age_sec))
+    {
+        return portMAX_DELAY;
+    }
+
+    refresh_ticks = ARP_POLICY_SEC_TO_TICKS((arp_policy.peer_age_sec * ARP_OL_REFRESH_PERCENT) / 100UL);
+    elapsed = xTaskGetTickCount() - arp_policy.last_refresh;
+
+    return (elapsed >= refresh_ticks) ? 0 : ((refresh_ticks - elapsed) * portTICK_PERIOD_MS);
+}
+
+
+/* [] END OF FILE */
+
@@ -59,6 +59,62 @@ extern void vLoggingPrintf( const char * pcFormat, ... );
 extern void vLoggingPrint( const char * pcMessage );
 #define configPRINT( X )     vLoggingPrint( X )
 
+/* Enable(1) or Disable(0) the FreeRTOS run-time stats, and the report of the
+ * CPU time of each task. The run-time stats use the low-power timer of the
+ * sleep residency accounting as the timebase, which keeps counting in deep
+ * sleep. The timer is started by sleep_stats_init() in main(). When disabled,
+ * the context switches do not read the timer. See task_stats.c. */
+#define TASK_STATS              ( 1 )
+
+/* The CPU time of each task is printed in the first host wake window after
+ * every TASK_STATS_REPORT_INTERVAL_SEC seconds. */
+#define TASK_STATS_REPORT_INTERVAL_SEC    ( 600UL )
+
+#if TASK_STATS
+extern uint32_t sleep_stats_read_timer( void );
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE()    sleep_stats_read_timer()
+#endif
+
+/* DMA driven output of the logging task. See log_uart_dma.c. */
+extern void log_uart_dma_print( const char * pcString );
+
+/* Enable(1) or Disable(0) streaming the kernel events to the debug UART for the
+ * wake latency analysis with trace_decode.py. See trace_stream.c. This cannot
+ * be used together with the Tracealyzer recorder. */
+#define TRACE_STREAM            ( 0 )
+
+#if TRACE_STREAM
+#include "trace_stream.h"
+#define traceTASK_CREATE( pxNewTCB )                trace_stream_task_create( ( pxNewTCB )->uxTCBNumber, ( pxNewTCB )->pcTaskName )
+#define traceTASK_SWITCHED_IN()                     trace_stream_event( TRACE_STREAM_EVT_TASK_SWITCH_IN, pxCurrentTCB->uxTCBNumber )
+#define traceQUEUE_SEND( pxQueue )                  trace_stream_event( TRACE_STREAM_EVT_QUEUE_SEND, ( uint32_t ) ( pxQueue ) )
+#define traceQUEUE_SEND_FROM_ISR( pxQueue )         trace_stream_event( TRACE_STREAM_EVT_QUEUE_SEND, ( uint32_t ) ( pxQueue ) )
+#define traceQUEUE_RECEIVE( pxQueue )               trace_stream_event( TRACE_STREAM_EVT_QUEUE_RECEIVE, ( uint32_t ) ( pxQueue ) )
+#define traceQUEUE_RECEIVE_FROM_ISR( pxQueue )      trace_stream_event( TRACE_STREAM_EVT_QUEUE_RECEIVE, ( uint32_t ) ( pxQueue ) )
+#define traceBLOCKING_ON_QUEUE_SEND( pxQueue )      trace_stream_event( TRACE_STREAM_EVT_QUEUE_BLOCK_SEND, ( uint32_t ) ( pxQueue ) )
+#define traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue )   trace_stream_event( TRACE_STREAM_EVT_QUEUE_BLOCK_RECEIVE, ( uint32_t ) ( pxQueue ) )
+#define traceTASK_NOTIFY_FROM_ISR()                 trace_stream_event( TRACE_STREAM_EVT_NOTIFY_FROM_ISR, ( ( TCB_t * ) xTaskToNotify )->uxTCBNumber )
+#define traceTASK_NOTIFY_GIVE_FROM_ISR()            trace_stream_event( TRACE_STREAM_EVT_NOTIFY_FROM_ISR, ( ( TCB_t * ) xTaskToNotify )->uxTCBNumber )
+#define traceLOW_POWER_IDLE_BEGIN()                 trace_stream_low_power( TRACE_STREAM_EVT_LOW_POWER_BEGIN )
+#define traceLOW_POWER_IDLE_END()                   trace_stream_low_power( TRACE_STREAM_EVT_LOW_POWER_END )
+#endif
+
+/* Enable(1) or Disable(0) tracking the heap usage of each subsystem and the lwIP
+ * pool high-water marks. This also enables the lwIP statistics. See
+ * mem_usage.c. */
+#define MEM_USAGE_STATS         ( 0 )
+
+/* The heap and lwIP pool usage is printed in the first host wake window after
+ * every MEM_USAGE_REPORT_INTERVAL_SEC seconds. */
+#define MEM_USAGE_REPORT_INTERVAL_SEC     ( 600UL )
+
+#if MEM_USAGE_STATS
+#include "mem_usage.h"
+#define traceMALLOC( pvAddress, uiSize )            mem_usage_on_malloc( ( pvAddress ), ( uiSize ) )
+#define traceFREE( pvAddress, uiSize )              mem_usage_on_free( pvAddress )
+#endif
+
 /* Assert call defined for debug builds. */
 extern void vAssertCalled( const char * pcFile,
                            uint32_t ulLine );
@@ -89,7 +145,17 @@ extern void vApplicationSleep( uint32_t xExpectedIdleTime );
  * With retarget support enabled, printf gets redirected to the UART
  * that connects via USB to the developers machine.
  */
+/* Enable(1) or Disable(0) sending the output of the logging task to the UART
+ * with DMA, instead of one character at a time with retarget-io. Disabled by
+ * default, since the printf() output of the WHD and the LPA still goes through
+ * retarget-io, and may be mixed into a DMA transfer. */
+#define LOG_UART_DMA            ( 0 )
+
+#if LOG_UART_DMA
+#define configPRINT_STRING( X ) log_uart_dma_print( X )
+#else
 #define configPRINT_STRING( X ) fputs((X), stdout)
+#endif
 #define configUSE_POSIX_ERRNO   1
 
 // extern void vLoggingPrintf(const char *fmt, ...) ;
@@ -170,7 +236,7 @@ extern void vApplicationSleep( uint32_t xExpectedIdleTime );
 #define configUSE_MALLOC_FAILED_HOOK                ( 1 )
 #define configUSE_APPLICATION_TASK_TAG              ( 1 )
 #define configUSE_COUNTING_SEMAPHORES               ( 1 )
-#define configGENERATE_RUN_TIME_STATS               ( 0 )
+#define configGENERATE_RUN_TIME_STATS               ( TASK_STATS )
 #define configENABLE_FPU                            ( 1 )
 #define configENABLE_MPU                            ( 0 )
 #define configENABLE_TRUSTZONE                      ( 0 )
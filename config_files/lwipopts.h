@@ -43,6 +43,22 @@
  */
 #define MEM_LIBC_MALLOC                (1)
 
+/**
+ * MEM_STATIC_POOLS==1: Serve the lwIP heap from the static size-class pools
+ * in mem_pool.c instead of the C library heap. The pools are sized from the
+ * number of secure sockets and from the send buffers of the TCP keepalive
+ * offload connections. Allocations which do not fit a pool fall back to the C
+ * library heap.
+ */
+#define MEM_STATIC_POOLS               (1)
+
+#if MEM_STATIC_POOLS
+#include "mem_pool.h"
+#define mem_clib_malloc                mem_pool_malloc
+#define mem_clib_calloc                mem_pool_calloc
+#define mem_clib_free                  mem_pool_free
+#endif
+
 /**
  * MEMP_NUM_UDP_PCB: the number of UDP protocol control blocks. One
  * per active UDP "connection".
@@ -150,9 +166,42 @@
 #undef TCP_SND_BUF
 #endif
 #ifdef TX_PACKET_POOL_SIZE
-#define TCP_SND_BUF                    LWIP_MAX((2 * TCP_MSS), ((TX_PACKET_POOL_SIZE/2) * TCP_MSS))
+#define TCP_TUNE_SND_BUF_BASE          LWIP_MAX((2 * TCP_MSS), ((TX_PACKET_POOL_SIZE/2) * TCP_MSS))
 #else
-#define TCP_SND_BUF                    (6 * TCP_MSS)
+#define TCP_TUNE_SND_BUF_BASE          (6 * TCP_MSS)
+#endif
+
+/**
+ * TCP_TUNE==1: Size the receive window and the send buffer of each TCP
+ * connection at runtime, see tcp_tune.c. A connection gets the maximum sizes
+ * while it is moving bulk data, if the total fits TCP_TUNE_RX_BUDGET and
+ * TCP_TUNE_TX_BUDGET, and is shrunk back to the base sizes when it is idle and
+ * before the network stack is suspended. TCP_WND and TCP_SND_BUF are the
+ * maximum sizes.
+ */
+#define TCP_TUNE                       (1)
+
+#if TCP_TUNE
+#define TCP_TUNE_SND_BUF_MAX           (2 * TCP_TUNE_SND_BUF_BASE)
+#define TCP_TUNE_WND_BASE              (2 * TCP_MSS)
+#define TCP_TUNE_WND_MAX               ((PBUF_POOL_SIZE / 2) * TCP_MSS)
+
+/* Receive windows are limited by the Rx pbuf pool, and the send buffers by
+ * the lwIP heap.
+ */
+#define TCP_TUNE_RX_BUDGET             ((PBUF_POOL_SIZE - 2) * TCP_MSS)
+#define TCP_TUNE_TX_BUDGET             (3 * TCP_TUNE_SND_BUF_BASE)
+
+#define TCP_SND_BUF                    TCP_TUNE_SND_BUF_MAX
+#define LWIP_TCP_PCB_NUM_EXT_ARGS      (1)
+
+/* select() and poll() report a socket writable when more than TCP_SNDLOWAT
+ * bytes of its send buffer are free. The default is half of TCP_SND_BUF, which
+ * a connection at the base send buffer size never has free.
+ */
+#define TCP_SNDLOWAT                   (TCP_TUNE_SND_BUF_BASE / 2)
+#else
+#define TCP_SND_BUF                    TCP_TUNE_SND_BUF_BASE
 #endif
 
 /**
@@ -165,7 +214,11 @@
 #ifdef TCP_WND
 #undef TCP_WND
 #endif
+#if TCP_TUNE
+#define TCP_WND                        TCP_TUNE_WND_MAX
+#else
 #define TCP_WND                        (2 * TCP_MSS)
+#endif
 
 /**
  * LWIP_NETIF_TX_SINGLE_PBUF: if this is set to 1, lwIP tries to put all data
@@ -176,8 +229,11 @@
  *
  * @todo: TCP and IP-frag do not work with this, yet:
  */
-/* TODO: remove this option once buffer chaining has been implemented */
-#define LWIP_NETIF_TX_SINGLE_PBUF      (1)
+/* Disabled, so that the TCP segments are allocated at the size written instead
+ * of the full MSS. The chained frames are copied into a single buffer for the
+ * WHD by netif_tx_chain.c.
+ */
+#define LWIP_NETIF_TX_SINGLE_PBUF      (0)
 
 /** Define LWIP_COMPAT_MUTEX if the port has no mutexes and binary semaphores
  *  should be used instead
@@ -236,6 +292,13 @@
 #endif
 #define MEMP_NUM_ARP_QUEUE              5
 
+/**
+ * ETHARP_SUPPORT_STATIC_ENTRIES==1: enable code to support static ARP table
+ * entries (using etharp_add_static_entry/etharp_remove_static_entry).
+ * Used to pre-warm the ARP cache when the network stack resumes.
+ */
+#define ETHARP_SUPPORT_STATIC_ENTRIES   (1)
+
 /**
  * MEMP_NUM_NETCONN: the number of struct netconns.
  * (only needed if you use the sequential API, like api_lib.c)
@@ -258,14 +321,18 @@
 #endif /* if ( LWIP_SO_RCVBUF == 1 ) */
 #endif /* ifdef LWIP_SO_RCVBUF */
 
+/* MEM_USAGE_STATS is set in FreeRTOSConfig.h. */
+#include "FreeRTOSConfig.h"
+
 /**
- * LWIP_STATS==1: Enable statistics collection in lwip_stats.
+ * LWIP_STATS==1: Enable statistics collection in lwip_stats. The heap and
+ * memory pool statistics are used by the MEM_USAGE_STATS report.
  */
-#ifdef CY_LWIP_DEBUG
+#if defined(CY_LWIP_DEBUG) || MEM_USAGE_STATS
 #define LWIP_STATS                     (1)
 #else
 #define LWIP_STATS                     (0)
-#endif /* ifdef CY_LWIP_DEBUG */
+#endif /* if defined(CY_LWIP_DEBUG) || MEM_USAGE_STATS */
 
 /**
  * LWIP_NETIF_API==1: Support netif api (in netifapi.c)
@@ -0,0 +1,187 @@
+/*******************************************************************************
+ * File Name:   ipv6_nd_offload.c
+ *
+ * Description: This file contains the host side of the IPv6 neighbor discovery
+ * and MLD offload. The WLAN firmware has no IPv6 counterpart of the ARP agent,
+ * so the packet filter profile in wlan_offload.c lets only ICMPv6 wake the
+ * host, and this file keeps the MLD traffic of the host inside the wake
+ * windows it already has.
+ *
+ * The MLD reports which lwIP delays in response to a Query, which reaches the
+ * host through the ICMPv6 packet filter, are sent by the wake scheduler in the
+ * wake window of the Query instead of waking the host once more when their
+ * timers expire. On a network without an MLD querier, the unsolicited reports
+ * which keep the solicited-node multicast group alive in MLD snooping switches
+ * can be enabled with IPV6_MLD_REPORT_INTERVAL_SEC.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+
+/* Include header files */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "iot_wifi.h"
+#include "iot_wifi_common.h"
+#include <stdbool.h>
+#include <lwip/netif.h>
+#include <lwip/mld6.h>
+#include <lwip/prot/mld6.h>
+#include <lwip/tcpip.h>
+
+/* Low Power Assistant header files. */
+#include "network_activity_handler.h"
+
+/* Low Power Assistant offload and the network configuration. */
+#include "wlan_offload.h"
+#include "ipv6_nd_offload.h"
+#include "wifi_config.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define IPV6_ND_SEC_TO_TICKS(sec)            ((TickType_t)(sec) * configTICK_RATE_HZ)
+
+/*******************************************************************************
+ * Static Global Structures and variables
+ ******************************************************************************/
+/* Tick at which the MLD reports were last sent. */
+static TickType_t ipv6_nd_last_report;
+
+/*******************************************************************************
+ * Function definitions
+ ******************************************************************************/
+/*******************************************************************************
+* Function Name: ipv6_nd_offload_has_address
+********************************************************************************
+* Summary:
+*  Checks whether the network interface has a valid IPv6 address. MLD reports
+*  are not sent before the link-local address is valid.
+*
+* Parameters:
+*  netif : lwIP network interface.
+*
+* Return:
+*  bool: true if at least one IPv6 address is valid, false otherwise.
+*
+*******************************************************************************/
+static bool ipv6_nd_offload_has_address(struct netif *netif)
+{
+    uint32_t index;
+
+    for (index = 0; index < LWIP_IPV6_NUM_ADDRESSES; index++)
+    {
+        if (ip6_addr_isvalid(netif_ip6_addr_state(netif, index)))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*******************************************************************************
+* Function Name: ipv6_nd_offload_send_reports
+********************************************************************************
+* Summary:
+*  Schedules the MLD reports of all the groups of the interface. This is run
+*  by the wake scheduler in a host wake window after the network stack
+*  resumes. lwIP sends the reports with a random delay of up to
+*  MLD6_JOIN_DELAYING_MEMBER_TMR_MS, for which the scheduler keeps the network
+*  stack resumed. This also replaces any longer delay requested by a Query
+*  received while the network stack was suspended.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void ipv6_nd_offload_send_reports(void)
+{
+    struct netif *netif = cy_lwip_get_interface();
+
+    LOCK_TCPIP_CORE();
+
+    if (netif_is_up(netif) && ipv6_nd_offload_has_address(netif))
+    {
+        mld6_report_groups(netif);
+    }
+
+    UNLOCK_TCPIP_CORE();
+
+    ipv6_nd_last_report = xTaskGetTickCount();
+}
+
+/*******************************************************************************
+* Function Name: ipv6_nd_offload_get_next_report_ms
+********************************************************************************
+* Summary:
+*  Returns the time until the MLD reports are due. A report which lwIP delays
+*  in response to a Query is due at once. The unsolicited reports are due
+*  every IPV6_MLD_REPORT_INTERVAL_SEC seconds, if it is not 0. The network
+*  stack must not stay suspended longer than this.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  uint32_t: Time in milliseconds until the next report, or portMAX_DELAY if
+*  no report is scheduled.
+*
+*******************************************************************************/
+uint32_t ipv6_nd_offload_get_next_report_ms(void)
+{
+    struct mld_group *group = netif_mld6_data(cy_lwip_get_interface());
+    TickType_t report_ticks = IPV6_ND_SEC_TO_TICKS(IPV6_MLD_REPORT_INTERVAL_SEC);
+    TickType_t elapsed;
+
+    for (; NULL != group; group = group->next)
+    {
+        if (MLD6_GROUP_DELAYING_MEMBER == group->group_state)
+        {
+            return 0;
+        }
+    }
+
+    if (0 == report_ticks)
+    {
+        return portMAX_DELAY;
+    }
+
+    elapsed = xTaskGetTickCount() - ipv6_nd_last_report;
+
+    return (elapsed >= report_ticks) ? 0 : ((report_ticks - elapsed) * portTICK_PERIOD_MS);
+}
+
+/* [] END OF FILE */
+
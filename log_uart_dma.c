@@ -0,0 +1,296 @@
+/*******************************************************************************
+ * File Name:   log_uart_dma.c
+ *
+ * Description: This file contains the DMA driven debug UART output. It is used
+ * as configPRINT_STRING by the logging task, and by the binary log drain task.
+ * Instead of writing one character at a time through cy_retarget_io, the
+ * output is copied into one of two buffers, and the other buffer is sent by
+ * DMA in the meantime. The CPU can enter sleep while the bytes drain.
+ *
+ * The text printed directly with printf, such as by the WHD and the LPA
+ * middleware, still goes through cy_retarget_io.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+
+/* Include header files */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include <stdbool.h>
+#include <string.h>
+
+/* BSP & HAL includes. */
+#include "cyhal.h"
+#include "cy_retarget_io.h"
+
+#include "log_uart_dma.h"
+
+/*******************************************************************************
+ * Static Global Structures and variables
+ ******************************************************************************/
+static uint8_t log_uart_dma_buffer[2][LOG_UART_DMA_BUFFER_SIZE];
+
+/* Buffer being filled, and the number of bytes in it. The other buffer is
+ * being sent while log_uart_dma_busy is set. Shared with the UART interrupt.
+ */
+static volatile uint32_t log_uart_dma_active = 0;
+static volatile uint32_t log_uart_dma_fill = 0;
+static volatile bool log_uart_dma_busy = false;
+
+/* Given by the UART interrupt when a transfer is done. */
+static SemaphoreHandle_t log_uart_dma_done = NULL;
+
+/* Keeps the output of one writer contiguous. */
+static SemaphoreHandle_t log_uart_dma_mutex = NULL;
+
+static bool log_uart_dma_ready = false;
+
+/*******************************************************************************
+ * Function definitions
+ ******************************************************************************/
+/*******************************************************************************
+* Function Name: log_uart_dma_start
+********************************************************************************
+* Summary:
+*  Starts sending the buffer being filled, and switches to the other buffer.
+*  Must be called with the UART interrupt masked, or from it, when no transfer
+*  is in progress.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  bool: true if the transfer is started, false if the bytes are still in the
+*  buffer being filled.
+*
+*******************************************************************************/
+static bool log_uart_dma_start(void)
+{
+    if (CY_RSLT_SUCCESS != cyhal_uart_write_async(&cy_retarget_io_uart_obj,
+                                                  log_uart_dma_buffer[log_uart_dma_active],
+                                                  log_uart_dma_fill))
+    {
+        return false;
+    }
+
+    log_uart_dma_busy = true;
+    log_uart_dma_active ^= 1;
+    log_uart_dma_fill = 0;
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: log_uart_dma_send_blocking
+********************************************************************************
+* Summary:
+*  Sends the buffer being filled without DMA, when a transfer could not be
+*  started. No transfer is in progress then, so the interrupt does not use the
+*  buffer. Must be called by the writer holding the mutex.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void log_uart_dma_send_blocking(void)
+{
+    size_t length = log_uart_dma_fill;
+
+    (void)cyhal_uart_write(&cy_retarget_io_uart_obj, log_uart_dma_buffer[log_uart_dma_active], &length);
+    log_uart_dma_fill = 0;
+}
+
+/*******************************************************************************
+* Function Name: log_uart_dma_event
+********************************************************************************
+* Summary:
+*  UART event callback. When a transfer is done, starts sending the other
+*  buffer if it has any bytes, and wakes up a writer waiting for space. If the
+*  transfer can not be started, the bytes are sent by the next writer.
+*
+* Parameters:
+*  callback_arg : Unused.
+*  event        : UART events.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void log_uart_dma_event(void *callback_arg, cyhal_uart_event_t event)
+{
+    BaseType_t higher_priority_task_woken = pdFALSE;
+
+    (void)callback_arg;
+
+    if (0 != (event & CYHAL_UART_IRQ_TX_DONE))
+    {
+        log_uart_dma_busy = false;
+        if (0 != log_uart_dma_fill)
+        {
+            (void)log_uart_dma_start();
+        }
+
+        (void)xSemaphoreGiveFromISR(log_uart_dma_done, &higher_priority_task_woken);
+        portYIELD_FROM_ISR(higher_priority_task_woken);
+    }
+}
+
+/*******************************************************************************
+* Function Name: log_uart_dma_init
+********************************************************************************
+* Summary:
+*  Switches the debug UART initialized by cy_retarget_io to DMA transfers.
+*  The output is written with cy_retarget_io until this is done.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  cy_rslt_t: Returns CY_RSLT_SUCCESS if the DMA output is ready, an error
+*  code otherwise.
+*
+*******************************************************************************/
+cy_rslt_t log_uart_dma_init(void)
+{
+    cy_rslt_t result;
+
+    log_uart_dma_done = xSemaphoreCreateBinary();
+    log_uart_dma_mutex = xSemaphoreCreateMutex();
+    if ((NULL == log_uart_dma_done) || (NULL == log_uart_dma_mutex))
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    result = cyhal_uart_set_async_mode(&cy_retarget_io_uart_obj, CYHAL_ASYNC_DMA, CYHAL_DMA_PRIORITY_DEFAULT);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        return result;
+    }
+
+    /* The interrupt priority must be masked by the FreeRTOS critical sections. */
+    cyhal_uart_register_callback(&cy_retarget_io_uart_obj, log_uart_dma_event, NULL);
+    cyhal_uart_enable_event(&cy_retarget_io_uart_obj, CYHAL_UART_IRQ_TX_DONE, CYHAL_ISR_PRIORITY_DEFAULT, true);
+
+    log_uart_dma_ready = true;
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: log_uart_dma_write
+********************************************************************************
+* Summary:
+*  Copies the data to the buffer being filled, and starts sending it if no
+*  transfer is in progress. Blocks only if both buffers are in use, or if a
+*  transfer can not be started, in which case the buffer is sent without DMA.
+*  This must be called from a task.
+*
+* Parameters:
+*  data   : Data to send.
+*  length : Number of bytes to send.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void log_uart_dma_write(const uint8_t *data, size_t length)
+{
+    size_t chunk;
+    bool started;
+
+    if (!log_uart_dma_ready || (taskSCHEDULER_RUNNING != xTaskGetSchedulerState()))
+    {
+        (void)cyhal_uart_write(&cy_retarget_io_uart_obj, (void *)data, &length);
+        return;
+    }
+
+    (void)xSemaphoreTake(log_uart_dma_mutex, portMAX_DELAY);
+
+    while (0 != length)
+    {
+        taskENTER_CRITICAL();
+
+        chunk = LOG_UART_DMA_BUFFER_SIZE - log_uart_dma_fill;
+        if (chunk > length)
+        {
+            chunk = length;
+        }
+        memcpy(&log_uart_dma_buffer[log_uart_dma_active][log_uart_dma_fill], data, chunk);
+        log_uart_dma_fill += chunk;
+
+        started = log_uart_dma_busy || log_uart_dma_start();
+
+        taskEXIT_CRITICAL();
+
+        data += chunk;
+        length -= chunk;
+
+        if (!started)
+        {
+            /* Nothing would give log_uart_dma_done. */
+            log_uart_dma_send_blocking();
+        }
+        else if (0 != length)
+        {
+            /* Both buffers are in use. Waits for the transfer to finish. */
+            (void)xSemaphoreTake(log_uart_dma_done, portMAX_DELAY);
+        }
+    }
+
+    (void)xSemaphoreGive(log_uart_dma_mutex);
+}
+
+/*******************************************************************************
+* Function Name: log_uart_dma_print
+********************************************************************************
+* Summary:
+*  Sends a string. Used as configPRINT_STRING by the logging task.
+*
+* Parameters:
+*  string : NUL terminated string.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void log_uart_dma_print(const char *string)
+{
+    log_uart_dma_write((const uint8_t *)string, strlen(string));
+}
+
+
+/* [] END OF FILE */
+
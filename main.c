@@ -58,9 +58,21 @@
 
 /* LPA offload configuration includes. */
 #include "wlan_offload.h"
+#include "wlan_offload_spec.h"
+#include "wlan_offload_monitor.h"
 
 /* For print macro expansion. */
 #include "wifi_config.h"
+#include "app_log_benchmark.h"
+#include "log_uart_dma.h"
+#include "sleep_stats.h"
+#include "trace_stream.h"
+#include "mem_usage.h"
+#include "netif_tx_chain.h"
+#include "tcp_tune.h"
+#include "mqtt_client.h"
+#include "mqtt_batch.h"
+#include "shadow_client.h"
 
 /* Logging Task Defines. */
 #define mainLOGGING_MESSAGE_QUEUE_LENGTH    ( 200 )
@@ -101,16 +113,34 @@ extern int uxTopUsedPriority;
  */
 int main(void)
 {
+    /* Validates the log records and the crash details retained from before
+     * the reset. This is done before anything is logged.
+     */
+    retained_log_init();
+
     /* Performs any hardware initialization that does not
      * require the RTOS to be running.
      */
     prvMiscInitialization();
 
+#if TRACE_STREAM
+    /* Starts recording the kernel events before the tasks are created. */
+    trace_stream_init();
+#endif
+
     /* Create tasks that are not dependent on the Wi-Fi being initialized. */
     xLoggingTaskInitialize(mainLOGGING_TASK_STACK_SIZE,
                            tskIDLE_PRIORITY,
                            mainLOGGING_MESSAGE_QUEUE_LENGTH);
 
+#if APP_LOG_BINARY
+    /* Creates the task which sends the binary APP_INFO/ERR_INFO records. */
+    if (CY_RSLT_SUCCESS != app_log_init())
+    {
+        CY_ASSERT(0);
+    }
+#endif
+
     /* Start the scheduler. Initialization that requires the OS to be running,
      * including the Wi-Fi initialization, is performed in the RTOS daemon task
      * startup hook.
@@ -136,6 +166,24 @@ static void prvMiscInitialization(void)
     {
         CY_ASSERT(0);
     }
+
+#if SLEEP_STATS
+    /* Starts measuring the time spent in each power mode. */
+    result = sleep_stats_init();
+    if (CY_RSLT_SUCCESS != result)
+    {
+        CY_ASSERT(0);
+    }
+#endif
+
+#if LOG_UART_DMA
+    /* Switches the output of the logging task to DMA transfers. */
+    result = log_uart_dma_init();
+    if (CY_RSLT_SUCCESS != result)
+    {
+        CY_ASSERT(0);
+    }
+#endif
 }
 /*-----------------------------------------------------------*/
 
@@ -152,6 +200,15 @@ void vApplicationDaemonTaskStartupHook(void)
     APP_INFO(("AWS IoT and FreeRTOS for PSoC 6: WLAN Offloads\n"));
     APP_INFO(("================================================\n\n"));
 
+    /* Prints the crash report of the previous boot, if any. It is also sent
+     * to the TCP server once connected.
+     */
+    retained_log_print_report();
+
+#if APP_LOG_BENCHMARK
+    app_log_benchmark_run();
+#endif
+
     /* Initialize secure sockets */
     if(SYSTEM_Init() == pdPASS)
     {
@@ -160,32 +217,41 @@ void vApplicationDaemonTaskStartupHook(void)
          * Initializes the lwIP stack. This needs the RTOS to be up
          * since this function will spawn the tcp_ip thread.
          */
+#if MEM_USAGE_STATS
+        (void)mem_usage_set_tag(MEM_USAGE_TAG_LWIP);
+#endif
         tcpip_init(NULL, NULL);
+
+#if !LWIP_NETIF_TX_SINGLE_PBUF
+        /* Passes the chained frames to the Wi-Fi driver as single buffers. */
+        netif_tx_chain_init();
 #endif
 
-        /* Initializes the Wi-Fi interface.
-         * The Wi-Fi interface needs to be only initialized but not connected to the
-         * Access Point before applying the WLAN offload configuration to the Offload
-         * manager.
-         */
+#if TCP_TUNE
+        /* Sizes the TCP windows and send buffers for the data each connection moves. */
+        tcp_tune_init();
+#endif
+#endif
+
+#if MEM_USAGE_STATS
+        /* Attributes the Wi-Fi driver initialization and association to WHD. */
+        (void)mem_usage_set_tag(MEM_USAGE_TAG_WHD);
+#endif
+
+        /* Initializes the Wi-Fi interface. */
         if (eWiFiSuccess != WIFI_On())
         {
             PRINT_AND_ASSERT(CY_RSLT_TYPE_ERROR, "Failed to initialize the Wi-Fi interface.");
         }
 
-#if !(USE_CONFIGURATOR_GENERATED_CONFIG)
-        /* 
-         * Configures the offload list and applies them to the offload manager (OLM).
-         * Note that, the offload configuration list should be applied to the OLM before
-         * the Wi-Fi associates to the Access Point. If the Wi-Fi is already associated,
-         * disconnect it, apply the offload configuration list to the OLM, and then
-         * reassociate to the AP.
+        /* The offload manager (OLM) initializes with the list of the generated
+         * cycfg_connectivity_wifi.c when the Wi-Fi interface is initialized. The
+         * build checks that the file is the generated one, so the OLM never runs
+         * offloads other than those of the specification.
          */
-        result = olm_apply_offload_configuration();
-        PRINT_AND_ASSERT(result, "Failed to apply the offload configuration.\n");
-#else
-        APP_INFO(("--Offload Manager is initialized with the device configurator generated configuration--\n"));
-#endif
+        PRINT_AND_ASSERT((get_default_ol_list() == wlan_offload_spec_get_ol_list()) ? CY_RSLT_SUCCESS :
+                         CY_RSLT_TYPE_ERROR, "cycfg_connectivity_wifi.c is out of date. Run offload_spec_gen.py.\n");
+        APP_INFO(("--Offload Manager is initialized with the offload specification--\n"));
 
         /*
          * Connect to Wi-Fi Access Point.
@@ -193,6 +259,29 @@ void vApplicationDaemonTaskStartupHook(void)
         result = prvWifiConnect();
         PRINT_AND_ASSERT(result, "Wi-Fi connection failed.\n");
 
+#if MEM_USAGE_STATS
+        /* Attributes the sockets to lwIP. */
+        (void)mem_usage_set_tag(MEM_USAGE_TAG_LWIP);
+#endif
+
+#if MQTT_CLIENT
+        /* Starts the MQTT receive task. The client connects to the broker when
+         * its TCP Keepalive offload connection is established below.
+         */
+#if SHADOW_CLIENT
+        result = shadow_client_init(NULL);
+        PRINT_AND_ASSERT(result, "Failed to initialize the shadow client.\n");
+        result = mqtt_client_init(shadow_client_handle_publish);
+#else
+        result = mqtt_client_init(NULL);
+#endif
+        PRINT_AND_ASSERT(result, "Failed to initialize the MQTT client.\n");
+#if MQTT_BATCH
+        result = mqtt_batch_init();
+        PRINT_AND_ASSERT(result, "Failed to initialize the MQTT publish batching.\n");
+#endif
+#endif
+
         /*
          * Establishes TCP socket connection with the configured TCP server.
          * Ensure the remote TCP server has already started before running this application.
@@ -211,6 +300,23 @@ void vApplicationDaemonTaskStartupHook(void)
             vTaskDelay(pdMS_TO_TICKS(TCP_SOCKET_ERROR_DELAY_MS));
         }
 
+#if MEM_USAGE_STATS
+        (void)mem_usage_set_tag(MEM_USAGE_TAG_APP);
+#endif
+
+#if OFFLOAD_MONITOR
+        /*
+         * Re-applies the offload state affected by a roam, a reassociation,
+         * or an IP address change. Without this, a stale host IP table or
+         * TCP Keepalive connection causes the host to wake up for every packet.
+         */
+        result = wlan_offload_monitor_init();
+        if (CY_RSLT_SUCCESS != result)
+        {
+            ERR_INFO(("Failed to start the offload monitor.\n"));
+        }
+#endif
+
         /*
          * Suspends/Resumes the lwIP network stack.
          * This task will cause PSoC 6 MCU to go into deep sleep power mode.
@@ -229,18 +335,14 @@ void vApplicationDaemonTaskStartupHook(void)
  */
 void vApplicationIdleHook(void)
 {
-    /* FIX ME. If necessary, update to application idle periodic actions. */
-
-    static TickType_t xLastPrint = 0;
-    TickType_t xTimeNow;
-    const TickType_t xPrintFrequency = pdMS_TO_TICKS(5000);
-
-    xTimeNow = xTaskGetTickCount();
+#if SLEEP_STATS
+    /* Keeps the sleep residency timebase up to date before each sleep attempt. */
+    sleep_stats_on_idle();
+#endif
 
-    if((xTimeNow - xLastPrint) > xPrintFrequency)
-    {
-        xLastPrint = xTimeNow;
-    }
+#if TRACE_STREAM
+    trace_stream_on_idle();
+#endif
 }
 
 void vApplicationTickHook()
@@ -296,8 +398,14 @@ void vAssertCalled(const char *pcFile, uint32_t ulLine)
     (void)pcFileName;
     (void)ulLineNumber;
 
-    ERR_INFO(("vAssertCalled %s, %ld\n", pcFile, (long)ulLine));
-    fflush(stdout);
+    /* The fault is recorded first, and printed without the heap or the
+     * logging task, which may be the cause of the fault.
+     */
+    retained_log_fault(RETAINED_LOG_FAULT_ASSERT, pcFile, ulLine, NULL);
+#if APP_LOG_BINARY
+    app_log_flush();
+#endif
+    retained_log_fault_print("vAssertCalled %s, %ld\r\n", pcFile, (long)ulLine);
 
     /* Setting ulBlockVariable to a non-zero value in the debugger will allow
      * this function to be exited.
@@ -325,7 +433,8 @@ void vAssertCalled(const char *pcFile, uint32_t ulLine)
  */
 void vApplicationMallocFailedHook()
 {
-    ERR_INFO(("Malloc failed to allocate memory\r\n"));
+    retained_log_fault(RETAINED_LOG_FAULT_MALLOC, NULL, 0, NULL);
+    retained_log_fault_print("Malloc failed to allocate memory\r\n");
     taskDISABLE_INTERRUPTS();
 
     /* Loop forever */
@@ -348,7 +457,8 @@ void vApplicationMallocFailedHook()
  */
 void vApplicationStackOverflowHook(TaskHandle_t xTask, char *pcTaskName)
 {
-    ERR_INFO(("stack overflow with task %s\r\n", pcTaskName));
+    retained_log_fault(RETAINED_LOG_FAULT_STACK_OVERFLOW, NULL, 0, pcTaskName);
+    retained_log_fault_print("stack overflow with task %s\r\n", pcTaskName);
     portDISABLE_INTERRUPTS();
 
     /* Unused Parameters */
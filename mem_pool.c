@@ -0,0 +1,372 @@
+/*******************************************************************************
+ * File Name:   mem_pool.c
+ *
+ * Description: This file contains the static size-class pools which serve the
+ * lwIP heap. With MEM_LIBC_MALLOC, lwIP allocates the PBUF_RAM buffers, which
+ * hold the TCP segments of the secure sockets and so the TLS records, from the
+ * C library heap. The pools hold the same allocations in fixed-size blocks
+ * that are sized from the number of sockets and offloaded connections, so
+ * that the memory needed by the network stack is known at link time and does
+ * not fragment the C library heap over a long uptime.
+ *
+ * An allocation which does not fit a block, or finds its pool empty, falls
+ * back to the C library heap and is counted in the pool report.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+
+/* Include header files */
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <lwip/opt.h>
+#include <lwip/mem.h>
+#include <lwip/pbuf.h>
+
+/* Secure sockets configuration. */
+#include "aws_secure_sockets_config.h"
+
+/* Low Power Assistant TCP keepalive offload header file. */
+#include "cy_lpa_wifi_tko_ol.h"
+
+#include "mem_pool.h"
+#include "wifi_config.h"
+
+#if MEM_STATIC_POOLS
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Small blocks hold the protocol headers and the short control segments, such
+ * as TCP ACKs and TLS alerts. Two per secure socket, plus a few for DHCP, DNS
+ * and ICMP.
+ */
+#define MEM_POOL_SMALL_SIZE                  (LWIP_MEM_ALIGN_SIZE(256))
+#define MEM_POOL_SMALL_COUNT                 (2 * socketsconfigDEFAULT_MAX_NUM_SECURE_SOCKETS + 4)
+
+/* Large blocks hold a full TCP segment in a PBUF_RAM pbuf, including the size
+ * lwIP adds in front of the buffer for its heap statistics. Enough for the send
+ * buffers of the offloaded connections filled with full segments, plus one for
+ * a connection being set up. With TCP_TUNE, the send buffers together stay
+ * within TCP_TUNE_TX_BUDGET, or the base sizes if these are larger.
+ */
+#define MEM_POOL_LARGE_SIZE                  (LWIP_MEM_ALIGN_SIZE(sizeof(struct pbuf)) + \
+                                              LWIP_MEM_ALIGN_SIZE(PBUF_POOL_BUFSIZE) + \
+                                              LWIP_MEM_ALIGN_SIZE(sizeof(mem_size_t)))
+#if TCP_TUNE
+#define MEM_POOL_SND_BUF_TOTAL               LWIP_MAX(TCP_TUNE_TX_BUDGET, (MAX_TKO_CONN * TCP_TUNE_SND_BUF_BASE))
+#else
+#define MEM_POOL_SND_BUF_TOTAL               (MAX_TKO_CONN * TCP_SND_BUF)
+#endif
+#define MEM_POOL_LARGE_COUNT                 (((MEM_POOL_SND_BUF_TOTAL + TCP_MSS - 1) / TCP_MSS) + 1)
+
+#define MEM_POOL_COUNT                       (2)
+
+/*******************************************************************************
+ * Static Global Structures and variables
+ ******************************************************************************/
+/* Free block, linked through its first word. */
+typedef struct mem_pool_block
+{
+    struct mem_pool_block *next;
+} mem_pool_block_t;
+
+/* Fixed-size block pool. */
+typedef struct
+{
+    const char *name;
+    uint8_t *storage;              /* First block. */
+    size_t block_size;
+    uint32_t block_count;
+    mem_pool_block_t *free_list;
+    uint32_t used;
+    uint32_t peak;
+} mem_pool_t;
+
+static uint8_t mem_pool_small_storage[MEM_POOL_SMALL_COUNT][MEM_POOL_SMALL_SIZE] __attribute__((aligned(8)));
+static uint8_t mem_pool_large_storage[MEM_POOL_LARGE_COUNT][MEM_POOL_LARGE_SIZE] __attribute__((aligned(8)));
+
+/* Pools in the order of increasing block size. */
+static mem_pool_t mem_pools[MEM_POOL_COUNT] =
+{
+    { "small", &mem_pool_small_storage[0][0], MEM_POOL_SMALL_SIZE, MEM_POOL_SMALL_COUNT, NULL, 0, 0 },
+    { "large", &mem_pool_large_storage[0][0], MEM_POOL_LARGE_SIZE, MEM_POOL_LARGE_COUNT, NULL, 0, 0 }
+};
+
+static bool mem_pool_initialized = false;
+
+/* Allocations served from the C library heap. */
+static uint32_t mem_pool_fallback = 0;
+static uint32_t mem_pool_fallback_oversize = 0;
+
+/*******************************************************************************
+ * Function definitions
+ ******************************************************************************/
+/*******************************************************************************
+* Function Name: mem_pool_init
+********************************************************************************
+* Summary:
+*  Links the blocks of all the pools into their free lists. This is run on the
+*  first allocation. Must be called in a critical section.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void mem_pool_init(void)
+{
+    mem_pool_t *pool;
+    uint32_t index;
+    uint32_t block;
+
+    for (index = 0; index < MEM_POOL_COUNT; index++)
+    {
+        pool = &mem_pools[index];
+        pool->free_list = NULL;
+
+        for (block = pool->block_count; block > 0; block--)
+        {
+            mem_pool_block_t *entry = (mem_pool_block_t *)(pool->storage + ((block - 1) * pool->block_size));
+
+            entry->next = pool->free_list;
+            pool->free_list = entry;
+        }
+    }
+
+    mem_pool_initialized = true;
+}
+
+/*******************************************************************************
+* Function Name: mem_pool_find
+********************************************************************************
+* Summary:
+*  Returns the pool to which the given block belongs.
+*
+* Parameters:
+*  address : Address of the block.
+*
+* Return:
+*  mem_pool_t *: Pool of the block, or NULL if the block was allocated from the
+*  C library heap.
+*
+*******************************************************************************/
+static mem_pool_t *mem_pool_find(const void *address)
+{
+    const uint8_t *block = (const uint8_t *)address;
+    uint32_t index;
+
+    for (index = 0; index < MEM_POOL_COUNT; index++)
+    {
+        if ((block >= mem_pools[index].storage) &&
+            (block < (mem_pools[index].storage + (mem_pools[index].block_count * mem_pools[index].block_size))))
+        {
+            return &mem_pools[index];
+        }
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+* Function Name: mem_pool_malloc
+********************************************************************************
+* Summary:
+*  Allocates a block from the smallest pool that fits the size and has a free
+*  block, or from the C library heap if there is none.
+*
+* Parameters:
+*  size : Size of the allocation in bytes.
+*
+* Return:
+*  void *: Allocated memory, or NULL if the allocation failed.
+*
+*******************************************************************************/
+void *mem_pool_malloc(size_t size)
+{
+    mem_pool_block_t *block = NULL;
+    mem_pool_t *pool;
+    uint32_t index;
+
+    taskENTER_CRITICAL();
+
+    if (!mem_pool_initialized)
+    {
+        mem_pool_init();
+    }
+
+    for (index = 0; (index < MEM_POOL_COUNT) && (NULL == block); index++)
+    {
+        pool = &mem_pools[index];
+        if ((size <= pool->block_size) && (NULL != pool->free_list))
+        {
+            block = pool->free_list;
+            pool->free_list = block->next;
+            pool->used++;
+            if (pool->used > pool->peak)
+            {
+                pool->peak = pool->used;
+            }
+        }
+    }
+
+    if (NULL == block)
+    {
+        mem_pool_fallback++;
+        if (size > MEM_POOL_LARGE_SIZE)
+        {
+            mem_pool_fallback_oversize++;
+        }
+    }
+
+    taskEXIT_CRITICAL();
+
+    return (NULL != block) ? (void *)block : malloc(size);
+}
+
+/*******************************************************************************
+* Function Name: mem_pool_calloc
+********************************************************************************
+* Summary:
+*  Allocates a zeroed array with mem_pool_malloc().
+*
+* Parameters:
+*  count : Number of elements.
+*  size  : Size of an element in bytes.
+*
+* Return:
+*  void *: Allocated memory, or NULL if the allocation failed.
+*
+*******************************************************************************/
+void *mem_pool_calloc(size_t count, size_t size)
+{
+    void *address = NULL;
+
+    if ((0 == size) || (count <= (SIZE_MAX / size)))
+    {
+        address = mem_pool_malloc(count * size);
+        if (NULL != address)
+        {
+            memset(address, 0, count * size);
+        }
+    }
+
+    return address;
+}
+
+/*******************************************************************************
+* Function Name: mem_pool_free
+********************************************************************************
+* Summary:
+*  Returns a block to its pool, or to the C library heap if it was allocated
+*  from there.
+*
+* Parameters:
+*  address : Address of the block.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void mem_pool_free(void *address)
+{
+    mem_pool_t *pool = mem_pool_find(address);
+    mem_pool_block_t *block = (mem_pool_block_t *)address;
+
+    if (NULL == pool)
+    {
+        free(address);
+        return;
+    }
+
+    taskENTER_CRITICAL();
+
+    block->next = pool->free_list;
+    pool->free_list = block;
+    pool->used--;
+
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+* Function Name: mem_pool_print
+********************************************************************************
+* Summary:
+*  Prints the usage of the pools.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void mem_pool_print(void)
+{
+    mem_pool_t pools[MEM_POOL_COUNT];
+    uint32_t fallback;
+    uint32_t fallback_oversize;
+    uint32_t index;
+
+    taskENTER_CRITICAL();
+    memcpy(pools, mem_pools, sizeof(pools));
+    fallback = mem_pool_fallback;
+    fallback_oversize = mem_pool_fallback_oversize;
+    taskEXIT_CRITICAL();
+
+    APP_INFO(("lwIP static pools: %lu bytes\n",
+              (unsigned long)(sizeof(mem_pool_small_storage) + sizeof(mem_pool_large_storage))));
+
+    for (index = 0; index < MEM_POOL_COUNT; index++)
+    {
+        APP_INFO(("  %-5s %4lu byte blocks %3lu/%3lu used, peak %3lu\n", pools[index].name,
+                  (unsigned long)pools[index].block_size, (unsigned long)pools[index].used,
+                  (unsigned long)pools[index].block_count, (unsigned long)pools[index].peak));
+    }
+
+    if (0 != fallback)
+    {
+        APP_INFO(("  %lu allocations from the C library heap, %lu larger than a block\n",
+                  (unsigned long)fallback, (unsigned long)fallback_oversize));
+    }
+}
+
+#endif /* MEM_STATIC_POOLS */
+
+
+/* [] END OF FILE */
+
@@ -0,0 +1,386 @@
+/*******************************************************************************
+ * File Name:   mem_usage.c
+ *
+ * Description: This file contains the heap and lwIP pool usage tracking. The
+ * FreeRTOS heap allocations are recorded by the traceMALLOC and traceFREE
+ * hooks set in FreeRTOSConfig.h, and are attributed to the subsystem of the
+ * allocating task: WHD, lwIP, mbedTLS, MQTT, or the application. A task is
+ * attributed by its name on its first allocation, and the attribution can be
+ * overridden around a call with mem_usage_set_tag(). The subsystem is kept
+ * with each live block, so that a block freed by another task is subtracted
+ * from the subsystem which allocated it.
+ *
+ * The report shows the current and peak heap usage of each subsystem, the
+ * C library heap, and the lwIP heap and memory pool high-water marks, which
+ * are used to size the FreeRTOS heap and the lwIP pools.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+
+/* Include header files */
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdbool.h>
+#include <string.h>
+#include <malloc.h>
+#include <lwip/opt.h>
+#include <lwip/memp.h>
+#include <lwip/stats.h>
+
+#include "mem_usage.h"
+#include "mem_pool.h"
+#include "wifi_config.h"
+
+#if MEM_USAGE_STATS
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Maximum number of live heap blocks which can be tracked. Must be a power of
+ * two. The blocks allocated while the table is full are not attributed.
+ */
+#define MEM_USAGE_MAX_BLOCKS                 (512)
+
+#define MEM_USAGE_SIZE_MASK                  (0x00FFFFFFUL)
+#define MEM_USAGE_TAG_SHIFT                  (24)
+
+#define MEM_USAGE_SLOT(address)              (((uintptr_t)(address) >> 3) & (MEM_USAGE_MAX_BLOCKS - 1))
+
+/*******************************************************************************
+ * Static Global Structures and variables
+ ******************************************************************************/
+/* Live heap block. Size in the low 24 bits, subsystem in the high 8 bits. */
+typedef struct
+{
+    void *address;
+    uint32_t info;
+} mem_usage_block_t;
+
+/* Usage of a subsystem. */
+typedef struct
+{
+    uint32_t current;
+    uint32_t peak;
+    uint32_t blocks;
+    uint32_t failed;
+} mem_usage_tag_stats_t;
+
+/* Task name prefixes of the subsystem threads. Other tasks are attributed to
+ * the application.
+ */
+typedef struct
+{
+    const char *prefix;
+    uint8_t tag;
+} mem_usage_task_map_t;
+
+static const mem_usage_task_map_t mem_usage_task_map[] =
+{
+    { "WHD",      MEM_USAGE_TAG_WHD  },
+    { "IOT-Wifi", MEM_USAGE_TAG_WHD  },
+    { "tcpip",    MEM_USAGE_TAG_LWIP },
+    { "Mqtt",     MEM_USAGE_TAG_MQTT },
+    { "IDLE",     MEM_USAGE_TAG_RTOS },
+};
+
+static const char * const mem_usage_tag_names[MEM_USAGE_TAG_COUNT] =
+{
+    "Other", "RTOS", "App", "WHD", "lwIP", "TLS", "MQTT"
+};
+
+static mem_usage_block_t mem_usage_blocks[MEM_USAGE_MAX_BLOCKS];
+static uint32_t mem_usage_block_count = 0;
+static uint32_t mem_usage_untracked = 0;
+static mem_usage_tag_stats_t mem_usage_stats[MEM_USAGE_TAG_COUNT];
+
+/*******************************************************************************
+ * Function definitions
+ ******************************************************************************/
+/*******************************************************************************
+* Function Name: mem_usage_get_tag
+********************************************************************************
+* Summary:
+*  Returns the subsystem of the calling task. The subsystem is kept in the
+*  application task tag, which is set from the task name if not set yet.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  uint8_t: MEM_USAGE_TAG_* subsystem.
+*
+*******************************************************************************/
+static uint8_t mem_usage_get_tag(void)
+{
+    const char *name;
+    uint8_t tag;
+    size_t index;
+
+    if (taskSCHEDULER_NOT_STARTED == xTaskGetSchedulerState())
+    {
+        return MEM_USAGE_TAG_RTOS;
+    }
+
+    tag = (uint8_t)(uintptr_t)xTaskGetApplicationTaskTag(NULL);
+    if (MEM_USAGE_TAG_NONE != tag)
+    {
+        return tag;
+    }
+
+    tag = MEM_USAGE_TAG_APP;
+    name = pcTaskGetName(NULL);
+    for (index = 0; index < (sizeof(mem_usage_task_map) / sizeof(mem_usage_task_map[0])); index++)
+    {
+        if (0 == strncmp(name, mem_usage_task_map[index].prefix, strlen(mem_usage_task_map[index].prefix)))
+        {
+            tag = mem_usage_task_map[index].tag;
+            break;
+        }
+    }
+
+    vTaskSetApplicationTaskTag(NULL, (TaskHookFunction_t)(uintptr_t)tag);
+
+    return tag;
+}
+
+/*******************************************************************************
+* Function Name: mem_usage_on_malloc
+********************************************************************************
+* Summary:
+*  Records a FreeRTOS heap allocation. Called by the traceMALLOC hook, with
+*  the scheduler suspended.
+*
+* Parameters:
+*  address : Allocated block, or NULL if the allocation failed.
+*  size    : Size of the block, including the heap header.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void mem_usage_on_malloc(void *address, size_t size)
+{
+    mem_usage_tag_stats_t *stats;
+    uint8_t tag = mem_usage_get_tag();
+    uint32_t slot;
+
+    stats = &mem_usage_stats[tag];
+
+    if (NULL == address)
+    {
+        stats->failed++;
+        return;
+    }
+
+    /* Keeps one slot free, so that the probing always ends. */
+    if (mem_usage_block_count >= (MEM_USAGE_MAX_BLOCKS - 1))
+    {
+        mem_usage_untracked++;
+        return;
+    }
+
+    slot = MEM_USAGE_SLOT(address);
+    while (NULL != mem_usage_blocks[slot].address)
+    {
+        slot = (slot + 1) & (MEM_USAGE_MAX_BLOCKS - 1);
+    }
+    mem_usage_blocks[slot].address = address;
+    mem_usage_blocks[slot].info = ((uint32_t)size & MEM_USAGE_SIZE_MASK) | ((uint32_t)tag << MEM_USAGE_TAG_SHIFT);
+    mem_usage_block_count++;
+
+    stats->current += size;
+    stats->blocks++;
+    if (stats->current > stats->peak)
+    {
+        stats->peak = stats->current;
+    }
+}
+
+/*******************************************************************************
+* Function Name: mem_usage_on_free
+********************************************************************************
+* Summary:
+*  Subtracts a freed FreeRTOS heap block from the subsystem which allocated
+*  it. Called by the traceFREE hook, with the scheduler suspended.
+*
+* Parameters:
+*  address : Freed block.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void mem_usage_on_free(void *address)
+{
+    mem_usage_tag_stats_t *stats;
+    uint32_t slot = MEM_USAGE_SLOT(address);
+    uint32_t next;
+    uint32_t home;
+
+    while (address != mem_usage_blocks[slot].address)
+    {
+        if (NULL == mem_usage_blocks[slot].address)
+        {
+            /* Not tracked. */
+            return;
+        }
+        slot = (slot + 1) & (MEM_USAGE_MAX_BLOCKS - 1);
+    }
+
+    stats = &mem_usage_stats[mem_usage_blocks[slot].info >> MEM_USAGE_TAG_SHIFT];
+    stats->current -= mem_usage_blocks[slot].info & MEM_USAGE_SIZE_MASK;
+    stats->blocks--;
+    mem_usage_block_count--;
+
+    /* Moves back the following blocks of the probe sequence into the hole. */
+    next = slot;
+    while (true)
+    {
+        next = (next + 1) & (MEM_USAGE_MAX_BLOCKS - 1);
+        if (NULL == mem_usage_blocks[next].address)
+        {
+            break;
+        }
+
+        home = MEM_USAGE_SLOT(mem_usage_blocks[next].address);
+        if (((next > slot) && ((home <= slot) || (home > next))) ||
+            ((next < slot) && (home <= slot) && (home > next)))
+        {
+            mem_usage_blocks[slot] = mem_usage_blocks[next];
+            slot = next;
+        }
+    }
+    mem_usage_blocks[slot].address = NULL;
+}
+
+/*******************************************************************************
+* Function Name: mem_usage_set_tag
+********************************************************************************
+* Summary:
+*  Sets the subsystem to which the allocations of the calling task are
+*  attributed, such as around a call into a library which allocates on behalf
+*  of the caller.
+*
+* Parameters:
+*  tag : MEM_USAGE_TAG_* subsystem, or MEM_USAGE_TAG_NONE to attribute the
+*        task by its name again.
+*
+* Return:
+*  uint8_t: Previous subsystem, to be restored after the call.
+*
+*******************************************************************************/
+uint8_t mem_usage_set_tag(uint8_t tag)
+{
+    uint8_t previous = (uint8_t)(uintptr_t)xTaskGetApplicationTaskTag(NULL);
+
+    vTaskSetApplicationTaskTag(NULL, (TaskHookFunction_t)(uintptr_t)tag);
+
+    return previous;
+}
+
+/*******************************************************************************
+* Function Name: mem_usage_print
+********************************************************************************
+* Summary:
+*  Prints the current and peak FreeRTOS heap usage of each subsystem, the C
+*  library heap usage, and the lwIP heap and memory pool high-water marks.
+*  This is run by the wake scheduler in the first host wake window after every
+*  MEM_USAGE_REPORT_INTERVAL_SEC seconds.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void mem_usage_print(void)
+{
+    mem_usage_tag_stats_t stats[MEM_USAGE_TAG_COUNT];
+    uint32_t untracked;
+    struct mallinfo libc_heap;
+    uint32_t index;
+
+    vTaskSuspendAll();
+    memcpy(stats, mem_usage_stats, sizeof(stats));
+    untracked = mem_usage_untracked;
+    (void)xTaskResumeAll();
+
+    APP_INFO(("Heap: %lu bytes free, %lu bytes minimum ever free, of %lu bytes\n",
+              (unsigned long)xPortGetFreeHeapSize(), (unsigned long)xPortGetMinimumEverFreeHeapSize(),
+              (unsigned long)configTOTAL_HEAP_SIZE));
+
+    for (index = 0; index < MEM_USAGE_TAG_COUNT; index++)
+    {
+        if ((0 != stats[index].peak) || (0 != stats[index].failed))
+        {
+            APP_INFO(("  %-5s %6lu bytes in %3lu blocks, peak %6lu bytes, %lu failed\n",
+                      mem_usage_tag_names[index], (unsigned long)stats[index].current,
+                      (unsigned long)stats[index].blocks, (unsigned long)stats[index].peak,
+                      (unsigned long)stats[index].failed));
+        }
+    }
+
+    if (0 != untracked)
+    {
+        APP_INFO(("  %lu blocks not attributed. Increase MEM_USAGE_MAX_BLOCKS.\n", (unsigned long)untracked));
+    }
+
+    libc_heap = mallinfo();
+    APP_INFO(("C library heap: %lu bytes in use, %lu bytes reserved\n",
+              (unsigned long)libc_heap.uordblks, (unsigned long)libc_heap.arena));
+
+#if LWIP_STATS && MEM_STATS
+    APP_INFO(("lwIP heap: %lu bytes in use, peak %lu bytes, %lu failed\n",
+              (unsigned long)lwip_stats.mem.used, (unsigned long)lwip_stats.mem.max,
+              (unsigned long)lwip_stats.mem.err));
+#endif
+
+#if LWIP_STATS && MEMP_STATS
+    for (index = 0; index < MEMP_MAX; index++)
+    {
+        APP_INFO(("  %-16s %3lu/%3lu used, peak %3lu, %lu failed\n", lwip_stats.memp[index]->name,
+                  (unsigned long)lwip_stats.memp[index]->used, (unsigned long)lwip_stats.memp[index]->avail,
+                  (unsigned long)lwip_stats.memp[index]->max, (unsigned long)lwip_stats.memp[index]->err));
+    }
+#endif
+
+#if MEM_STATIC_POOLS
+    mem_pool_print();
+#endif
+}
+
+#endif /* MEM_USAGE_STATS */
+
+
+/* [] END OF FILE */
+
@@ -0,0 +1,74 @@
+/******************************************************************************
+* File Name: mem_usage.h
+*
+* Description: This file contains the interface of the heap and lwIP pool
+* usage tracking. It is included by FreeRTOSConfig.h, and must not include the
+* FreeRTOS headers.
+*
+******************************************************************************
+* Copyright (2020), Cypress Semiconductor Corporation.
+******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death (“High Risk Product”). By
+* including Cypress’s product in a High Risk Product, the manufacturer of such
+* system or application assumes all risk of such use and in doing so agrees to
+* indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef _MEM_USAGE_H_
+#define _MEM_USAGE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Subsystems to which the heap usage is attributed. */
+#define MEM_USAGE_TAG_NONE                   (0)   /* Not resolved yet. */
+#define MEM_USAGE_TAG_RTOS                   (1)   /* Kernel objects and task stacks. */
+#define MEM_USAGE_TAG_APP                    (2)
+#define MEM_USAGE_TAG_WHD                    (3)
+#define MEM_USAGE_TAG_LWIP                   (4)
+#define MEM_USAGE_TAG_TLS                    (5)
+#define MEM_USAGE_TAG_MQTT                   (6)
+#define MEM_USAGE_TAG_COUNT                  (7)
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+void mem_usage_on_malloc(void *address, size_t size);
+void mem_usage_on_free(void *address);
+uint8_t mem_usage_set_tag(uint8_t tag);
+void mem_usage_print(void);
+
+#endif /* _MEM_USAGE_H_ */
+
+
+/* [] END OF FILE */
+
@@ -0,0 +1,273 @@
+/*******************************************************************************
+ * File Name:   mqtt_batch.c
+ *
+ * Description: This file contains the MQTT publish batching. Each publish
+ * sent on its own costs a host wake, a resume of the network stack, and
+ * radio-on time for a few small TCP segments. The publishes are instead
+ * encoded into a fixed arena, each with the latest time at which it must be
+ * sent. The arena is flushed with a single send by the wake scheduler, in the
+ * shared host wake window in which the earliest deadline falls, so that the
+ * queued messages go out back to back and several small messages share a TCP
+ * segment. A publish without delay flushes the arena immediately, together
+ * with the messages queued before it.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+
+/* Include header files */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include <stdbool.h>
+
+#include "mqtt_client.h"
+#include "mqtt_batch.h"
+#include "wake_scheduler.h"
+#include "wifi_config.h"
+
+#if MQTT_CLIENT && MQTT_BATCH
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define MQTT_BATCH_TICKS_TO_MS(ticks)        ((uint32_t)(ticks) * portTICK_PERIOD_MS)
+
+/*******************************************************************************
+ * Static Global Structures and variables
+ ******************************************************************************/
+/* Runtime state of the publish batching. */
+typedef struct
+{
+    uint32_t used;                     /* Bytes of encoded packets in the arena. */
+    uint32_t count;                    /* Messages in the arena. */
+    TickType_t deadline;               /* Earliest deadline of the messages in the arena. */
+    SemaphoreHandle_t mutex;
+} mqtt_batch_t;
+
+static mqtt_batch_t mqtt_batch;
+static uint8_t mqtt_batch_arena[MQTT_BATCH_ARENA_SIZE];
+
+/*******************************************************************************
+ * Function definitions
+ ******************************************************************************/
+/*******************************************************************************
+* Function Name: mqtt_batch_flush_locked
+********************************************************************************
+* Summary:
+*  Sends all the messages in the arena with a single send, and empties the
+*  arena. Must be called with the batch mutex taken.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void mqtt_batch_flush_locked(void)
+{
+    if (0 == mqtt_batch.count)
+    {
+        return;
+    }
+
+    if (CY_RSLT_SUCCESS != mqtt_client_send(mqtt_batch_arena, mqtt_batch.used))
+    {
+        ERR_INFO(("Failed to send %lu queued MQTT messages.\n", (unsigned long)mqtt_batch.count));
+    }
+
+    mqtt_batch.used = 0;
+    mqtt_batch.count = 0;
+}
+
+/*******************************************************************************
+* Function Name: mqtt_batch_init
+********************************************************************************
+* Summary:
+*  Initializes the publish batching.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  cy_rslt_t: Returns CY_RSLT_SUCCESS if the batching is initialized.
+*  Otherwise, it returns CY_RSLT_TYPE_ERROR.
+*
+*******************************************************************************/
+cy_rslt_t mqtt_batch_init(void)
+{
+    mqtt_batch.used = 0;
+    mqtt_batch.count = 0;
+    mqtt_batch.mutex = xSemaphoreCreateMutex();
+
+    return (NULL != mqtt_batch.mutex) ? CY_RSLT_SUCCESS : CY_RSLT_TYPE_ERROR;
+}
+
+/*******************************************************************************
+* Function Name: mqtt_batch_publish
+********************************************************************************
+* Summary:
+*  Queues a message to be sent within the given delay. The message is encoded
+*  into the arena right away, so the caller's buffers can be reused on return.
+*  If the arena is full, the queued messages are sent first. A message larger
+*  than the arena is sent on its own after the queued messages. If the network
+*  stack is suspended beyond the new deadline, it is resumed in time for the
+*  flush.
+*
+* Parameters:
+*  topic        : Topic name.
+*  payload      : Message payload.
+*  length       : Length of the payload.
+*  qos          : MQTT_CLIENT_QOS0 or MQTT_CLIENT_QOS1.
+*  max_delay_ms : Latest time in milliseconds at which the message must be
+*                 sent. 0 sends it, and all the queued messages, immediately.
+*
+* Return:
+*  cy_rslt_t: Returns CY_RSLT_SUCCESS if the message has been queued or sent.
+*  Otherwise, it returns CY_RSLT_TYPE_ERROR.
+*
+*******************************************************************************/
+cy_rslt_t mqtt_batch_publish(const char *topic, const void *payload, uint32_t length,
+                             uint8_t qos, uint32_t max_delay_ms)
+{
+    TickType_t deadline = xTaskGetTickCount() + pdMS_TO_TICKS(max_delay_ms);
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    uint32_t encoded;
+    bool earlier = false;
+
+    if (!mqtt_client_is_connected())
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    (void)xSemaphoreTake(mqtt_batch.mutex, portMAX_DELAY);
+
+    encoded = mqtt_client_encode_publish(&mqtt_batch_arena[mqtt_batch.used], sizeof(mqtt_batch_arena) - mqtt_batch.used,
+                                         topic, payload, length, qos);
+    if ((0 == encoded) && (0 != mqtt_batch.count))
+    {
+        mqtt_batch_flush_locked();
+        encoded = mqtt_client_encode_publish(mqtt_batch_arena, sizeof(mqtt_batch_arena), topic, payload, length, qos);
+    }
+
+    if (0 != encoded)
+    {
+        if ((0 == mqtt_batch.count) || ((int32_t)(deadline - mqtt_batch.deadline) < 0))
+        {
+            mqtt_batch.deadline = deadline;
+            earlier = true;
+        }
+
+        mqtt_batch.used += encoded;
+        mqtt_batch.count++;
+
+        if (0 == max_delay_ms)
+        {
+            mqtt_batch_flush_locked();
+        }
+    }
+    else
+    {
+        result = mqtt_client_publish(topic, payload, length, qos);
+    }
+
+    (void)xSemaphoreGive(mqtt_batch.mutex);
+
+    /* The network stack may be suspended until a later deadline. */
+    if (earlier && (0 != max_delay_ms))
+    {
+        wake_sched_kick(max_delay_ms);
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+* Function Name: mqtt_batch_flush
+********************************************************************************
+* Summary:
+*  Sends all the queued messages. This is run by the wake scheduler in the
+*  host wake window in which the earliest deadline falls. It is registered
+*  before the MQTT ping, which the flush postpones.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void mqtt_batch_flush(void)
+{
+    (void)xSemaphoreTake(mqtt_batch.mutex, portMAX_DELAY);
+    mqtt_batch_flush_locked();
+    (void)xSemaphoreGive(mqtt_batch.mutex);
+}
+
+/*******************************************************************************
+* Function Name: mqtt_batch_get_next_flush_ms
+********************************************************************************
+* Summary:
+*  Returns the time until the earliest deadline of the queued messages. The
+*  network stack must not stay suspended longer than this.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  uint32_t: Time in milliseconds until the flush is due, or portMAX_DELAY if
+*  no message is queued.
+*
+*******************************************************************************/
+uint32_t mqtt_batch_get_next_flush_ms(void)
+{
+    int32_t remaining;
+    uint32_t next_ms = portMAX_DELAY;
+
+    (void)xSemaphoreTake(mqtt_batch.mutex, portMAX_DELAY);
+
+    if (0 != mqtt_batch.count)
+    {
+        remaining = (int32_t)(mqtt_batch.deadline - xTaskGetTickCount());
+        next_ms = (remaining <= 0) ? 0 : MQTT_BATCH_TICKS_TO_MS(remaining);
+    }
+
+    (void)xSemaphoreGive(mqtt_batch.mutex);
+
+    return next_ms;
+}
+
+#endif /* MQTT_CLIENT && MQTT_BATCH */
+
+
+/* [] END OF FILE */
+
@@ -0,0 +1,69 @@
+/******************************************************************************
+* File Name: mqtt_batch.h
+*
+* Description: This file contains the interface of the MQTT publish batching
+* which sends the queued publishes together in one host wake window.
+*
+******************************************************************************
+* Copyright (2020), Cypress Semiconductor Corporation.
+******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death (“High Risk Product”). By
+* including Cypress’s product in a High Risk Product, the manufacturer of such
+* system or application assumes all risk of such use and in doing so agrees to
+* indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef _MQTT_BATCH_H_
+#define _MQTT_BATCH_H_
+
+#include <stdint.h>
+#include "cy_result.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Time for which the network stack is kept resumed after a flush, for the
+ * PUBACKs of the QoS 1 messages.
+ */
+#define MQTT_BATCH_FLUSH_HOLD_MS             (500UL)
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+cy_rslt_t mqtt_batch_init(void);
+cy_rslt_t mqtt_batch_publish(const char *topic, const void *payload, uint32_t length,
+                             uint8_t qos, uint32_t max_delay_ms);
+void mqtt_batch_flush(void);
+uint32_t mqtt_batch_get_next_flush_ms(void);
+
+#endif /* _MQTT_BATCH_H_ */
+
+
+/* [] END OF FILE */
+
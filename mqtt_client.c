@@ -0,0 +1,1068 @@
+/*******************************************************************************
+ * File Name:   mqtt_client.c
+ *
+ * Description: This file contains a minimal MQTT 3.1.1 client which connects
+ * to the broker on one of the TCP Keepalive offload connections. The WLAN
+ * device keeps the idle TCP connection, and the NAT and firewall state on the
+ * way to the broker, alive without waking the host.
+ *
+ * The TCP Keepalive offload can only send empty TCP keepalive segments, so
+ * it cannot carry the PINGREQ of the MQTT keepalive. The keepalive of the
+ * broker is instead handled by a host policy:
+ *  - With MQTT_CLIENT_KEEP_ALIVE_SEC set to 0, the broker does not expect
+ *    any packet on an idle connection. The WLAN device alone keeps the
+ *    connection alive, and an idle connection costs no host wakes.
+ *  - Otherwise, PINGREQ is a wake scheduler duty. It is due once
+ *    MQTT_CLIENT_PING_PERCENT of the keepalive has passed since the last
+ *    packet sent to the broker, so that it is skipped while other packets
+ *    are sent, and is run in a shared host wake window.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+
+/* Include header files */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include <stdbool.h>
+#include <string.h>
+
+#include "mqtt_client.h"
+#include "wlan_offload.h"
+#include "wifi_config.h"
+
+#if MQTT_CLIENT
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define MQTT_PROTOCOL_LEVEL                  (4)
+#define MQTT_CONNECT_FLAG_CLEAN_SESSION      (0x02)
+#define MQTT_SUBACK_FAILURE                  (0x80)
+
+/* The remaining length is encoded in up to four bytes. */
+#define MQTT_REMAINING_LENGTH_MAX_BYTES      (4)
+
+#define MQTT_CLIENT_RX_BUFFER_SIZE           (512)
+#define MQTT_CLIENT_TX_BUFFER_SIZE           (512)
+
+/* Time to wait for the CONNACK of the broker. */
+#define MQTT_CLIENT_CONNACK_TIMEOUT_MS       (5000UL)
+
+/* Receive timeout of the socket. The lwIP secure sockets wait without a
+ * timeout when it is 0, so the receive task only runs when data arrives.
+ */
+#define MQTT_CLIENT_RX_TIMEOUT               (0)
+
+#define MQTT_CLIENT_TASK_STACK_SIZE          (configMINIMAL_STACK_SIZE * 4)
+#define MQTT_CLIENT_TASK_PRIORITY            (tskIDLE_PRIORITY + 1)
+
+#define MQTT_CLIENT_TICKS_TO_MS(ticks)       ((uint32_t)(ticks) * portTICK_PERIOD_MS)
+
+/*******************************************************************************
+ * Static Global Structures and variables
+ ******************************************************************************/
+/* Runtime state of the MQTT client. */
+typedef struct
+{
+    Socket_t socket;                   /* TCP Keepalive offload connection to the broker. */
+    bool connected;                    /* CONNACK accepted on the current socket. */
+    bool ping_outstanding;             /* PINGREQ sent, PINGRESP not yet received. */
+    TickType_t last_tx;                /* Tick at which the last packet was sent to the broker. */
+    uint16_t packet_id;                /* Last packet identifier used. */
+    mqtt_client_publish_handler_t handler;
+    SemaphoreHandle_t tx_mutex;
+    SemaphoreHandle_t connack;
+    TaskHandle_t rx_task;
+} mqtt_client_t;
+
+static mqtt_client_t mqtt_client;
+static uint8_t mqtt_client_rx_buffer[MQTT_CLIENT_RX_BUFFER_SIZE];
+static uint8_t mqtt_client_tx_buffer[MQTT_CLIENT_TX_BUFFER_SIZE];
+
+/* Topic filters subscribed on every connection. Their messages are forwarded
+ * to the host as soon as they arrive.
+ */
+static const char *const mqtt_client_topics[] = MQTT_URGENT_TOPICS;
+
+/*******************************************************************************
+ * Function definitions
+ ******************************************************************************/
+/*******************************************************************************
+* Function Name: mqtt_client_encode_length
+********************************************************************************
+* Summary:
+*  Encodes the remaining length of a fixed header.
+*
+* Parameters:
+*  buffer : Destination, with room for MQTT_REMAINING_LENGTH_MAX_BYTES bytes.
+*  length : Remaining length.
+*
+* Return:
+*  uint32_t: Number of bytes written.
+*
+*******************************************************************************/
+static uint32_t mqtt_client_encode_length(uint8_t *buffer, uint32_t length)
+{
+    uint32_t count = 0;
+
+    do
+    {
+        buffer[count] = (uint8_t)(length & 0x7F);
+        length >>= 7;
+        if (0 != length)
+        {
+            buffer[count] |= 0x80;
+        }
+        count++;
+    } while (0 != length);
+
+    return count;
+}
+
+/*******************************************************************************
+* Function Name: mqtt_client_next_packet_id
+********************************************************************************
+* Summary:
+*  Returns a new, non-zero packet identifier.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  uint16_t: Packet identifier.
+*
+*******************************************************************************/
+static uint16_t mqtt_client_next_packet_id(void)
+{
+    uint16_t packet_id;
+
+    taskENTER_CRITICAL();
+    mqtt_client.packet_id = (0xFFFF == mqtt_client.packet_id) ? 1 : (mqtt_client.packet_id + 1);
+    packet_id = mqtt_client.packet_id;
+    taskEXIT_CRITICAL();
+
+    return packet_id;
+}
+
+/*******************************************************************************
+* Function Name: mqtt_client_write
+********************************************************************************
+* Summary:
+*  Sends all the given bytes on the given socket.
+*
+* Parameters:
+*  socket : Connected socket.
+*  data   : Bytes to send.
+*  length : Number of bytes.
+*
+* Return:
+*  bool: true if all the bytes have been sent.
+*
+*******************************************************************************/
+bool mqtt_client_write(Socket_t socket, const uint8_t *data, uint32_t length)
+{
+    int32_t sent;
+
+    while (0 != length)
+    {
+        sent = SOCKETS_Send(socket, data, length, 0);
+        if (sent <= 0)
+        {
+            ERR_INFO(("Failed to send to the MQTT broker: %ld\n", (long)sent));
+            return false;
+        }
+
+        data += sent;
+        length -= (uint32_t)sent;
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: mqtt_client_send_locked
+********************************************************************************
+* Summary:
+*  Sends the given bytes to the broker. Must be called with the transmit mutex
+*  taken, so that the packets of different tasks are not interleaved.
+*
+*  A failed or partial send leaves the byte stream out of sync with the
+*  broker, so the socket is shut down, which also ends the read of the
+*  receive task, and the client is disconnected. If the client was connected,
+*  its TCP Keepalive connection is established again by the TCP reconnect duty,
+*  which also connects the client again.
+*
+* Parameters:
+*  data   : Bytes to send.
+*  length : Number of bytes.
+*
+* Return:
+*  bool: true if all the bytes have been sent.
+*
+*******************************************************************************/
+static bool mqtt_client_send_locked(const uint8_t *data, uint32_t length)
+{
+    bool connected = mqtt_client.connected;
+
+    if (NULL == mqtt_client.socket)
+    {
+        return false;
+    }
+
+    if (!mqtt_client_write(mqtt_client.socket, data, length))
+    {
+        mqtt_client.connected = false;
+        (void)SOCKETS_Shutdown(mqtt_client.socket, SOCKETS_SHUT_RDWR);
+        mqtt_client.socket = NULL;
+
+        if (connected)
+        {
+            APP_INFO(("MQTT connection to the broker lost. Reconnecting.\n"));
+            tcp_socket_connection_reconnect(TKO_MQTT_CONN_INDEX);
+        }
+        return false;
+    }
+
+    mqtt_client.last_tx = xTaskGetTickCount();
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: mqtt_client_encode_connect
+********************************************************************************
+* Summary:
+*  Encodes a CONNECT packet.
+*
+* Parameters:
+*  buffer         : Destination.
+*  size           : Size of the destination.
+*  client_id      : Client identifier.
+*  clean_session  : Discard the session state of the client ID on the broker.
+*                   Otherwise, the broker keeps the subscriptions and holds
+*                   the QoS 1 messages while the client is disconnected.
+*  keep_alive_sec : Keepalive in seconds, or 0 to disable it.
+*
+* Return:
+*  uint32_t: Length of the packet, or 0 if it does not fit.
+*
+*******************************************************************************/
+uint32_t mqtt_client_encode_connect(uint8_t *buffer, uint32_t size, const char *client_id,
+                                    bool clean_session, uint16_t keep_alive_sec)
+{
+    static const uint8_t protocol_name[] = { 0, 4, 'M', 'Q', 'T', 'T' };
+    uint16_t id_length = (uint16_t)strlen(client_id);
+    uint32_t remaining = sizeof(protocol_name) + 4 + 2 + id_length;
+    uint32_t index = 0;
+
+    if ((1 + MQTT_REMAINING_LENGTH_MAX_BYTES + remaining) > size)
+    {
+        return 0;
+    }
+
+    buffer[index++] = MQTT_PACKET_CONNECT;
+    index += mqtt_client_encode_length(&buffer[index], remaining);
+    memcpy(&buffer[index], protocol_name, sizeof(protocol_name));
+    index += sizeof(protocol_name);
+    buffer[index++] = MQTT_PROTOCOL_LEVEL;
+    buffer[index++] = clean_session ? MQTT_CONNECT_FLAG_CLEAN_SESSION : 0;
+    buffer[index++] = (uint8_t)(keep_alive_sec >> 8);
+    buffer[index++] = (uint8_t)(keep_alive_sec & 0xFF);
+    buffer[index++] = (uint8_t)(id_length >> 8);
+    buffer[index++] = (uint8_t)(id_length & 0xFF);
+    memcpy(&buffer[index], client_id, id_length);
+    index += id_length;
+
+    return index;
+}
+
+/*******************************************************************************
+* Function Name: mqtt_client_encode_subscribe
+********************************************************************************
+* Summary:
+*  Encodes a SUBSCRIBE packet for the given topic filters, each with QoS 1.
+*  NULL entries are skipped.
+*
+* Parameters:
+*  buffer : Destination.
+*  size   : Size of the destination.
+*  topics : Topic filters.
+*  count  : Number of entries in topics.
+*
+* Return:
+*  uint32_t: Length of the packet, or 0 if there is no topic filter or it
+*  does not fit.
+*
+*******************************************************************************/
+uint32_t mqtt_client_encode_subscribe(uint8_t *buffer, uint32_t size, const char *const *topics, uint32_t count)
+{
+    uint32_t remaining = 2;
+    uint32_t index = 0;
+    uint16_t packet_id;
+    uint16_t topic_length;
+    uint32_t topic;
+
+    for (topic = 0; topic < count; topic++)
+    {
+        if (NULL != topics[topic])
+        {
+            remaining += 2 + strlen(topics[topic]) + 1;
+        }
+    }
+
+    if ((2 == remaining) || ((1 + MQTT_REMAINING_LENGTH_MAX_BYTES + remaining) > size))
+    {
+        return 0;
+    }
+
+    packet_id = mqtt_client_next_packet_id();
+
+    /* The SUBSCRIBE fixed header has the reserved flags set to 0b0010. */
+    buffer[index++] = MQTT_PACKET_SUBSCRIBE | 0x02;
+    index += mqtt_client_encode_length(&buffer[index], remaining);
+    buffer[index++] = (uint8_t)(packet_id >> 8);
+    buffer[index++] = (uint8_t)(packet_id & 0xFF);
+
+    for (topic = 0; topic < count; topic++)
+    {
+        if (NULL != topics[topic])
+        {
+            topic_length = (uint16_t)strlen(topics[topic]);
+            buffer[index++] = (uint8_t)(topic_length >> 8);
+            buffer[index++] = (uint8_t)(topic_length & 0xFF);
+            memcpy(&buffer[index], topics[topic], topic_length);
+            index += topic_length;
+            buffer[index++] = MQTT_CLIENT_QOS1;
+        }
+    }
+
+    return index;
+}
+
+/*******************************************************************************
+* Function Name: mqtt_client_recv
+********************************************************************************
+* Summary:
+*  Receives exactly the given number of bytes from the broker. The socket of
+*  the client has no receive timeout, and is shut down to end the receive.
+*
+* Parameters:
+*  socket : Socket to receive from.
+*  buffer : Destination, or NULL to discard the bytes.
+*  length : Number of bytes.
+*
+* Return:
+*  bool: true if all the bytes have been received, false if the connection
+*  failed, was closed, or the receive timed out.
+*
+*******************************************************************************/
+static bool mqtt_client_recv(Socket_t socket, uint8_t *buffer, uint32_t length)
+{
+    uint8_t discard[32];
+    int32_t received;
+
+    while (0 != length)
+    {
+        if (NULL == buffer)
+        {
+            received = SOCKETS_Recv(socket, discard, (length < sizeof(discard)) ? length : sizeof(discard), 0);
+        }
+        else
+        {
+            received = SOCKETS_Recv(socket, buffer, length, 0);
+        }
+
+        if (received <= 0)
+        {
+            return false;
+        }
+
+        if (NULL != buffer)
+        {
+            buffer += received;
+        }
+        length -= (uint32_t)received;
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: mqtt_client_read
+********************************************************************************
+* Summary:
+*  Reads the next control packet into the given buffer. A packet which is
+*  larger than the buffer is discarded and returned as type 0.
+*
+* Parameters:
+*  socket : Socket to receive from.
+*  buffer : Destination of the variable header and payload.
+*  size   : Size of the destination.
+*  type   : Receives the first byte of the fixed header.
+*  length : Receives the remaining length in the buffer.
+*
+* Return:
+*  bool: true if a packet has been read.
+*
+*******************************************************************************/
+static bool mqtt_client_read(Socket_t socket, uint8_t *buffer, uint32_t size, uint8_t *type, uint32_t *length)
+{
+    uint8_t byte;
+    uint32_t remaining = 0;
+    uint32_t count;
+
+    if (!mqtt_client_recv(socket, type, 1))
+    {
+        return false;
+    }
+
+    for (count = 0; count < MQTT_REMAINING_LENGTH_MAX_BYTES; count++)
+    {
+        if (!mqtt_client_recv(socket, &byte, 1))
+        {
+            return false;
+        }
+
+        remaining |= (uint32_t)(byte & 0x7F) << (7 * count);
+        if (0 == (byte & 0x80))
+        {
+            break;
+        }
+    }
+
+    if (MQTT_REMAINING_LENGTH_MAX_BYTES == count)
+    {
+        ERR_INFO(("Malformed MQTT packet from the broker.\n"));
+        return false;
+    }
+
+    if (remaining > size)
+    {
+        ERR_INFO(("Discarded an MQTT packet of %lu bytes from the broker.\n", (unsigned long)remaining));
+        *type = 0;
+        *length = 0;
+        return mqtt_client_recv(socket, NULL, remaining);
+    }
+
+    *length = remaining;
+
+    return mqtt_client_recv(socket, buffer, remaining);
+}
+
+/*******************************************************************************
+* Function Name: mqtt_client_read_packet
+********************************************************************************
+* Summary:
+*  Reads the next control packet from a socket other than the one of the
+*  client, such as a short-lived session. The receive timeout of the socket
+*  ends the read.
+*
+* Parameters:
+*  socket : Socket to receive from.
+*  buffer : Destination of the variable header and payload.
+*  size   : Size of the destination.
+*  type   : Receives the first byte of the fixed header.
+*  length : Receives the remaining length in the buffer.
+*
+* Return:
+*  bool: true if a packet has been read, false if the connection failed or
+*  the receive timed out.
+*
+*******************************************************************************/
+bool mqtt_client_read_packet(Socket_t socket, uint8_t *buffer, uint32_t size, uint8_t *type, uint32_t *length)
+{
+    return mqtt_client_read(socket, buffer, size, type, length);
+}
+
+/*******************************************************************************
+* Function Name: mqtt_client_parse_publish
+********************************************************************************
+* Summary:
+*  Parses a received PUBLISH.
+*
+* Parameters:
+*  type    : First byte of the fixed header.
+*  packet  : Variable header and payload.
+*  length  : Remaining length.
+*  message : Receives the message, which points into the packet.
+*
+* Return:
+*  bool: true if the packet is a well-formed PUBLISH.
+*
+*******************************************************************************/
+bool mqtt_client_parse_publish(uint8_t type, const uint8_t *packet, uint32_t length, mqtt_client_message_t *message)
+{
+    uint32_t offset;
+
+    if ((MQTT_PACKET_PUBLISH != (type & MQTT_PACKET_TYPE_MASK)) || (length < 2))
+    {
+        return false;
+    }
+
+    message->qos = (type >> 1) & 0x03;
+    message->topic_length = (uint16_t)((packet[0] << 8) | packet[1]);
+    message->topic = (const char *)&packet[2];
+    message->packet_id = 0;
+    offset = 2 + message->topic_length;
+
+    if (MQTT_CLIENT_QOS0 != message->qos)
+    {
+        if ((offset + 2) > length)
+        {
+            return false;
+        }
+
+        message->packet_id = (uint16_t)((packet[offset] << 8) | packet[offset + 1]);
+        offset += 2;
+    }
+
+    if (offset > length)
+    {
+        return false;
+    }
+
+    message->payload = &packet[offset];
+    message->payload_length = length - offset;
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: mqtt_client_deliver
+********************************************************************************
+* Summary:
+*  Passes a received message to the publish handler of the application.
+*
+* Parameters:
+*  message : Received message.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void mqtt_client_deliver(const mqtt_client_message_t *message)
+{
+    if (NULL != mqtt_client.handler)
+    {
+        mqtt_client.handler(message->topic, message->topic_length, message->payload, message->payload_length);
+    }
+    else
+    {
+        APP_INFO(("MQTT message on %.*s, %lu bytes\n", (int)message->topic_length, message->topic,
+                  (unsigned long)message->payload_length));
+    }
+}
+
+/*******************************************************************************
+* Function Name: mqtt_client_handle_publish
+********************************************************************************
+* Summary:
+*  Passes a received PUBLISH to the handler, and acknowledges it if it has
+*  been sent with QoS 1.
+*
+* Parameters:
+*  type   : First byte of the fixed header.
+*  packet : Variable header and payload.
+*  length : Remaining length.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void mqtt_client_handle_publish(uint8_t type, const uint8_t *packet, uint32_t length)
+{
+    mqtt_client_message_t message;
+    uint8_t puback[4] = { MQTT_PACKET_PUBACK, 2, 0, 0 };
+
+    if (!mqtt_client_parse_publish(type, packet, length, &message))
+    {
+        ERR_INFO(("Malformed MQTT PUBLISH from the broker.\n"));
+        return;
+    }
+
+    mqtt_client_deliver(&message);
+
+    if (MQTT_CLIENT_QOS1 == message.qos)
+    {
+        puback[2] = (uint8_t)(message.packet_id >> 8);
+        puback[3] = (uint8_t)(message.packet_id & 0xFF);
+
+        (void)xSemaphoreTake(mqtt_client.tx_mutex, portMAX_DELAY);
+        (void)mqtt_client_send_locked(puback, sizeof(puback));
+        (void)xSemaphoreGive(mqtt_client.tx_mutex);
+    }
+}
+
+/*******************************************************************************
+* Function Name: mqtt_client_rx_task
+********************************************************************************
+* Summary:
+*  Reads and handles the packets from the broker. The task waits for a socket
+*  to be attached, reads from it until the connection fails, and then waits
+*  for the next socket. The socket has no receive timeout, so a task blocked
+*  on it does not wake the host until data arrives or the socket is shut down.
+*
+* Parameters:
+*  arg: Unused.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void mqtt_client_rx_task(void *arg)
+{
+    Socket_t socket;
+    uint8_t type;
+    uint32_t length;
+
+    (void)arg;
+
+    while (true)
+    {
+        (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        socket = mqtt_client.socket;
+
+        while ((NULL != socket) &&
+               mqtt_client_read(socket, mqtt_client_rx_buffer, sizeof(mqtt_client_rx_buffer), &type, &length))
+        {
+            switch (type & MQTT_PACKET_TYPE_MASK)
+            {
+                case MQTT_PACKET_CONNACK:
+                    if (length >= 2)
+                    {
+                        mqtt_client.connected = (0 == mqtt_client_rx_buffer[1]);
+                        if (!mqtt_client.connected)
+                        {
+                            ERR_INFO(("MQTT broker refused the connection: %d\n", mqtt_client_rx_buffer[1]));
+                        }
+                        (void)xSemaphoreGive(mqtt_client.connack);
+                    }
+                    break;
+
+                case MQTT_PACKET_PINGRESP:
+                    mqtt_client.ping_outstanding = false;
+                    break;
+
+                case MQTT_PACKET_PUBLISH:
+                    mqtt_client_handle_publish(type, mqtt_client_rx_buffer, length);
+                    break;
+
+                case MQTT_PACKET_SUBACK:
+                    if ((length < 3) || (NULL != memchr(&mqtt_client_rx_buffer[2], MQTT_SUBACK_FAILURE, length - 2)))
+                    {
+                        ERR_INFO(("MQTT broker refused a subscription.\n"));
+                    }
+                    break;
+
+                default:
+                    break;
+            }
+        }
+
+        if (socket == mqtt_client.socket)
+        {
+            mqtt_client.connected = false;
+            APP_INFO(("MQTT connection to the broker closed.\n"));
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: mqtt_client_init
+********************************************************************************
+* Summary:
+*  Initializes the MQTT client and starts its receive task. The client
+*  connects to the broker when the TCP Keepalive offload connection is
+*  attached with mqtt_client_attach().
+*
+* Parameters:
+*  handler : Called for each received PUBLISH, or NULL to only log them.
+*
+* Return:
+*  cy_rslt_t: Returns CY_RSLT_SUCCESS if the client is initialized. Otherwise,
+*  it returns CY_RSLT_TYPE_ERROR.
+*
+*******************************************************************************/
+cy_rslt_t mqtt_client_init(mqtt_client_publish_handler_t handler)
+{
+    mqtt_client.handler = handler;
+    mqtt_client.tx_mutex = xSemaphoreCreateMutex();
+    mqtt_client.connack = xSemaphoreCreateBinary();
+
+    if ((NULL == mqtt_client.tx_mutex) || (NULL == mqtt_client.connack) ||
+        (pdPASS != xTaskCreate(mqtt_client_rx_task, "MqttRx", MQTT_CLIENT_TASK_STACK_SIZE, NULL,
+                               MQTT_CLIENT_TASK_PRIORITY, &mqtt_client.rx_task)))
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: mqtt_client_attach
+********************************************************************************
+* Summary:
+*  Connects to the broker on the given TCP connection, and waits for the
+*  CONNACK. This is called whenever the TCP Keepalive offload connections are
+*  established, including after an IP address change.
+*
+* Parameters:
+*  socket : Connected socket of the TCP Keepalive offload connection to the
+*           broker.
+*
+* Return:
+*  cy_rslt_t: Returns CY_RSLT_SUCCESS if the broker accepted the connection.
+*  Otherwise, it returns CY_RSLT_TYPE_ERROR.
+*
+*******************************************************************************/
+cy_rslt_t mqtt_client_attach(Socket_t socket)
+{
+    TickType_t timeout = MQTT_CLIENT_RX_TIMEOUT;
+    uint32_t length;
+    bool sent = false;
+
+    if (NULL == mqtt_client.tx_mutex)
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    if (SOCKETS_ERROR_NONE != SOCKETS_SetSockOpt(socket, 0, SOCKETS_SO_RCVTIMEO, &timeout, sizeof(timeout)))
+    {
+        ERR_INFO(("Failed to set the receive timeout of the MQTT socket.\n"));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    (void)xSemaphoreTake(mqtt_client.tx_mutex, portMAX_DELAY);
+
+    mqtt_client.socket = socket;
+    mqtt_client.connected = false;
+    mqtt_client.ping_outstanding = false;
+    (void)xSemaphoreTake(mqtt_client.connack, 0);
+    xTaskNotifyGive(mqtt_client.rx_task);
+
+    length = mqtt_client_encode_connect(mqtt_client_tx_buffer, sizeof(mqtt_client_tx_buffer), MQTT_CLIENT_ID,
+                                        true, MQTT_CLIENT_KEEP_ALIVE_SEC);
+    if (0 != length)
+    {
+        sent = mqtt_client_send_locked(mqtt_client_tx_buffer, length);
+    }
+
+    (void)xSemaphoreGive(mqtt_client.tx_mutex);
+
+    if (!sent || (pdTRUE != xSemaphoreTake(mqtt_client.connack, pdMS_TO_TICKS(MQTT_CLIENT_CONNACK_TIMEOUT_MS))) ||
+        !mqtt_client.connected)
+    {
+        ERR_INFO(("Failed to connect to the MQTT broker.\n"));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    APP_INFO(("Connected to the MQTT broker as %s, keepalive %u seconds.\n", MQTT_CLIENT_ID,
+              (unsigned int)MQTT_CLIENT_KEEP_ALIVE_SEC));
+
+    /* The session is clean, so the urgent topics are subscribed on every
+     * connection.
+     */
+    (void)xSemaphoreTake(mqtt_client.tx_mutex, portMAX_DELAY);
+    length = mqtt_client_encode_subscribe(mqtt_client_tx_buffer, sizeof(mqtt_client_tx_buffer), mqtt_client_topics,
+                                          sizeof(mqtt_client_topics) / sizeof(mqtt_client_topics[0]));
+    if ((0 != length) && !mqtt_client_send_locked(mqtt_client_tx_buffer, length))
+    {
+        ERR_INFO(("Failed to subscribe to the urgent MQTT topics.\n"));
+    }
+    (void)xSemaphoreGive(mqtt_client.tx_mutex);
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: mqtt_client_is_connected
+********************************************************************************
+* Summary:
+*  Returns whether the client is connected to the broker.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  bool: true if the broker has accepted the connection on the current socket.
+*
+*******************************************************************************/
+bool mqtt_client_is_connected(void)
+{
+    return mqtt_client.connected;
+}
+
+/*******************************************************************************
+* Function Name: mqtt_client_encode_publish_header
+********************************************************************************
+* Summary:
+*  Encodes the fixed header, the topic, and the packet identifier of a
+*  PUBLISH. A QoS 1 message takes a new packet identifier.
+*
+* Parameters:
+*  buffer       : Destination.
+*  size         : Size of the destination.
+*  topic        : Topic name.
+*  topic_length : Length of the topic name.
+*  length       : Length of the payload which follows the header.
+*  qos          : MQTT_CLIENT_QOS0 or MQTT_CLIENT_QOS1.
+*
+* Return:
+*  uint32_t: Length of the header, or 0 if it does not fit.
+*
+*******************************************************************************/
+static uint32_t mqtt_client_encode_publish_header(uint8_t *buffer, uint32_t size, const char *topic,
+                                                  uint16_t topic_length, uint32_t length, uint8_t qos)
+{
+    uint32_t remaining = 2 + topic_length + ((MQTT_CLIENT_QOS0 != qos) ? 2 : 0) + length;
+    uint16_t packet_id;
+    uint32_t index = 0;
+
+    if ((qos > MQTT_CLIENT_QOS1) || ((uint32_t)(1 + MQTT_REMAINING_LENGTH_MAX_BYTES + 2 + topic_length + 2) > size))
+    {
+        return 0;
+    }
+
+    buffer[index++] = (uint8_t)(MQTT_PACKET_PUBLISH | (qos << 1));
+    index += mqtt_client_encode_length(&buffer[index], remaining);
+    buffer[index++] = (uint8_t)(topic_length >> 8);
+    buffer[index++] = (uint8_t)(topic_length & 0xFF);
+    memcpy(&buffer[index], topic, topic_length);
+    index += topic_length;
+
+    if (MQTT_CLIENT_QOS0 != qos)
+    {
+        packet_id = mqtt_client_next_packet_id();
+        buffer[index++] = (uint8_t)(packet_id >> 8);
+        buffer[index++] = (uint8_t)(packet_id & 0xFF);
+    }
+
+    return index;
+}
+
+/*******************************************************************************
+* Function Name: mqtt_client_encode_publish
+********************************************************************************
+* Summary:
+*  Encodes a complete PUBLISH packet into the given buffer, to be sent later
+*  with mqtt_client_send(). Used to pack several messages into one send.
+*
+* Parameters:
+*  buffer  : Destination.
+*  size    : Size of the destination.
+*  topic   : Topic name.
+*  payload : Message payload.
+*  length  : Length of the payload.
+*  qos     : MQTT_CLIENT_QOS0 or MQTT_CLIENT_QOS1.
+*
+* Return:
+*  uint32_t: Length of the packet, or 0 if it does not fit.
+*
+*******************************************************************************/
+uint32_t mqtt_client_encode_publish(uint8_t *buffer, uint32_t size, const char *topic,
+                                    const void *payload, uint32_t length, uint8_t qos)
+{
+    uint16_t topic_length = (uint16_t)strlen(topic);
+    uint32_t header_max = 1 + MQTT_REMAINING_LENGTH_MAX_BYTES + 2 + topic_length + 2;
+    uint32_t index;
+
+    if ((size < header_max) || ((size - header_max) < length))
+    {
+        return 0;
+    }
+
+    index = mqtt_client_encode_publish_header(buffer, size, topic, topic_length, length, qos);
+    if (0 != index)
+    {
+        memcpy(&buffer[index], payload, length);
+        index += length;
+    }
+
+    return index;
+}
+
+/*******************************************************************************
+* Function Name: mqtt_client_send
+********************************************************************************
+* Summary:
+*  Sends packets encoded with mqtt_client_encode_publish() to the broker.
+*
+* Parameters:
+*  data   : Encoded packets.
+*  length : Total length of the packets.
+*
+* Return:
+*  cy_rslt_t: Returns CY_RSLT_SUCCESS if the packets have been sent. Otherwise,
+*  it returns CY_RSLT_TYPE_ERROR.
+*
+*******************************************************************************/
+cy_rslt_t mqtt_client_send(const uint8_t *data, uint32_t length)
+{
+    bool sent;
+
+    if (!mqtt_client.connected)
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    (void)xSemaphoreTake(mqtt_client.tx_mutex, portMAX_DELAY);
+    sent = mqtt_client_send_locked(data, length);
+    (void)xSemaphoreGive(mqtt_client.tx_mutex);
+
+    return sent ? CY_RSLT_SUCCESS : CY_RSLT_TYPE_ERROR;
+}
+
+/*******************************************************************************
+* Function Name: mqtt_client_publish
+********************************************************************************
+* Summary:
+*  Publishes a message. A QoS 1 message is sent with a new packet identifier.
+*  Its PUBACK is not awaited, as the client does not keep the session across
+*  connections. A message which fits in the transmit buffer is sent with a
+*  single send.
+*
+* Parameters:
+*  topic   : Topic name.
+*  payload : Message payload.
+*  length  : Length of the payload.
+*  qos     : MQTT_CLIENT_QOS0 or MQTT_CLIENT_QOS1.
+*
+* Return:
+*  cy_rslt_t: Returns CY_RSLT_SUCCESS if the message has been sent. Otherwise,
+*  it returns CY_RSLT_TYPE_ERROR.
+*
+*******************************************************************************/
+cy_rslt_t mqtt_client_publish(const char *topic, const void *payload, uint32_t length, uint8_t qos)
+{
+    uint32_t index;
+    bool sent = false;
+
+    if (!mqtt_client.connected)
+    {
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    (void)xSemaphoreTake(mqtt_client.tx_mutex, portMAX_DELAY);
+
+    index = mqtt_client_encode_publish_header(mqtt_client_tx_buffer, sizeof(mqtt_client_tx_buffer), topic,
+                                              (uint16_t)strlen(topic), length, qos);
+    if ((0 != index) && ((index + length) <= sizeof(mqtt_client_tx_buffer)))
+    {
+        memcpy(&mqtt_client_tx_buffer[index], payload, length);
+        sent = mqtt_client_send_locked(mqtt_client_tx_buffer, index + length);
+    }
+    else if (0 != index)
+    {
+        sent = mqtt_client_send_locked(mqtt_client_tx_buffer, index) &&
+               mqtt_client_send_locked((const uint8_t *)payload, length);
+    }
+
+    (void)xSemaphoreGive(mqtt_client.tx_mutex);
+
+    return sent ? CY_RSLT_SUCCESS : CY_RSLT_TYPE_ERROR;
+}
+
+/*******************************************************************************
+* Function Name: mqtt_client_get_next_ping_ms
+********************************************************************************
+* Summary:
+*  Returns the time until the PINGREQ is due. It is due once
+*  MQTT_CLIENT_PING_PERCENT of the keepalive has passed since the last packet
+*  sent to the broker, so any other packet postpones it.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  uint32_t: Time in milliseconds until the PINGREQ is due, or portMAX_DELAY
+*  if the client is not connected or the keepalive is disabled.
+*
+*******************************************************************************/
+uint32_t mqtt_client_get_next_ping_ms(void)
+{
+    TickType_t ping_ticks;
+    TickType_t elapsed;
+
+    if (!mqtt_client.connected || (0 == MQTT_CLIENT_KEEP_ALIVE_SEC))
+    {
+        return portMAX_DELAY;
+    }
+
+    ping_ticks = pdMS_TO_TICKS(MQTT_CLIENT_KEEP_ALIVE_SEC * 10UL * MQTT_CLIENT_PING_PERCENT);
+    elapsed = xTaskGetTickCount() - mqtt_client.last_tx;
+
+    return (elapsed >= ping_ticks) ? 0 : MQTT_CLIENT_TICKS_TO_MS(ping_ticks - elapsed);
+}
+
+/*******************************************************************************
+* Function Name: mqtt_client_send_ping
+********************************************************************************
+* Summary:
+*  Sends a PINGREQ to the broker. This is run by the wake scheduler in a host
+*  wake window, which is held open for the PINGRESP.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void mqtt_client_send_ping(void)
+{
+    static const uint8_t pingreq[] = { MQTT_PACKET_PINGREQ, 0 };
+
+    if (!mqtt_client.connected)
+    {
+        return;
+    }
+
+    if (mqtt_client.ping_outstanding)
+    {
+        ERR_INFO(("No PINGRESP from the MQTT broker to the previous PINGREQ.\n"));
+    }
+
+    (void)xSemaphoreTake(mqtt_client.tx_mutex, portMAX_DELAY);
+    if (mqtt_client_send_locked(pingreq, sizeof(pingreq)))
+    {
+        mqtt_client.ping_outstanding = true;
+    }
+    (void)xSemaphoreGive(mqtt_client.tx_mutex);
+}
+
+#endif /* MQTT_CLIENT */
+
+
+/* [] END OF FILE */
+
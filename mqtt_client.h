@@ -0,0 +1,119 @@
+/******************************************************************************
+* File Name: mqtt_client.h
+*
+* Description: This file contains the interface of the MQTT client which
+* connects to the broker on a TCP Keepalive offload connection.
+*
+******************************************************************************
+* Copyright (2020), Cypress Semiconductor Corporation.
+******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death (“High Risk Product”). By
+* including Cypress’s product in a High Risk Product, the manufacturer of such
+* system or application assumes all risk of such use and in doing so agrees to
+* indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef _MQTT_CLIENT_H_
+#define _MQTT_CLIENT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_result.h"
+#include "iot_secure_sockets.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* MQTT control packet types, in the upper nibble of the fixed header. */
+#define MQTT_PACKET_CONNECT                  (0x10)
+#define MQTT_PACKET_CONNACK                  (0x20)
+#define MQTT_PACKET_PUBLISH                  (0x30)
+#define MQTT_PACKET_PUBACK                   (0x40)
+#define MQTT_PACKET_SUBSCRIBE                (0x80)
+#define MQTT_PACKET_SUBACK                   (0x90)
+#define MQTT_PACKET_PINGREQ                  (0xC0)
+#define MQTT_PACKET_PINGRESP                 (0xD0)
+#define MQTT_PACKET_DISCONNECT               (0xE0)
+#define MQTT_PACKET_TYPE_MASK                (0xF0)
+
+/* Session present flag of the CONNACK. */
+#define MQTT_CONNACK_FLAG_SESSION_PRESENT    (0x01)
+
+/* Time for which the network stack is kept resumed for the PINGRESP. */
+#define MQTT_CLIENT_PINGRESP_HOLD_MS         (1000UL)
+
+/* Quality of service levels supported by the client. */
+#define MQTT_CLIENT_QOS0                     (0)
+#define MQTT_CLIENT_QOS1                     (1)
+
+/*******************************************************************************
+ * Type Definitions
+ ******************************************************************************/
+/* PUBLISH received from the broker. The topic is not NUL terminated. */
+typedef struct
+{
+    const char *topic;
+    uint16_t topic_length;
+    const uint8_t *payload;
+    uint32_t payload_length;
+    uint8_t qos;
+    uint16_t packet_id;                /* Valid for QoS 1 only. */
+} mqtt_client_message_t;
+
+/* Called from the MQTT receive task for each PUBLISH received from the broker.
+ * The topic is not NUL terminated. Both buffers are valid only during the call.
+ */
+typedef void (*mqtt_client_publish_handler_t)(const char *topic, uint16_t topic_length,
+                                              const uint8_t *payload, uint32_t payload_length);
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+cy_rslt_t mqtt_client_init(mqtt_client_publish_handler_t handler);
+cy_rslt_t mqtt_client_attach(Socket_t socket);
+bool mqtt_client_is_connected(void);
+cy_rslt_t mqtt_client_publish(const char *topic, const void *payload, uint32_t length, uint8_t qos);
+uint32_t mqtt_client_encode_publish(uint8_t *buffer, uint32_t size, const char *topic,
+                                    const void *payload, uint32_t length, uint8_t qos);
+cy_rslt_t mqtt_client_send(const uint8_t *data, uint32_t length);
+uint32_t mqtt_client_encode_connect(uint8_t *buffer, uint32_t size, const char *client_id,
+                                    bool clean_session, uint16_t keep_alive_sec);
+uint32_t mqtt_client_encode_subscribe(uint8_t *buffer, uint32_t size, const char *const *topics, uint32_t count);
+bool mqtt_client_write(Socket_t socket, const uint8_t *data, uint32_t length);
+bool mqtt_client_read_packet(Socket_t socket, uint8_t *buffer, uint32_t size, uint8_t *type, uint32_t *length);
+bool mqtt_client_parse_publish(uint8_t type, const uint8_t *packet, uint32_t length, mqtt_client_message_t *message);
+void mqtt_client_deliver(const mqtt_client_message_t *message);
+uint32_t mqtt_client_get_next_ping_ms(void);
+void mqtt_client_send_ping(void);
+
+#endif /* _MQTT_CLIENT_H_ */
+
+
+/* [] END OF FILE */
+
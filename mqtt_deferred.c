@@ -0,0 +1,213 @@
+/*******************************************************************************
+ * File Name:   mqtt_deferred.c
+ *
+ * Description: This file contains the deferred MQTT session. The WLAN packet
+ * filters match the port numbers, the IP protocol, and the EtherType, but not
+ * the MQTT topic, so every message on the TCP Keepalive offload connection to
+ * the broker wakes the host. Only the urgent topics are therefore subscribed
+ * on that connection.
+ *
+ * The low-priority topics are subscribed with QoS 1 by a second, persistent
+ * session (clean session 0). It is connected only in a host wake window, every
+ * MQTT_DEFERRED_POLL_INTERVAL_SEC seconds, and closed again once the broker has
+ * delivered the held messages. While the session is disconnected, the broker
+ * holds the messages for it, and no packet of the session reaches the WLAN
+ * device. A message which is not acknowledged because a poll is cut short is
+ * delivered again on the next poll.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+
+/* Include header files */
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdbool.h>
+
+#include "iot_secure_sockets.h"
+
+#include "mqtt_client.h"
+#include "mqtt_deferred.h"
+#include "wlan_offload.h"
+#include "wifi_config.h"
+
+#if MQTT_CLIENT && MQTT_DEFERRED_SESSION
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* The poll ends once the broker has sent nothing for this time. */
+#define MQTT_DEFERRED_IDLE_MS                (1000UL)
+
+#define MQTT_DEFERRED_BUFFER_SIZE            (512)
+
+/*******************************************************************************
+ * Static Global Structures and variables
+ ******************************************************************************/
+/* Topic filters of the persistent session. */
+static const char *const mqtt_deferred_topics[] = MQTT_DEFERRED_TOPICS;
+
+static uint8_t mqtt_deferred_buffer[MQTT_DEFERRED_BUFFER_SIZE];
+
+/*******************************************************************************
+ * Function definitions
+ ******************************************************************************/
+/*******************************************************************************
+* Function Name: mqtt_deferred_connect
+********************************************************************************
+* Summary:
+*  Opens the TCP connection of the persistent session to the broker.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  Socket_t: Connected socket, or SOCKETS_INVALID_SOCKET on failure.
+*
+*******************************************************************************/
+static Socket_t mqtt_deferred_connect(void)
+{
+    Socket_t socket;
+    SocketsSockaddr_t address = { 0 };
+    TickType_t timeout = pdMS_TO_TICKS(MQTT_DEFERRED_IDLE_MS);
+
+    socket = SOCKETS_Socket(SOCKETS_AF_INET, SOCKETS_SOCK_STREAM, SOCKETS_IPPROTO_TCP);
+    if (SOCKETS_INVALID_SOCKET == socket)
+    {
+        return SOCKETS_INVALID_SOCKET;
+    }
+
+    address.ucLength = sizeof(address);
+    address.ucSocketDomain = SOCKETS_AF_INET;
+    address.usPort = SOCKETS_htons(MQTT_BROKER_PORT_NUMBER);
+    address.ulAddress = SOCKETS_GetHostByName(MQTT_BROKER_IP_ADDRESS);
+
+    if ((SOCKETS_ERROR_NONE != SOCKETS_SetSockOpt(socket, 0, SOCKETS_SO_RCVTIMEO, &timeout, sizeof(timeout))) ||
+        (SOCKETS_ERROR_NONE != SOCKETS_Connect(socket, &address, sizeof(address))))
+    {
+        (void)SOCKETS_Close(socket);
+        return SOCKETS_INVALID_SOCKET;
+    }
+
+    return socket;
+}
+
+/*******************************************************************************
+* Function Name: mqtt_deferred_poll
+********************************************************************************
+* Summary:
+*  Connects the persistent session, receives the messages which the broker
+*  has held for it, and disconnects. The topics are subscribed only when the
+*  broker has no session for the client ID, such as on the first poll, since
+*  subscribing again would also resend the retained messages. This is run by
+*  the wake scheduler in a shared host wake window.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void mqtt_deferred_poll(void)
+{
+    static const uint8_t disconnect[] = { MQTT_PACKET_DISCONNECT, 0 };
+    uint8_t puback[4] = { MQTT_PACKET_PUBACK, 2, 0, 0 };
+    mqtt_client_message_t message;
+    Socket_t socket;
+    uint32_t delivered = 0;
+    uint32_t length;
+    uint8_t type;
+
+    socket = mqtt_deferred_connect();
+    if (SOCKETS_INVALID_SOCKET == socket)
+    {
+        ERR_INFO(("Failed to connect the deferred MQTT session.\n"));
+        return;
+    }
+
+    length = mqtt_client_encode_connect(mqtt_deferred_buffer, sizeof(mqtt_deferred_buffer),
+                                        MQTT_DEFERRED_CLIENT_ID, false, 0);
+    if ((0 == length) || !mqtt_client_write(socket, mqtt_deferred_buffer, length) ||
+        !mqtt_client_read_packet(socket, mqtt_deferred_buffer, sizeof(mqtt_deferred_buffer), &type, &length) ||
+        (MQTT_PACKET_CONNACK != (type & MQTT_PACKET_TYPE_MASK)) || (length < 2) || (0 != mqtt_deferred_buffer[1]))
+    {
+        ERR_INFO(("The MQTT broker did not accept the deferred session.\n"));
+        (void)SOCKETS_Close(socket);
+        return;
+    }
+
+    if (0 == (mqtt_deferred_buffer[0] & MQTT_CONNACK_FLAG_SESSION_PRESENT))
+    {
+        length = mqtt_client_encode_subscribe(mqtt_deferred_buffer, sizeof(mqtt_deferred_buffer), mqtt_deferred_topics,
+                                              sizeof(mqtt_deferred_topics) / sizeof(mqtt_deferred_topics[0]));
+        if ((0 != length) && !mqtt_client_write(socket, mqtt_deferred_buffer, length))
+        {
+            ERR_INFO(("Failed to subscribe to the deferred MQTT topics.\n"));
+        }
+    }
+
+    while (mqtt_client_read_packet(socket, mqtt_deferred_buffer, sizeof(mqtt_deferred_buffer), &type, &length))
+    {
+        if (!mqtt_client_parse_publish(type, mqtt_deferred_buffer, length, &message))
+        {
+            continue;
+        }
+
+        mqtt_client_deliver(&message);
+        delivered++;
+
+        if (MQTT_CLIENT_QOS1 == message.qos)
+        {
+            puback[2] = (uint8_t)(message.packet_id >> 8);
+            puback[3] = (uint8_t)(message.packet_id & 0xFF);
+            if (!mqtt_client_write(socket, puback, sizeof(puback)))
+            {
+                break;
+            }
+        }
+    }
+
+    (void)mqtt_client_write(socket, disconnect, sizeof(disconnect));
+    (void)SOCKETS_Shutdown(socket, SOCKETS_SHUT_RDWR);
+    (void)SOCKETS_Close(socket);
+
+    if (0 != delivered)
+    {
+        APP_INFO(("Received %lu deferred MQTT messages.\n", (unsigned long)delivered));
+    }
+}
+
+#endif /* MQTT_CLIENT && MQTT_DEFERRED_SESSION */
+
+
+/* [] END OF FILE */
+
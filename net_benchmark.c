@@ -0,0 +1,580 @@
+/*******************************************************************************
+ * File Name:   net_benchmark.c
+ *
+ * Description: This file contains the network throughput benchmark. The host
+ * runs a bulk transfer with net_benchmark.py, and the PSoC 6 MCU replies with
+ * the number of bytes transferred, the transfer time, the time the CPU spent
+ * in active mode, and the number of chained frames copied by netif_tx_chain.c,
+ * which net_benchmark.py prints next to its own throughput.
+ *
+ * The receive path is measured in two forms:
+ *  - NET_BENCHMARK_PORT: The lwIP raw TCP API. The WHD receive buffers are
+ *    lwIP pool pbufs, which are passed to the network stack as they are, so
+ *    the payload is read in place in the buffer filled by the SDIO bus and the
+ *    buffer goes back to the pool when the pbuf is freed. There is no payload
+ *    copy between the driver and the consumer.
+ *  - NET_BENCHMARK_PORT + 1: The socket API, which copies the payload out of
+ *    the pbufs into the buffer of the receiving task.
+ *
+ * The transmit path is measured on NET_BENCHMARK_PORT + 2. The host requests
+ * a number of bytes and the size of each write, and the device sends them
+ * with the socket API, as the secure sockets do.
+ *
+ *******************************************************************************
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+
+/* Include header files */
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdbool.h>
+#include <string.h>
+#include <lwip/tcp.h>
+#include <lwip/tcpip.h>
+#include <lwip/sockets.h>
+
+#include "net_benchmark.h"
+#include "netif_tx_chain.h"
+#include "sleep_stats.h"
+#include "wifi_config.h"
+
+#if NET_BENCHMARK
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define NET_BENCHMARK_RX_PORT                (NET_BENCHMARK_PORT)
+#define NET_BENCHMARK_RX_COPY_PORT           (NET_BENCHMARK_PORT + 1)
+#define NET_BENCHMARK_TX_PORT                (NET_BENCHMARK_PORT + 2)
+
+/* Buffer of a socket API benchmark task, which is also the largest write. */
+#define NET_BENCHMARK_SOCKET_BUFFER_SIZE     (2 * TCP_MSS)
+
+#define NET_BENCHMARK_TASK_STACK_SIZE        (configMINIMAL_STACK_SIZE * 4)
+#define NET_BENCHMARK_TASK_PRIORITY          (tskIDLE_PRIORITY + 1)
+
+/*******************************************************************************
+ * Static Global Structures and variables
+ ******************************************************************************/
+/* State of a benchmark transfer. */
+typedef struct
+{
+    bool started;
+    uint32_t bytes;
+    uint32_t checksum;             /* Keeps the payload reads from being optimized out. */
+    TickType_t start;
+    uint64_t active_ms;            /* Active mode time at the start. */
+    uint32_t linearized;           /* Chained frames copied before the start. */
+} net_benchmark_run_t;
+
+/* Result sent back to the host, in network byte order. */
+typedef struct
+{
+    uint32_t bytes;
+    uint32_t elapsed_ms;
+    uint32_t active_ms;
+    uint32_t linearized;
+} net_benchmark_result_t;
+
+/* Transmit request of the host, in network byte order. */
+typedef struct
+{
+    uint32_t bytes;
+    uint32_t write_size;
+} net_benchmark_tx_request_t;
+
+static struct tcp_pcb *net_benchmark_rx_pcb = NULL;
+static net_benchmark_run_t net_benchmark_rx_run;
+static net_benchmark_run_t net_benchmark_rx_copy_run;
+static net_benchmark_run_t net_benchmark_tx_run;
+static uint8_t net_benchmark_rx_copy_buffer[NET_BENCHMARK_SOCKET_BUFFER_SIZE];
+static uint8_t net_benchmark_tx_buffer[NET_BENCHMARK_SOCKET_BUFFER_SIZE];
+
+/*******************************************************************************
+ * Function definitions
+ ******************************************************************************/
+/*******************************************************************************
+* Function Name: net_benchmark_get_active_ms
+********************************************************************************
+* Summary:
+*  Returns the time the CPU has spent in active mode.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  uint64_t: Active mode time in milliseconds, or 0 if SLEEP_STATS is disabled.
+*
+*******************************************************************************/
+static uint64_t net_benchmark_get_active_ms(void)
+{
+#if SLEEP_STATS
+    sleep_stats_t stats;
+
+    sleep_stats_get(&stats);
+    return stats.active_ms;
+#else
+    return 0;
+#endif
+}
+
+/*******************************************************************************
+* Function Name: net_benchmark_get_linearized
+********************************************************************************
+* Summary:
+*  Returns the number of chained frames copied into a single buffer before
+*  they were sent.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  uint32_t: Number of copied frames, or 0 if lwIP sends single pbufs only.
+*
+*******************************************************************************/
+static uint32_t net_benchmark_get_linearized(void)
+{
+#if !LWIP_NETIF_TX_SINGLE_PBUF
+    netif_tx_chain_stats_t stats;
+
+    netif_tx_chain_get_stats(&stats);
+    return stats.linearized;
+#else
+    return 0;
+#endif
+}
+
+/*******************************************************************************
+* Function Name: net_benchmark_begin
+********************************************************************************
+* Summary:
+*  Starts the transfer time and takes the counters at the start.
+*
+* Parameters:
+*  run : Benchmark transfer.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void net_benchmark_begin(net_benchmark_run_t *run)
+{
+    run->started = true;
+    run->start = xTaskGetTickCount();
+    run->active_ms = net_benchmark_get_active_ms();
+    run->linearized = net_benchmark_get_linearized();
+}
+
+/*******************************************************************************
+* Function Name: net_benchmark_consume
+********************************************************************************
+* Summary:
+*  Reads received payload, and starts the transfer time on the first bytes.
+*
+* Parameters:
+*  run    : Benchmark transfer.
+*  data   : Received payload.
+*  length : Length of the payload in bytes.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void net_benchmark_consume(net_benchmark_run_t *run, const uint8_t *data, uint32_t length)
+{
+    uint32_t index;
+
+    if (!run->started)
+    {
+        net_benchmark_begin(run);
+    }
+
+    for (index = 0; index < length; index++)
+    {
+        run->checksum += data[index];
+    }
+    run->bytes += length;
+}
+
+/*******************************************************************************
+* Function Name: net_benchmark_finish
+********************************************************************************
+* Summary:
+*  Ends a benchmark transfer, prints it, and fills in the result for the host.
+*
+* Parameters:
+*  run    : Benchmark transfer.
+*  name   : Name of the receive path.
+*  result : Result in network byte order.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void net_benchmark_finish(net_benchmark_run_t *run, const char *name, net_benchmark_result_t *result)
+{
+    uint32_t elapsed_ms = 0;
+    uint32_t active_ms = 0;
+    uint32_t linearized = 0;
+
+    if (run->started)
+    {
+        elapsed_ms = (xTaskGetTickCount() - run->start) * portTICK_PERIOD_MS;
+        active_ms = (uint32_t)(net_benchmark_get_active_ms() - run->active_ms);
+        linearized = net_benchmark_get_linearized() - run->linearized;
+    }
+
+    APP_INFO(("Net benchmark %s: %lu bytes in %lu ms, %lu ms active, %lu frames copied\n", name,
+              (unsigned long)run->bytes, (unsigned long)elapsed_ms, (unsigned long)active_ms,
+              (unsigned long)linearized));
+
+    result->bytes = lwip_htonl(run->bytes);
+    result->elapsed_ms = lwip_htonl(elapsed_ms);
+    result->active_ms = lwip_htonl(active_ms);
+    result->linearized = lwip_htonl(linearized);
+
+    memset(run, 0, sizeof(*run));
+}
+
+/*******************************************************************************
+* Function Name: net_benchmark_rx_recv
+********************************************************************************
+* Summary:
+*  lwIP raw API receive callback. Reads the payload in place in the received
+*  pbuf chain and frees it, which returns the WHD buffers to the pool. Sends
+*  the result and closes the connection when the host has finished sending.
+*
+* Parameters:
+*  arg : Unused.
+*  pcb : TCP connection.
+*  p   : Received pbuf chain, or NULL when the host has closed the connection.
+*  err : Receive status.
+*
+* Return:
+*  err_t: ERR_OK.
+*
+*******************************************************************************/
+static err_t net_benchmark_rx_recv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
+{
+    net_benchmark_result_t result;
+    struct pbuf *q;
+
+    (void)arg;
+
+    if ((NULL == p) || (ERR_OK != err))
+    {
+        if (NULL != p)
+        {
+            pbuf_free(p);
+        }
+
+        net_benchmark_finish(&net_benchmark_rx_run, "RX", &result);
+        (void)tcp_write(pcb, &result, sizeof(result), TCP_WRITE_FLAG_COPY);
+        (void)tcp_output(pcb);
+        tcp_recv(pcb, NULL);
+        if (ERR_OK != tcp_close(pcb))
+        {
+            tcp_abort(pcb);
+            return ERR_ABRT;
+        }
+
+        return ERR_OK;
+    }
+
+    for (q = p; NULL != q; q = q->next)
+    {
+        net_benchmark_consume(&net_benchmark_rx_run, (const uint8_t *)q->payload, q->len);
+    }
+
+    tcp_recved(pcb, p->tot_len);
+    pbuf_free(p);
+
+    return ERR_OK;
+}
+
+/*******************************************************************************
+* Function Name: net_benchmark_rx_accept
+********************************************************************************
+* Summary:
+*  lwIP raw API accept callback.
+*
+* Parameters:
+*  arg    : Unused.
+*  newpcb : Accepted TCP connection.
+*  err    : Accept status.
+*
+* Return:
+*  err_t: ERR_OK.
+*
+*******************************************************************************/
+static err_t net_benchmark_rx_accept(void *arg, struct tcp_pcb *newpcb, err_t err)
+{
+    (void)arg;
+
+    if ((ERR_OK != err) || (NULL == newpcb))
+    {
+        return ERR_VAL;
+    }
+
+    memset(&net_benchmark_rx_run, 0, sizeof(net_benchmark_rx_run));
+    tcp_recv(newpcb, net_benchmark_rx_recv);
+
+    return ERR_OK;
+}
+
+/*******************************************************************************
+* Function Name: net_benchmark_listen
+********************************************************************************
+* Summary:
+*  Opens a listening socket on the given port.
+*
+* Parameters:
+*  port : TCP port.
+*
+* Return:
+*  int: Listening socket, or -1 on failure.
+*
+*******************************************************************************/
+static int net_benchmark_listen(uint16_t port)
+{
+    struct sockaddr_in address;
+    int listen_socket;
+
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = lwip_htons(port);
+    address.sin_addr.s_addr = lwip_htonl(INADDR_ANY);
+
+    listen_socket = lwip_socket(AF_INET, SOCK_STREAM, 0);
+    if ((listen_socket >= 0) &&
+        ((0 != lwip_bind(listen_socket, (struct sockaddr *)&address, sizeof(address))) ||
+         (0 != lwip_listen(listen_socket, 1))))
+    {
+        (void)lwip_close(listen_socket);
+        listen_socket = -1;
+    }
+
+    if (listen_socket < 0)
+    {
+        ERR_INFO(("Failed to open the net benchmark port %u.\n", (unsigned int)port));
+    }
+
+    return listen_socket;
+}
+
+/*******************************************************************************
+* Function Name: net_benchmark_rx_copy_task
+********************************************************************************
+* Summary:
+*  Receives the benchmark transfers with the socket API, one connection at a
+*  time.
+*
+* Parameters:
+*  arg : Unused.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void net_benchmark_rx_copy_task(void *arg)
+{
+    net_benchmark_result_t result;
+    int listen_socket;
+    int connection;
+    int received;
+
+    (void)arg;
+
+    listen_socket = net_benchmark_listen(NET_BENCHMARK_RX_COPY_PORT);
+    if (listen_socket < 0)
+    {
+        vTaskDelete(NULL);
+        return;
+    }
+
+    while (true)
+    {
+        connection = lwip_accept(listen_socket, NULL, NULL);
+        if (connection < 0)
+        {
+            continue;
+        }
+
+        memset(&net_benchmark_rx_copy_run, 0, sizeof(net_benchmark_rx_copy_run));
+        while ((received = lwip_recv(connection, net_benchmark_rx_copy_buffer,
+                                     sizeof(net_benchmark_rx_copy_buffer), 0)) > 0)
+        {
+            net_benchmark_consume(&net_benchmark_rx_copy_run, net_benchmark_rx_copy_buffer, (uint32_t)received);
+        }
+
+        net_benchmark_finish(&net_benchmark_rx_copy_run, "RX copy", &result);
+        (void)lwip_send(connection, &result, sizeof(result), 0);
+        (void)lwip_close(connection);
+    }
+}
+
+/*******************************************************************************
+* Function Name: net_benchmark_tx_task
+********************************************************************************
+* Summary:
+*  Sends the benchmark transfers requested by the host with the socket API,
+*  one connection at a time, followed by the result.
+*
+* Parameters:
+*  arg : Unused.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void net_benchmark_tx_task(void *arg)
+{
+    net_benchmark_tx_request_t request;
+    net_benchmark_result_t result;
+    uint32_t remaining;
+    uint32_t write_size;
+    uint32_t index;
+    int listen_socket;
+    int connection;
+    int sent;
+
+    (void)arg;
+
+    for (index = 0; index < sizeof(net_benchmark_tx_buffer); index++)
+    {
+        net_benchmark_tx_buffer[index] = (uint8_t)index;
+    }
+
+    listen_socket = net_benchmark_listen(NET_BENCHMARK_TX_PORT);
+    if (listen_socket < 0)
+    {
+        vTaskDelete(NULL);
+        return;
+    }
+
+    while (true)
+    {
+        connection = lwip_accept(listen_socket, NULL, NULL);
+        if (connection < 0)
+        {
+            continue;
+        }
+
+        if ((int)sizeof(request) != lwip_recv(connection, &request, sizeof(request), MSG_WAITALL))
+        {
+            (void)lwip_close(connection);
+            continue;
+        }
+
+        remaining = lwip_ntohl(request.bytes);
+        write_size = lwip_ntohl(request.write_size);
+        if ((0 == write_size) || (write_size > sizeof(net_benchmark_tx_buffer)))
+        {
+            write_size = sizeof(net_benchmark_tx_buffer);
+        }
+
+        memset(&net_benchmark_tx_run, 0, sizeof(net_benchmark_tx_run));
+        net_benchmark_begin(&net_benchmark_tx_run);
+
+        while (remaining > 0)
+        {
+            sent = lwip_send(connection, net_benchmark_tx_buffer,
+                             (remaining < write_size) ? remaining : write_size, 0);
+            if (sent <= 0)
+            {
+                break;
+            }
+
+            net_benchmark_tx_run.bytes += (uint32_t)sent;
+            remaining -= (uint32_t)sent;
+        }
+
+        net_benchmark_finish(&net_benchmark_tx_run, "TX", &result);
+        (void)lwip_send(connection, &result, sizeof(result), 0);
+        (void)lwip_close(connection);
+    }
+}
+
+/*******************************************************************************
+* Function Name: net_benchmark_start
+********************************************************************************
+* Summary:
+*  Starts listening for the benchmark transfers of net_benchmark.py.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void net_benchmark_start(void)
+{
+    struct tcp_pcb *pcb;
+
+    LOCK_TCPIP_CORE();
+
+    pcb = tcp_new_ip_type(IPADDR_TYPE_ANY);
+    if ((NULL != pcb) && (ERR_OK == tcp_bind(pcb, IP_ANY_TYPE, NET_BENCHMARK_RX_PORT)))
+    {
+        net_benchmark_rx_pcb = tcp_listen_with_backlog(pcb, 1);
+        if (NULL != net_benchmark_rx_pcb)
+        {
+            tcp_accept(net_benchmark_rx_pcb, net_benchmark_rx_accept);
+        }
+    }
+    else if (NULL != pcb)
+    {
+        (void)tcp_close(pcb);
+    }
+
+    UNLOCK_TCPIP_CORE();
+
+    if (NULL == net_benchmark_rx_pcb)
+    {
+        ERR_INFO(("Failed to open the net benchmark port.\n"));
+    }
+
+    (void)xTaskCreate(net_benchmark_rx_copy_task, "NetBenchRx", NET_BENCHMARK_TASK_STACK_SIZE, NULL,
+                      NET_BENCHMARK_TASK_PRIORITY, NULL);
+    (void)xTaskCreate(net_benchmark_tx_task, "NetBenchTx", NET_BENCHMARK_TASK_STACK_SIZE, NULL,
+                      NET_BENCHMARK_TASK_PRIORITY, NULL);
+
+    APP_INFO(("Net benchmark listening on ports %d to %d.\n",
+              NET_BENCHMARK_RX_PORT, NET_BENCHMARK_TX_PORT));
+}
+
+#endif /* NET_BENCHMARK */
+
+
+/* [] END OF FILE */
+
@@ -0,0 +1,175 @@
+#******************************************************************************
+# File Name:   net_benchmark.py
+#
+# Description: Host side of the network throughput benchmark of
+# net_benchmark.c. It sends a bulk transfer to the device, and prints the
+# throughput seen by the host next to the transfer time and the CPU active
+# time reported by the device.
+#
+#******************************************************************************
+# (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+#******************************************************************************
+# This software, including source code, documentation and related materials
+# ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+# subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+# protection (United States and foreign), United States copyright laws and
+# international treaty provisions. Therefore, you may use this Software only
+# as provided in the license agreement accompanying the software package from
+# which you obtained this Software ("EULA").
+#
+# If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+# non-transferable license to copy, modify, and compile the Software source
+# code solely for use in connection with Cypress's integrated circuit products.
+# Any reproduction, modification, translation, compilation, or representation
+# of this Software except as specified above is prohibited without the express
+# written permission of Cypress.
+#
+# Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+# EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+# reserves the right to make changes to the Software without notice. Cypress
+# does not assume any liability arising out of the application or use of the
+# Software or any product or circuit described in the Software. Cypress does
+# not authorize its products for use in any products where a malfunction or
+# failure of the Cypress product may reasonably be expected to result in
+# significant property damage, injury or death ("High Risk Product"). By
+# including Cypress's product in a High Risk Product, the manufacturer of such
+# system or application assumes all risk of such use and in doing so agrees to
+# indemnify Cypress against all liability.
+#******************************************************************************/
+
+#!/usr/bin/python
+
+"""
+Host side of the network throughput benchmark of net_benchmark.c.
+
+Usage:
+    python net_benchmark.py -i <device IP address> -m rx
+    python net_benchmark.py -i <device IP address> -m rx-copy -s 4096
+    python net_benchmark.py -i <device IP address> -m tx -w 1000
+"""
+
+import optparse
+import socket
+import struct
+import sys
+import time
+
+# Must match net_benchmark.c.
+DEFAULT_PORT = 50010
+MODE_PORT_OFFSET = {'rx': 0, 'rx-copy': 1, 'tx': 2}
+RESULT_FORMAT = '!IIII'
+TX_REQUEST_FORMAT = '!II'
+
+CHUNK_SIZE = 4096
+
+
+def receive_exactly(conn, length):
+    data = b''
+    while len(data) < length:
+        chunk = conn.recv(min(length - len(data), 65536))
+        if not chunk:
+            break
+        data += chunk
+    return data
+
+
+def receive_discard(conn, length):
+    """Receives and drops length bytes, and returns the number received."""
+    received = 0
+    while received < length:
+        chunk = conn.recv(min(length - received, 65536))
+        if not chunk:
+            break
+        received += len(chunk)
+    return received
+
+
+def run_rx(conn, size, write_size):
+    """Sends size bytes to the device."""
+    payload = bytes(bytearray(i & 0xFF for i in range(CHUNK_SIZE)))
+    remaining = size
+    while remaining > 0:
+        count = min(remaining, CHUNK_SIZE)
+        conn.sendall(payload[:count])
+        remaining -= count
+    conn.shutdown(socket.SHUT_WR)
+
+
+def run_tx(conn, size, write_size):
+    """Requests size bytes from the device, written write_size bytes at a
+    time."""
+    conn.sendall(struct.pack(TX_REQUEST_FORMAT, size, write_size))
+    received = receive_discard(conn, size)
+    if received != size:
+        raise IOError("the device sent %d of %d bytes" % (received, size))
+
+
+def run(address, port, mode, size, write_size):
+    """Runs one transfer, and returns the host transfer time and the result
+    reported by the device."""
+    conn = socket.create_connection((address, port), timeout=30)
+    try:
+        start = time.time()
+        if mode == 'tx':
+            run_tx(conn, size, write_size)
+        else:
+            run_rx(conn, size, write_size)
+        result = receive_exactly(conn, struct.calcsize(RESULT_FORMAT))
+        elapsed = time.time() - start
+    finally:
+        conn.close()
+
+    if len(result) != struct.calcsize(RESULT_FORMAT):
+        raise IOError("no result from the device")
+
+    return elapsed, struct.unpack(RESULT_FORMAT, result)
+
+
+def print_result(mode, size, elapsed, device_result, cpu_hz):
+    device_bytes, device_ms, active_ms, linearized = device_result
+    print("%-8s host:   %d bytes in %.3f s, %.1f kbit/s" %
+          (mode, size, elapsed, (size * 8) / (elapsed * 1000.0)))
+    if device_ms:
+        print("%-8s device: %d bytes in %d ms, %.1f kbit/s" %
+              (mode, device_bytes, device_ms, (device_bytes * 8.0) / device_ms))
+    if active_ms and device_bytes:
+        print("%-8s CPU active %d ms (%.1f%% of the transfer), %.1f cycles per byte" %
+              (mode, active_ms, (100.0 * active_ms) / max(device_ms, 1),
+               (active_ms * cpu_hz) / (1000.0 * device_bytes)))
+    if linearized:
+        print("%-8s %d chained frames copied before sending" % (mode, linearized))
+    if device_bytes != size:
+        print("%-8s warning: the device transferred %d of %d bytes" % (mode, device_bytes, size))
+
+
+if __name__ == '__main__':
+    parser = optparse.OptionParser()
+    parser.add_option("-i", "--ip", dest="ip", help="IP address of the device.")
+    parser.add_option("-p", "--port", dest="port", type="int", default=DEFAULT_PORT,
+                      help="NET_BENCHMARK_PORT of the device [default: %default].")
+    parser.add_option("-m", "--mode", dest="mode", type="choice", choices=sorted(MODE_PORT_OFFSET.keys()),
+                      default='rx', help="Benchmark: %s [default: %%default]." % ", ".join(sorted(MODE_PORT_OFFSET.keys())))
+    parser.add_option("-s", "--size", dest="size", type="int", default=1024,
+                      help="Size of the transfer in KB [default: %default].")
+    parser.add_option("-w", "--write-size", dest="write_size", type="int", default=1000,
+                      help="Size of each write of the device in the tx mode [default: %default].")
+    parser.add_option("-n", "--count", dest="count", type="int", default=1,
+                      help="Number of transfers [default: %default].")
+    parser.add_option("-c", "--cpu-hz", dest="cpu_hz", type="int", default=100000000,
+                      help="CPU clock of the device [default: %default].")
+
+    (options, args) = parser.parse_args()
+
+    if not options.ip:
+        parser.error("the IP address of the device is required")
+
+    size = options.size * 1024
+    for count in range(options.count):
+        try:
+            elapsed, device_result = run(options.ip, options.port + MODE_PORT_OFFSET[options.mode],
+                                         options.mode, size, options.write_size)
+        except (IOError, socket.error) as error:
+            print("%s: %s" % (options.mode, error))
+            sys.exit(1)
+        print_result(options.mode, size, elapsed, device_result, options.cpu_hz)
@@ -0,0 +1,272 @@
+/*******************************************************************************
+ * File Name:   netif_tx_chain.c
+ *
+ * Description: This file contains the transmit path of the Wi-Fi interface
+ * for chained pbufs. With LWIP_NETIF_TX_SINGLE_PBUF, lwIP allocates every TCP
+ * segment at the full MSS so that it never needs to chain more data to it,
+ * which takes a full segment buffer even for a keepalive or a short MQTT
+ * packet. Without it, segments are allocated at the size written, and are
+ * extended by chaining pbufs.
+ *
+ * The WHD bus layer sends a frame from a single buffer, with its bus headers
+ * in the headroom in front of it. The link output function of the Wi-Fi
+ * interface is wrapped, so that a single pbuf frame, which is the common
+ * case, is passed to the driver as it is, and only a chained frame is copied
+ * into a single pbuf with the same headroom.
+ *
+ *******************************************************************************
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+
+/* Include header files */
+#include "FreeRTOS.h"
+#include "task.h"
+#include <lwip/netif.h>
+#include <lwip/pbuf.h>
+#include <lwip/prot/ethernet.h>
+#include <lwip/stats.h>
+#include <lwip/tcpip.h>
+
+#include "netif_tx_chain.h"
+
+#if !LWIP_NETIF_TX_SINGLE_PBUF
+
+/*******************************************************************************
+ * Static Global Structures and variables
+ ******************************************************************************/
+/* Link output function of the Wi-Fi driver. */
+static netif_linkoutput_fn netif_tx_chain_driver_linkoutput = NULL;
+
+static netif_tx_chain_stats_t netif_tx_chain_stats;
+
+/* lwIP extended netif status callback entry. */
+NETIF_DECLARE_EXT_CALLBACK(netif_tx_chain_netif_callback_entry)
+
+/*******************************************************************************
+ * Function definitions
+ ******************************************************************************/
+/*******************************************************************************
+* Function Name: netif_tx_chain_linearize
+********************************************************************************
+* Summary:
+*  Copies a chained Ethernet frame into a single pbuf. The pbuf is allocated
+*  with the same headroom as a frame built by lwIP, which the driver uses for
+*  its bus headers.
+*
+* Parameters:
+*  p : Chained Ethernet frame.
+*
+* Return:
+*  struct pbuf *: Single pbuf copy of the frame, or NULL if out of memory.
+*
+*******************************************************************************/
+static struct pbuf *netif_tx_chain_linearize(struct pbuf *p)
+{
+    struct pbuf *q;
+
+    if (p->tot_len < SIZEOF_ETH_HDR)
+    {
+        return NULL;
+    }
+
+    q = pbuf_alloc(PBUF_IP, (u16_t)(p->tot_len - SIZEOF_ETH_HDR), PBUF_RAM);
+    if (NULL == q)
+    {
+        return NULL;
+    }
+
+    if ((0 != pbuf_add_header(q, SIZEOF_ETH_HDR)) || (ERR_OK != pbuf_copy(q, p)))
+    {
+        pbuf_free(q);
+        return NULL;
+    }
+
+    return q;
+}
+
+/*******************************************************************************
+* Function Name: netif_tx_chain_linkoutput
+********************************************************************************
+* Summary:
+*  Link output function of the Wi-Fi interface. Passes a single pbuf frame to
+*  the driver as it is, and a chained frame as a single pbuf copy.
+*
+* Parameters:
+*  netif : Wi-Fi interface.
+*  p     : Ethernet frame.
+*
+* Return:
+*  err_t: Result of the driver, or ERR_MEM if the chained frame could not be
+*  copied.
+*
+*******************************************************************************/
+static err_t netif_tx_chain_linkoutput(struct netif *netif, struct pbuf *p)
+{
+    struct pbuf *q;
+    err_t err;
+
+    if (NULL == p->next)
+    {
+        netif_tx_chain_stats.direct++;
+        return netif_tx_chain_driver_linkoutput(netif, p);
+    }
+
+    q = netif_tx_chain_linearize(p);
+    if (NULL == q)
+    {
+        netif_tx_chain_stats.failed++;
+        LINK_STATS_INC(link.memerr);
+        return ERR_MEM;
+    }
+
+    netif_tx_chain_stats.linearized++;
+
+    /* The driver takes its own reference if it holds the frame after this. */
+    err = netif_tx_chain_driver_linkoutput(netif, q);
+    pbuf_free(q);
+
+    return err;
+}
+
+/*******************************************************************************
+* Function Name: netif_tx_chain_install
+********************************************************************************
+* Summary:
+*  Wraps the link output function of the given interface, if it is the
+*  Ethernet interface of the Wi-Fi driver. Must be called with the lwIP core
+*  locked.
+*
+* Parameters:
+*  netif : Network interface.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void netif_tx_chain_install(struct netif *netif)
+{
+    if ((NULL == netif) || (NULL == netif->linkoutput) ||
+        (netif_tx_chain_linkoutput == netif->linkoutput) ||
+        (0 == (netif->flags & NETIF_FLAG_ETHARP)))
+    {
+        return;
+    }
+
+    netif_tx_chain_driver_linkoutput = netif->linkoutput;
+    netif->linkoutput = netif_tx_chain_linkoutput;
+}
+
+/*******************************************************************************
+* Function Name: netif_tx_chain_netif_callback
+********************************************************************************
+* Summary:
+*  lwIP extended netif status callback. The Wi-Fi interface is added again
+*  with the link output function of the driver when it reconnects, so it is
+*  wrapped again. It is called from the tcpip thread context.
+*
+* Parameters:
+*  netif  : Network interface on which the change happened.
+*  reason : Bitmask of LWIP_NSC_* change reasons.
+*  args   : Unused.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void netif_tx_chain_netif_callback(struct netif *netif,
+                                          netif_nsc_reason_t reason,
+                                          const netif_ext_callback_args_t *args)
+{
+    (void)args;
+
+    if (0 != (reason & LWIP_NSC_NETIF_ADDED))
+    {
+        netif_tx_chain_install(netif);
+    }
+}
+
+/*******************************************************************************
+* Function Name: netif_tx_chain_init
+********************************************************************************
+* Summary:
+*  Wraps the link output function of the Wi-Fi interface, now and whenever
+*  it is added again. This is called after tcpip_init(), before the Wi-Fi
+*  interface is brought up.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void netif_tx_chain_init(void)
+{
+    struct netif *netif;
+
+    LOCK_TCPIP_CORE();
+
+    netif_add_ext_callback(&netif_tx_chain_netif_callback_entry, netif_tx_chain_netif_callback);
+
+    NETIF_FOREACH(netif)
+    {
+        netif_tx_chain_install(netif);
+    }
+
+    UNLOCK_TCPIP_CORE();
+}
+
+/*******************************************************************************
+* Function Name: netif_tx_chain_get_stats
+********************************************************************************
+* Summary:
+*  Returns the number of frames sent on each path.
+*
+* Parameters:
+*  stats : Filled with the frame counts.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void netif_tx_chain_get_stats(netif_tx_chain_stats_t *stats)
+{
+    LOCK_TCPIP_CORE();
+    *stats = netif_tx_chain_stats;
+    UNLOCK_TCPIP_CORE();
+}
+
+#endif /* !LWIP_NETIF_TX_SINGLE_PBUF */
+
+
+/* [] END OF FILE */
+
@@ -0,0 +1,68 @@
+/******************************************************************************
+* File Name: netif_tx_chain.h
+*
+* Description: This file contains the interface of the transmit path which
+* passes chained pbufs from lwIP to the Wi-Fi driver.
+*
+******************************************************************************
+* Copyright (2020), Cypress Semiconductor Corporation.
+******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death (“High Risk Product”). By
+* including Cypress’s product in a High Risk Product, the manufacturer of such
+* system or application assumes all risk of such use and in doing so agrees to
+* indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef _NETIF_TX_CHAIN_H_
+#define _NETIF_TX_CHAIN_H_
+
+#include <stdint.h>
+
+/*******************************************************************************
+ * Type Definitions
+ ******************************************************************************/
+/* Frames sent on the Wi-Fi interface since netif_tx_chain_init(). */
+typedef struct
+{
+    uint32_t direct;               /* Single pbuf frames passed to the driver as they are. */
+    uint32_t linearized;           /* Chained frames copied into a single pbuf. */
+    uint32_t failed;               /* Chained frames dropped for lack of memory. */
+} netif_tx_chain_stats_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+void netif_tx_chain_init(void);
+void netif_tx_chain_get_stats(netif_tx_chain_stats_t *stats);
+
+#endif /* _NETIF_TX_CHAIN_H_ */
+
+
+/* [] END OF FILE */
+
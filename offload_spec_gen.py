@@ -0,0 +1,138 @@
+#******************************************************************************
+# File Name:   offload_spec_gen.py
+#
+# Description: Generates the cycfg_connectivity_wifi.c of every board under
+# COMPONENT_CUSTOM_DESIGN_MODUS from the offload specification. The generated
+# file returns the constant offload list which wlan_offload_spec.c builds from
+# wlan_offload_spec.h, so that the offload manager starts with it. Run it after
+# saving design.modus in the Device Configurator, which overwrites the file.
+#
+#******************************************************************************
+# (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+#******************************************************************************
+# This software, including source code, documentation and related materials
+# ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+# subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+# protection (United States and foreign), United States copyright laws and
+# international treaty provisions. Therefore, you may use this Software only
+# as provided in the license agreement accompanying the software package from
+# which you obtained this Software ("EULA").
+#
+# If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+# non-transferable license to copy, modify, and compile the Software source
+# code solely for use in connection with Cypress's integrated circuit products.
+# Any reproduction, modification, translation, compilation, or representation
+# of this Software except as specified above is prohibited without the express
+# written permission of Cypress.
+#
+# Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+# EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+# reserves the right to make changes to the Software without notice. Cypress
+# does not assume any liability arising out of the application or use of the
+# Software or any product or circuit described in the Software. Cypress does
+# not authorize its products for use in any products where a malfunction or
+# failure of the Cypress product may reasonably be expected to result in
+# significant property damage, injury or death ("High Risk Product"). By
+# including Cypress's product in a High Risk Product, the manufacturer of such
+# system or application assumes all risk of such use and in doing so agrees to
+# indemnify Cypress against all liability.
+#******************************************************************************/
+
+#!/usr/bin/python
+
+"""
+Generates the cycfg_connectivity_wifi.c of every board from the offload
+specification in wlan_offload_spec.h.
+
+Usage:
+    python offload_spec_gen.py
+    python offload_spec_gen.py --check
+
+With --check, no file is written, and the exit status is 1 if any board has
+a cycfg_connectivity_wifi.c which is not the generated one.
+"""
+
+import glob
+import optparse
+import os
+import sys
+
+DESIGN_DIR = 'COMPONENT_CUSTOM_DESIGN_MODUS'
+GENERATED_FILE = os.path.join('GeneratedSource', 'cycfg_connectivity_wifi.c')
+
+TEMPLATE = '''/*******************************************************************************
+* File Name: cycfg_connectivity_wifi.c
+*
+* Description:
+* Connectivity Wi-Fi configuration of the {board} board
+* This file was automatically generated by offload_spec_gen.py from the offload
+* specification in wlan_offload_spec.h and should not be modified.
+*
+********************************************************************************
+* Copyright 2020 Cypress Semiconductor Corporation
+* SPDX-License-Identifier: Apache-2.0
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+*     http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+********************************************************************************/
+
+#include "cycfg_connectivity_wifi.h"
+#include "wlan_offload_spec.h"
+
+const ol_desc_t *cycfg_get_default_ol_list(void)
+{{
+\treturn wlan_offload_spec_get_ol_list();
+}}
+'''
+
+def board_dirs(root):
+    return sorted(glob.glob(os.path.join(root, DESIGN_DIR, 'TARGET_*')))
+
+def generate(board_dir, check):
+    board = os.path.basename(board_dir)[len('TARGET_'):]
+    path = os.path.join(board_dir, GENERATED_FILE)
+    # The Device Configurator writes CRLF line endings.
+    text = TEMPLATE.format(board=board).replace('\n', '\r\n').encode('ascii')
+
+    current = None
+    if os.path.exists(path):
+        with open(path, 'rb') as source:
+            current = source.read()
+
+    if current == text:
+        return True
+
+    if check:
+        print("%s: out of date" % path)
+        return False
+
+    with open(path, 'wb') as source:
+        source.write(text)
+    print("%s: generated" % path)
+    return True
+
+if __name__ == '__main__':
+    parser = optparse.OptionParser()
+    parser.add_option("-c", "--check", dest="check", action="store_true", default=False,
+                      help="Only check that the generated files are up to date.")
+    parser.add_option("-d", "--dir", dest="dir", default=os.path.dirname(os.path.abspath(__file__)),
+                      help="Application directory [default: %default].")
+
+    (options, args) = parser.parse_args()
+
+    boards = board_dirs(options.dir)
+    if not boards:
+        parser.error("no %s/TARGET_* directory in %s" % (DESIGN_DIR, options.dir))
+
+    results = [generate(board, options.check) for board in boards]
+    sys.exit(0 if all(results) else 1)
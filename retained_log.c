@@ -0,0 +1,834 @@
+/*******************************************************************************
+ * File Name:   retained_log.c
+ *
+ * Description: This file contains the retained log. It keeps the last
+ * RETAINED_LOG_ENTRIES log records, and the details of the last fault caught
+ * by the assert, heap allocation failure, and stack overflow hooks, in a
+ * CY_NOINIT RAM section. The section is retained in deep sleep and is not
+ * initialized by the startup code, so that the records survive a reset.
+ *
+ * After a reset caused by a fault, the crash report is printed at startup and
+ * sent to the TCP server on the first connected socket. Until it is sent, the
+ * log records which led to the fault are not overwritten.
+ *
+ * While the network stack is suspended, the text log messages less severe than
+ * APP_LOG_SUSPENDED_LEVEL are held back in a buffer of their own, so that they
+ * do not wake up the logging task and the UART. They are printed together on
+ * the next wake.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+
+/* Include header files */
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+/* BSP & HAL includes. */
+#include "cy_device_headers.h"
+#include "cy_syslib.h"
+#include "cyhal.h"
+#include "cy_retarget_io.h"
+
+#include "retained_log.h"
+#include "wifi_config.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Identifies valid retained data. Changes with the layout of the data. */
+#define RETAINED_LOG_MAGIC                   (0x524C4F49UL)
+
+/* Maximum length of a report line. Fits a binary record in hexadecimal. */
+#define RETAINED_LOG_LINE_LENGTH             (224)
+
+/* Maximum size of a binary record kept in the retained log, in words. */
+#define RETAINED_LOG_RECORD_WORDS            (RETAINED_LOG_TEXT_LENGTH / sizeof(uint32_t))
+
+/*******************************************************************************
+ * Static Global Structures and variables
+ ******************************************************************************/
+/* Log record. */
+typedef struct
+{
+    uint32_t tick;
+    uint32_t level;
+    uint32_t record_words;         /* Words of a binary record, or 0 for a text record. */
+    union
+    {
+        char text[RETAINED_LOG_TEXT_LENGTH];
+        uint32_t record[RETAINED_LOG_RECORD_WORDS];
+    };
+} retained_log_entry_t;
+
+/* Stack high-water mark of a task, in words. */
+typedef struct
+{
+    char name[configMAX_TASK_NAME_LEN];
+    uint32_t high_water_mark;
+} retained_log_stack_t;
+
+/* Details of the last fault. */
+typedef struct
+{
+    uint32_t type;                 /* retained_log_fault_type_t */
+    uint32_t tick;
+    uint32_t line;
+    char file[RETAINED_LOG_FILE_LENGTH];
+    char task_name[configMAX_TASK_NAME_LEN];
+    uint32_t free_heap;
+    uint32_t min_free_heap;
+    uint32_t stack_count;
+    retained_log_stack_t stacks[RETAINED_LOG_MAX_TASKS];
+} retained_log_fault_t;
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t size;
+    uint32_t boot_count;
+    uint32_t log_count;            /* Number of records written. Wraps around. */
+    retained_log_entry_t entries[RETAINED_LOG_ENTRIES];
+    retained_log_fault_t fault;
+    uint32_t magic_end;
+} retained_log_data_t;
+
+/* Output of a report line. Returns false if the line could not be sent. */
+typedef bool (*retained_log_output_t)(const char *line, void *context);
+
+static CY_NOINIT retained_log_data_t retained_log_data;
+
+/* Used to take the task states in the fault hooks, which may run on a small stack. */
+static TaskStatus_t retained_log_task_status[RETAINED_LOG_MAX_TASKS];
+
+/* Set while a crash report is pending, to keep the records that led to it. */
+static bool retained_log_hold = false;
+
+static uint32_t retained_log_reset_reason = 0;
+
+/* Set while the network stack is suspended. */
+static volatile bool retained_log_suspended = false;
+
+/* Log messages deferred while the network stack is suspended, each as printed
+ * and NUL terminated, and the number of messages which did not fit.
+ */
+static char retained_log_deferred[RETAINED_LOG_DEFERRED_SIZE];
+static uint32_t retained_log_deferred_used = 0;
+static uint32_t retained_log_deferred_dropped = 0;
+
+/*******************************************************************************
+ * Function definitions
+ ******************************************************************************/
+/*******************************************************************************
+* Function Name: retained_log_init
+********************************************************************************
+* Summary:
+*  Validates the retained data, and initializes it if it is not valid, such as
+*  after a power-on reset or a firmware update. This must be called before any
+*  log record is written.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void retained_log_init(void)
+{
+    retained_log_reset_reason = Cy_SysLib_GetResetReason();
+
+    if ((RETAINED_LOG_MAGIC != retained_log_data.magic) ||
+        (~RETAINED_LOG_MAGIC != retained_log_data.magic_end) ||
+        (sizeof(retained_log_data) != retained_log_data.size) ||
+        (RETAINED_LOG_MAX_TASKS < retained_log_data.fault.stack_count))
+    {
+        memset(&retained_log_data, 0, sizeof(retained_log_data));
+        retained_log_data.magic = RETAINED_LOG_MAGIC;
+        retained_log_data.size = sizeof(retained_log_data);
+        retained_log_data.magic_end = ~RETAINED_LOG_MAGIC;
+    }
+
+    retained_log_data.boot_count++;
+    retained_log_hold = (RETAINED_LOG_FAULT_NONE != retained_log_data.fault.type);
+}
+
+/*******************************************************************************
+* Function Name: retained_log_reserve
+********************************************************************************
+* Summary:
+*  Reserves the next log record. This can be called from any task or
+*  interrupt.
+*
+* Parameters:
+*  level : Log level of the record.
+*
+* Return:
+*  retained_log_entry_t *: Reserved record, or NULL if a crash report is
+*  pending.
+*
+*******************************************************************************/
+static retained_log_entry_t *retained_log_reserve(uint8_t level)
+{
+    retained_log_entry_t *entry = NULL;
+    BaseType_t in_isr = xPortIsInsideInterrupt();
+    UBaseType_t saved_interrupt_status = 0;
+
+    if (in_isr)
+    {
+        saved_interrupt_status = taskENTER_CRITICAL_FROM_ISR();
+    }
+    else
+    {
+        taskENTER_CRITICAL();
+    }
+
+    if (!retained_log_hold)
+    {
+        entry = &retained_log_data.entries[retained_log_data.log_count % RETAINED_LOG_ENTRIES];
+        retained_log_data.log_count++;
+        entry->tick = in_isr ? xTaskGetTickCountFromISR() : xTaskGetTickCount();
+        entry->level = level;
+        entry->record_words = 0;
+    }
+
+    if (in_isr)
+    {
+        taskEXIT_CRITICAL_FROM_ISR(saved_interrupt_status);
+    }
+    else
+    {
+        taskEXIT_CRITICAL();
+    }
+
+    return entry;
+}
+
+/*******************************************************************************
+* Function Name: retained_log_capture_record
+********************************************************************************
+* Summary:
+*  Copies a binary log record into the retained log, if its level is at or
+*  below RETAINED_LOG_CAPTURE_LEVEL. The record is kept as it is, without
+*  formatting, and is truncated to RETAINED_LOG_RECORD_WORDS. It is decoded on
+*  the host from the crash report. Used by the binary logger.
+*
+* Parameters:
+*  level  : Log level.
+*  record : Words of the binary record.
+*  words  : Size of the record in words.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void retained_log_capture_record(uint8_t level, const uint32_t *record, uint32_t words)
+{
+    retained_log_entry_t *entry;
+
+    if (RETAINED_LOG_CAPTURE_LEVEL < level)
+    {
+        return;
+    }
+
+    entry = retained_log_reserve(level);
+    if (NULL != entry)
+    {
+        words = (RETAINED_LOG_RECORD_WORDS < words) ? RETAINED_LOG_RECORD_WORDS : words;
+        memcpy(entry->record, record, words * sizeof(uint32_t));
+        entry->record_words = words;
+    }
+}
+
+/*******************************************************************************
+* Function Name: retained_log_defer
+********************************************************************************
+* Summary:
+*  Holds back a formatted log message while the network stack is suspended.
+*  The message is copied into the deferred message buffer, which is separate
+*  from the retained log, so it is neither truncated to
+*  RETAINED_LOG_TEXT_LENGTH nor lost while a crash report is pending. If the
+*  buffer is full, the message is dropped and counted.
+*
+* Parameters:
+*  line : Formatted message.
+*
+* Return:
+*  bool: true if the message was deferred or dropped, false if the network
+*  stack is not suspended and the message must be printed now.
+*
+*******************************************************************************/
+static bool retained_log_defer(const char *line)
+{
+    uint32_t length = (uint32_t)strlen(line) + 1;
+    bool deferred;
+
+    taskENTER_CRITICAL();
+
+    deferred = retained_log_suspended;
+    if (deferred)
+    {
+        if (length <= (sizeof(retained_log_deferred) - retained_log_deferred_used))
+        {
+            memcpy(&retained_log_deferred[retained_log_deferred_used], line, length);
+            retained_log_deferred_used += length;
+        }
+        else
+        {
+            retained_log_deferred_dropped++;
+        }
+    }
+
+    taskEXIT_CRITICAL();
+
+    return deferred;
+}
+
+/*******************************************************************************
+* Function Name: retained_log_print
+********************************************************************************
+* Summary:
+*  Formats a log message once, keeps it in the retained log if its level is at
+*  or below RETAINED_LOG_CAPTURE_LEVEL, and sends it to the logging task. Used
+*  by the text logging macros. While the network stack is suspended, a message
+*  less severe than APP_LOG_SUSPENDED_LEVEL is deferred with
+*  retained_log_defer() and sent on the next wake instead.
+*
+*  The message is formatted into a heap buffer, with the same prefix as the
+*  messages of vLoggingPrintf(), which keeps the line off the stack of the
+*  calling task. The formatted line is passed to vLoggingPrint(), which copies
+*  it into a buffer of its own for the logging task, so the message is copied
+*  once more, but not formatted a second time.
+*
+* Parameters:
+*  level : Log level.
+*  fmt   : printf style format string, including the level prefix.
+*  ...   : Arguments of the format string.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void retained_log_print(uint8_t level, const char *fmt, ...)
+{
+    retained_log_entry_t *entry;
+    char *line;
+    int prefix = 0;
+    va_list args;
+
+    line = pvPortMalloc(configLOGGING_MAX_MESSAGE_LENGTH);
+    if (NULL == line)
+    {
+        return;
+    }
+
+#if (configLOGGING_INCLUDE_TIME_AND_TASK_NAME == 1)
+    {
+        static uint32_t message_number = 0;
+        uint32_t number;
+
+        /* Taken in a critical section, as the messages of several tasks are numbered. */
+        taskENTER_CRITICAL();
+        number = message_number++;
+        taskEXIT_CRITICAL();
+
+        prefix = snprintf(line, configLOGGING_MAX_MESSAGE_LENGTH, "%lu %lu [%s] ",
+                          (unsigned long)number, (unsigned long)xTaskGetTickCount(),
+                          (taskSCHEDULER_NOT_STARTED != xTaskGetSchedulerState()) ? pcTaskGetName(NULL) : "None");
+        prefix = ((prefix < 0) || (prefix >= configLOGGING_MAX_MESSAGE_LENGTH)) ? 0 : prefix;
+    }
+#endif
+
+    va_start(args, fmt);
+    (void)vsnprintf(&line[prefix], configLOGGING_MAX_MESSAGE_LENGTH - prefix, fmt, args);
+    va_end(args);
+
+    if (RETAINED_LOG_CAPTURE_LEVEL >= level)
+    {
+        entry = retained_log_reserve(level);
+        if (NULL != entry)
+        {
+            strncpy(entry->text, &line[prefix], sizeof(entry->text) - 1);
+            entry->text[sizeof(entry->text) - 1] = '\0';
+        }
+    }
+
+    if ((APP_LOG_SUSPENDED_LEVEL >= level) || !retained_log_defer(line))
+    {
+        configPRINT(line);
+    }
+    vPortFree(line);
+}
+
+/*******************************************************************************
+* Function Name: retained_log_print_deferred
+********************************************************************************
+* Summary:
+*  Prints the log messages which were deferred while the network stack was
+*  suspended, in one burst, and empties the buffer. This must be called after
+*  retained_log_suspended has been cleared, so that no message is added.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void retained_log_print_deferred(void)
+{
+    uint32_t offset;
+    uint32_t dropped;
+
+    for (offset = 0; offset < retained_log_deferred_used;
+         offset += (uint32_t)strlen(&retained_log_deferred[offset]) + 1)
+    {
+        configPRINT(&retained_log_deferred[offset]);
+    }
+
+    taskENTER_CRITICAL();
+    dropped = retained_log_deferred_dropped;
+    retained_log_deferred_used = 0;
+    retained_log_deferred_dropped = 0;
+    taskEXIT_CRITICAL();
+
+    if (0 != dropped)
+    {
+        configPRINTF(("Info: %lu log messages were dropped while the network stack was suspended\n",
+                      (unsigned long)dropped));
+    }
+}
+
+/*******************************************************************************
+* Function Name: retained_log_set_network_suspended
+********************************************************************************
+* Summary:
+*  Sets the log policy for the network stack state. This is called by
+*  RunApplicationTask before the network stack is suspended, and after it has
+*  resumed. On resume, the deferred log messages are sent in one burst.
+*
+* Parameters:
+*  suspended : true before the network stack is suspended, false after it has
+*              resumed.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void retained_log_set_network_suspended(bool suspended)
+{
+    bool was_suspended;
+
+    taskENTER_CRITICAL();
+    was_suspended = retained_log_suspended;
+    retained_log_suspended = suspended;
+    taskEXIT_CRITICAL();
+
+    if (was_suspended && !suspended)
+    {
+        retained_log_print_deferred();
+    }
+
+#if APP_LOG_BINARY
+    app_log_set_deferred(suspended);
+#endif
+}
+
+/*******************************************************************************
+* Function Name: retained_log_copy_name
+********************************************************************************
+* Summary:
+*  Copies a string into a fixed size field, truncated and NUL terminated.
+*
+* Parameters:
+*  dest : Destination field.
+*  size : Size of the destination field.
+*  src  : Source string, or NULL for an empty string.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void retained_log_copy_name(char *dest, size_t size, const char *src)
+{
+    if (NULL == src)
+    {
+        src = "";
+    }
+
+    strncpy(dest, src, size - 1);
+    dest[size - 1] = '\0';
+}
+
+/*******************************************************************************
+* Function Name: retained_log_fault
+********************************************************************************
+* Summary:
+*  Records a fault with the free heap and, when called from a task, the stack
+*  high-water marks of all the tasks. This is called from the fault hooks. If
+*  RETAINED_LOG_RESET_ON_FAULT is enabled, the device is reset afterwards.
+*
+* Parameters:
+*  type      : Type of the fault.
+*  file      : Source file of a failed assert, or NULL.
+*  line      : Source line of a failed assert, or 0.
+*  task_name : Task in which the fault occurred, or NULL for the current task.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void retained_log_fault(retained_log_fault_type_t type, const char *file, uint32_t line, const char *task_name)
+{
+    retained_log_fault_t *fault = &retained_log_data.fault;
+    BaseType_t in_isr = xPortIsInsideInterrupt();
+    BaseType_t scheduler_started = (taskSCHEDULER_NOT_STARTED != xTaskGetSchedulerState());
+    const char *file_name = NULL;
+    UBaseType_t task_count = 0;
+    UBaseType_t index;
+
+    if (NULL != file)
+    {
+        file_name = strrchr(file, '/');
+        file_name = (NULL != file_name) ? (file_name + 1) : file;
+    }
+
+    if ((NULL == task_name) && scheduler_started)
+    {
+        task_name = pcTaskGetName(NULL);
+    }
+
+    fault->type = type;
+    fault->tick = in_isr ? xTaskGetTickCountFromISR() : xTaskGetTickCount();
+    fault->line = line;
+    retained_log_copy_name(fault->file, sizeof(fault->file), file_name);
+    retained_log_copy_name(fault->task_name, sizeof(fault->task_name), task_name);
+    fault->free_heap = xPortGetFreeHeapSize();
+    fault->min_free_heap = xPortGetMinimumEverFreeHeapSize();
+
+    /* The task states can not be taken from the stack overflow check, which
+     * runs in the context switch interrupt.
+     */
+    if (!in_isr && scheduler_started)
+    {
+        task_count = uxTaskGetSystemState(retained_log_task_status, RETAINED_LOG_MAX_TASKS, NULL);
+    }
+
+    for (index = 0; index < task_count; index++)
+    {
+        retained_log_copy_name(fault->stacks[index].name, sizeof(fault->stacks[index].name),
+                               retained_log_task_status[index].pcTaskName);
+        fault->stacks[index].high_water_mark = retained_log_task_status[index].usStackHighWaterMark;
+    }
+    fault->stack_count = task_count;
+
+#if RETAINED_LOG_RESET_ON_FAULT
+    NVIC_SystemReset();
+#endif
+}
+
+/*******************************************************************************
+* Function Name: retained_log_fault_print
+********************************************************************************
+* Summary:
+*  Prints a message of a fault hook directly to the debug UART. The logging
+*  macros allocate from the heap and queue the message to the logging task,
+*  which fails in the malloc failed hook and re-enters it, and does not work
+*  from an interrupt or with the interrupts disabled. This must be called
+*  after retained_log_fault(), so that the fault is recorded even if the
+*  message cannot be printed.
+*
+* Parameters:
+*  fmt : printf style format string.
+*  ... : Arguments of the format string.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void retained_log_fault_print(const char *fmt, ...)
+{
+    static char line[RETAINED_LOG_LINE_LENGTH];
+    size_t length;
+    va_list args;
+    int result;
+
+    va_start(args, fmt);
+    result = vsnprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+
+    if (0 < result)
+    {
+        length = ((size_t)result < sizeof(line)) ? (size_t)result : (sizeof(line) - 1);
+        (void)cyhal_uart_write(&cy_retarget_io_uart_obj, line, &length);
+    }
+}
+
+/*******************************************************************************
+* Function Name: retained_log_emit_report
+********************************************************************************
+* Summary:
+*  Writes the crash report line by line to the given output: the fault, the
+*  heap and stack usage at the time of the fault, and the retained log records
+*  from the oldest to the newest.
+*
+* Parameters:
+*  output  : Output of a report line.
+*  context : Context passed to the output.
+*
+* Return:
+*  bool: true if all the lines were written, false otherwise.
+*
+*******************************************************************************/
+static bool retained_log_emit_report(retained_log_output_t output, void *context)
+{
+    const retained_log_fault_t *fault = &retained_log_data.fault;
+    const retained_log_entry_t *entry;
+    char line[RETAINED_LOG_LINE_LENGTH];
+    uint32_t count;
+    uint32_t index;
+    uint32_t word;
+    int length;
+    bool result = true;
+
+    (void)snprintf(line, sizeof(line), "---- Crash report: boot %lu, reset reason 0x%08lx ----\n",
+                   (unsigned long)retained_log_data.boot_count, (unsigned long)retained_log_reset_reason);
+    result = result && output(line, context);
+
+    switch (fault->type)
+    {
+        case RETAINED_LOG_FAULT_ASSERT:
+            (void)snprintf(line, sizeof(line), "Fault: assert failed at %.*s:%lu in task %.*s, tick %lu\n",
+                           RETAINED_LOG_FILE_LENGTH, fault->file, (unsigned long)fault->line,
+                           configMAX_TASK_NAME_LEN, fault->task_name, (unsigned long)fault->tick);
+            break;
+
+        case RETAINED_LOG_FAULT_MALLOC:
+            (void)snprintf(line, sizeof(line), "Fault: heap allocation failed in task %.*s, tick %lu\n",
+                           configMAX_TASK_NAME_LEN, fault->task_name, (unsigned long)fault->tick);
+            break;
+
+        case RETAINED_LOG_FAULT_STACK_OVERFLOW:
+            (void)snprintf(line, sizeof(line), "Fault: stack overflow in task %.*s, tick %lu\n",
+                           configMAX_TASK_NAME_LEN, fault->task_name, (unsigned long)fault->tick);
+            break;
+
+        default:
+            (void)snprintf(line, sizeof(line), "Fault: none\n");
+            break;
+    }
+    result = result && output(line, context);
+
+    (void)snprintf(line, sizeof(line), "Heap: %lu bytes free, %lu bytes minimum ever free\n",
+                   (unsigned long)fault->free_heap, (unsigned long)fault->min_free_heap);
+    result = result && output(line, context);
+
+    for (index = 0; index < fault->stack_count; index++)
+    {
+        (void)snprintf(line, sizeof(line), "Stack high-water mark: %-*.*s %lu words\n",
+                       configMAX_TASK_NAME_LEN, configMAX_TASK_NAME_LEN, fault->stacks[index].name,
+                       (unsigned long)fault->stacks[index].high_water_mark);
+        result = result && output(line, context);
+    }
+
+    count = (retained_log_data.log_count < RETAINED_LOG_ENTRIES) ? retained_log_data.log_count : RETAINED_LOG_ENTRIES;
+    for (index = retained_log_data.log_count - count; index != retained_log_data.log_count; index++)
+    {
+        entry = &retained_log_data.entries[index % RETAINED_LOG_ENTRIES];
+
+        /* A binary record is printed in hexadecimal, for app_log_decode.py. */
+        if (0 != entry->record_words)
+        {
+            length = snprintf(line, sizeof(line), "Log: %lu bin ", (unsigned long)entry->tick);
+            for (word = 0; (word < entry->record_words) && (word < RETAINED_LOG_RECORD_WORDS); word++)
+            {
+                length += snprintf(&line[length], sizeof(line) - length, "%08lx", (unsigned long)entry->record[word]);
+            }
+            (void)snprintf(&line[length], sizeof(line) - length, "\n");
+            result = result && output(line, context);
+            continue;
+        }
+
+        length = snprintf(line, sizeof(line), "Log: %lu %.*s", (unsigned long)entry->tick,
+                          RETAINED_LOG_TEXT_LENGTH, entry->text);
+
+        /* Records truncated to RETAINED_LOG_TEXT_LENGTH lose their line end. */
+        if ((length > 0) && (length < (int)(sizeof(line) - 1)) && ('\n' != line[length - 1]))
+        {
+            line[length] = '\n';
+            line[length + 1] = '\0';
+        }
+        result = result && output(line, context);
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+* Function Name: retained_log_output_uart
+********************************************************************************
+* Summary:
+*  Sends a report line to the logging task.
+*
+* Parameters:
+*  line    : Report line.
+*  context : Unused.
+*
+* Return:
+*  bool: Always true.
+*
+*******************************************************************************/
+static bool retained_log_output_uart(const char *line, void *context)
+{
+    (void)context;
+
+    configPRINTF(("%s", line));
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: retained_log_output_socket
+********************************************************************************
+* Summary:
+*  Sends a report line on a TCP socket.
+*
+* Parameters:
+*  line    : Report line.
+*  context : Socket_t on which the line is sent.
+*
+* Return:
+*  bool: true if the whole line was sent, false otherwise.
+*
+*******************************************************************************/
+static bool retained_log_output_socket(const char *line, void *context)
+{
+    size_t length = strlen(line);
+
+    return ((int32_t)length == SOCKETS_Send((Socket_t)context, line, length, 0));
+}
+
+/*******************************************************************************
+* Function Name: retained_log_has_report
+********************************************************************************
+* Summary:
+*  Checks whether a crash report from a previous boot is pending.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  bool: true if a crash report is pending, false otherwise.
+*
+*******************************************************************************/
+bool retained_log_has_report(void)
+{
+    return (RETAINED_LOG_FAULT_NONE != retained_log_data.fault.type);
+}
+
+/*******************************************************************************
+* Function Name: retained_log_print_report
+********************************************************************************
+* Summary:
+*  Prints the pending crash report on the serial terminal. The report is kept
+*  until it is sent over the network or cleared.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void retained_log_print_report(void)
+{
+    if (retained_log_has_report())
+    {
+        (void)retained_log_emit_report(retained_log_output_uart, NULL);
+    }
+}
+
+/*******************************************************************************
+* Function Name: retained_log_send_report
+********************************************************************************
+* Summary:
+*  Sends the pending crash report on a connected TCP socket, and clears it once
+*  it has been sent.
+*
+* Parameters:
+*  socket : Connected TCP socket.
+*
+* Return:
+*  bool: true if a report was sent, false if none was pending or the send
+*  failed.
+*
+*******************************************************************************/
+bool retained_log_send_report(Socket_t socket)
+{
+    if (!retained_log_has_report() || !retained_log_emit_report(retained_log_output_socket, (void *)socket))
+    {
+        return false;
+    }
+
+    APP_INFO(("Crash report sent to the TCP server.\n"));
+    retained_log_clear();
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: retained_log_clear
+********************************************************************************
+* Summary:
+*  Clears the pending crash report, so that the retained log records new log
+*  records again.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void retained_log_clear(void)
+{
+    taskENTER_CRITICAL();
+    retained_log_data.fault.type = RETAINED_LOG_FAULT_NONE;
+    retained_log_hold = false;
+    taskEXIT_CRITICAL();
+}
+
+
+/* [] END OF FILE */
+
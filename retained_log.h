@@ -0,0 +1,97 @@
+/******************************************************************************
+* File Name: retained_log.h
+*
+* Description: This file contains the interface of the retained log which
+* keeps the last log records and the crash information in RAM that is not
+* initialized at startup.
+*
+******************************************************************************
+* Copyright (2020), Cypress Semiconductor Corporation.
+******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death (“High Risk Product”). By
+* including Cypress’s product in a High Risk Product, the manufacturer of such
+* system or application assumes all risk of such use and in doing so agrees to
+* indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef _RETAINED_LOG_H_
+#define _RETAINED_LOG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "iot_secure_sockets.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Number of log records kept, and the maximum length of each record. */
+#define RETAINED_LOG_ENTRIES                 (16)
+#define RETAINED_LOG_TEXT_LENGTH             (96)
+
+/* Size in bytes of the buffer which holds the log messages deferred while the
+ * network stack is suspended. The messages are kept as they are printed.
+ */
+#define RETAINED_LOG_DEFERRED_SIZE           (2048)
+
+/* Maximum number of tasks for which the stack high-water mark is kept. */
+#define RETAINED_LOG_MAX_TASKS               (16)
+
+/* Maximum length of the source file name of a failed assert. */
+#define RETAINED_LOG_FILE_LENGTH             (48)
+
+/*******************************************************************************
+ * Type Definitions
+ ******************************************************************************/
+typedef enum
+{
+    RETAINED_LOG_FAULT_NONE = 0,
+    RETAINED_LOG_FAULT_ASSERT,
+    RETAINED_LOG_FAULT_MALLOC,
+    RETAINED_LOG_FAULT_STACK_OVERFLOW
+} retained_log_fault_type_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+void retained_log_init(void);
+void retained_log_print(uint8_t level, const char *fmt, ...);
+void retained_log_capture_record(uint8_t level, const uint32_t *record, uint32_t words);
+void retained_log_set_network_suspended(bool suspended);
+void retained_log_fault(retained_log_fault_type_t type, const char *file, uint32_t line, const char *task_name);
+void retained_log_fault_print(const char *fmt, ...);
+bool retained_log_has_report(void);
+void retained_log_print_report(void);
+bool retained_log_send_report(Socket_t socket);
+void retained_log_clear(void);
+
+#endif /* _RETAINED_LOG_H_ */
+
+
+/* [] END OF FILE */
+
@@ -0,0 +1,610 @@
+/*******************************************************************************
+ * File Name:   shadow_client.c
+ *
+ * Description: This file contains a Device Shadow client on the MQTT client.
+ * The application reports each field of the shadow on its own, whenever it
+ * likes. A field is marked dirty only when its value has changed since it was
+ * last reported, and the dirty fields are sent together in one update document
+ * by the wake scheduler, SHADOW_CLIENT_UPDATE_DELAY_MS after the first change.
+ * The fields which change during one host wake therefore cost one update, and
+ * the unchanged fields are not sent at all.
+ *
+ * The delta documents are parsed in a single pass over the payload, without a
+ * token array: each top-level field of the "state" object is passed to the
+ * delta handler of the application as soon as it is scanned.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+
+/* Include header files */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "mqtt_client.h"
+#include "mqtt_batch.h"
+#include "shadow_client.h"
+#include "wake_scheduler.h"
+#include "wifi_config.h"
+
+#if MQTT_CLIENT && SHADOW_CLIENT
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define SHADOW_CLIENT_UPDATE_TOPIC           "$aws/things/" SHADOW_CLIENT_THING_NAME "/shadow/update"
+
+#define SHADOW_CLIENT_DOCUMENT_HEAD          "{\"state\":{\"reported\":{"
+#define SHADOW_CLIENT_DOCUMENT_TAIL          "}}}"
+
+#define SHADOW_CLIENT_TICKS_TO_MS(ticks)     ((uint32_t)(ticks) * portTICK_PERIOD_MS)
+
+/*******************************************************************************
+ * Static Global Structures and variables
+ ******************************************************************************/
+/* Reported field of the shadow. */
+typedef struct
+{
+    const char *name;
+    char value[SHADOW_CLIENT_VALUE_SIZE];  /* JSON text of the last reported value. */
+    bool dirty;                            /* Changed since the last update. */
+} shadow_client_field_t;
+
+/* Runtime state of the shadow client. */
+typedef struct
+{
+    shadow_client_field_t fields[SHADOW_CLIENT_MAX_FIELDS];
+    uint32_t count;
+    uint32_t dirty;                    /* Number of dirty fields. */
+    TickType_t deadline;               /* Time of the next update, if a field is dirty. */
+    shadow_client_delta_handler_t handler;
+    SemaphoreHandle_t mutex;
+} shadow_client_t;
+
+static shadow_client_t shadow_client;
+static char shadow_client_document[SHADOW_CLIENT_DOCUMENT_SIZE];
+
+/*******************************************************************************
+ * Function definitions
+ ******************************************************************************/
+/*******************************************************************************
+* Function Name: shadow_client_log_delta
+********************************************************************************
+* Summary:
+*  Default delta handler, which prints each field of the delta.
+*
+* Parameters:
+*  name         : Field name.
+*  name_length  : Length of the field name.
+*  type         : JSON type of the value.
+*  value        : Value.
+*  value_length : Length of the value.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void shadow_client_log_delta(const char *name, uint16_t name_length, shadow_client_value_t type,
+                                    const char *value, uint16_t value_length)
+{
+    (void)type;
+
+    APP_INFO(("Shadow delta: %.*s = %.*s\n", (int)name_length, name, (int)value_length, value));
+}
+
+/*******************************************************************************
+* Function Name: shadow_client_init
+********************************************************************************
+* Summary:
+*  Initializes the shadow client.
+*
+* Parameters:
+*  handler : Called for each field of a received delta. NULL prints the fields.
+*
+* Return:
+*  cy_rslt_t: Returns CY_RSLT_SUCCESS if the client is initialized.
+*  Otherwise, it returns CY_RSLT_TYPE_ERROR.
+*
+*******************************************************************************/
+cy_rslt_t shadow_client_init(shadow_client_delta_handler_t handler)
+{
+    shadow_client.count = 0;
+    shadow_client.dirty = 0;
+    shadow_client.handler = (NULL != handler) ? handler : shadow_client_log_delta;
+    shadow_client.mutex = xSemaphoreCreateMutex();
+
+    return (NULL != shadow_client.mutex) ? CY_RSLT_SUCCESS : CY_RSLT_TYPE_ERROR;
+}
+
+/*******************************************************************************
+* Function Name: shadow_client_report
+********************************************************************************
+* Summary:
+*  Stores the JSON text of a reported value, and marks the field dirty if the
+*  value has changed. The first dirty field schedules the next update, and
+*  resumes the network stack in time for it if it is suspended until later.
+*
+* Parameters:
+*  name  : Field name. Must remain valid, such as a string literal.
+*  value : JSON text of the value.
+*
+* Return:
+*  cy_rslt_t: Returns CY_RSLT_SUCCESS if the value is stored. Otherwise, it
+*  returns CY_RSLT_TYPE_ERROR.
+*
+*******************************************************************************/
+static cy_rslt_t shadow_client_report(const char *name, const char *value)
+{
+    shadow_client_field_t *field = NULL;
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+    bool scheduled = false;
+    uint32_t index;
+
+    (void)xSemaphoreTake(shadow_client.mutex, portMAX_DELAY);
+
+    for (index = 0; index < shadow_client.count; index++)
+    {
+        if (0 == strcmp(shadow_client.fields[index].name, name))
+        {
+            field = &shadow_client.fields[index];
+            break;
+        }
+    }
+
+    if ((NULL == field) && (shadow_client.count < SHADOW_CLIENT_MAX_FIELDS))
+    {
+        field = &shadow_client.fields[shadow_client.count++];
+        field->name = name;
+        field->value[0] = '\0';
+        field->dirty = false;
+    }
+
+    if (NULL == field)
+    {
+        ERR_INFO(("Too many shadow fields, %s is not reported.\n", name));
+        result = CY_RSLT_TYPE_ERROR;
+    }
+    else if (0 != strcmp(field->value, value))
+    {
+        (void)strcpy(field->value, value);
+
+        if (!field->dirty)
+        {
+            field->dirty = true;
+            if (0 == shadow_client.dirty++)
+            {
+                shadow_client.deadline = xTaskGetTickCount() + pdMS_TO_TICKS(SHADOW_CLIENT_UPDATE_DELAY_MS);
+                scheduled = true;
+            }
+        }
+    }
+
+    (void)xSemaphoreGive(shadow_client.mutex);
+
+    /* The network stack may be suspended until a later deadline. */
+    if (scheduled)
+    {
+        wake_sched_kick(SHADOW_CLIENT_UPDATE_DELAY_MS);
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+* Function Name: shadow_client_report_int
+********************************************************************************
+* Summary:
+*  Reports an integer field. It is sent with the next update if its value has
+*  changed.
+*
+* Parameters:
+*  name  : Field name. Must remain valid, such as a string literal.
+*  value : Value.
+*
+* Return:
+*  cy_rslt_t: Returns CY_RSLT_SUCCESS if the value is stored. Otherwise, it
+*  returns CY_RSLT_TYPE_ERROR.
+*
+*******************************************************************************/
+cy_rslt_t shadow_client_report_int(const char *name, int32_t value)
+{
+    char text[SHADOW_CLIENT_VALUE_SIZE];
+
+    (void)snprintf(text, sizeof(text), "%ld", (long)value);
+
+    return shadow_client_report(name, text);
+}
+
+/*******************************************************************************
+* Function Name: shadow_client_report_bool
+********************************************************************************
+* Summary:
+*  Reports a boolean field. It is sent with the next update if its value has
+*  changed.
+*
+* Parameters:
+*  name  : Field name. Must remain valid, such as a string literal.
+*  value : Value.
+*
+* Return:
+*  cy_rslt_t: Returns CY_RSLT_SUCCESS if the value is stored. Otherwise, it
+*  returns CY_RSLT_TYPE_ERROR.
+*
+*******************************************************************************/
+cy_rslt_t shadow_client_report_bool(const char *name, bool value)
+{
+    return shadow_client_report(name, value ? "true" : "false");
+}
+
+/*******************************************************************************
+* Function Name: shadow_client_report_string
+********************************************************************************
+* Summary:
+*  Reports a string field. It is sent with the next update if its value has
+*  changed. Quotes and backslashes are escaped. Control characters are not
+*  supported.
+*
+* Parameters:
+*  name  : Field name. Must remain valid, such as a string literal.
+*  value : Value.
+*
+* Return:
+*  cy_rslt_t: Returns CY_RSLT_SUCCESS if the value is stored. Otherwise, it
+*  returns CY_RSLT_TYPE_ERROR, such as if the quoted value does not fit into
+*  SHADOW_CLIENT_VALUE_SIZE.
+*
+*******************************************************************************/
+cy_rslt_t shadow_client_report_string(const char *name, const char *value)
+{
+    char text[SHADOW_CLIENT_VALUE_SIZE];
+    uint32_t used = 0;
+
+    text[used++] = '"';
+
+    for (; '\0' != *value; value++)
+    {
+        /* Leaves room for the escape, the closing quote, and the NUL. */
+        if (((uint8_t)*value < 0x20) || ((used + 4) > sizeof(text)))
+        {
+            return CY_RSLT_TYPE_ERROR;
+        }
+
+        if (('"' == *value) || ('\\' == *value))
+        {
+            text[used++] = '\\';
+        }
+        text[used++] = *value;
+    }
+
+    text[used++] = '"';
+    text[used] = '\0';
+
+    return shadow_client_report(name, text);
+}
+
+/*******************************************************************************
+* Function Name: shadow_client_update
+********************************************************************************
+* Summary:
+*  Sends the dirty fields in one update document to the reported state of the
+*  shadow. If they do not all fit into SHADOW_CLIENT_DOCUMENT_SIZE, further
+*  documents are sent. A field is marked clean only once its document has been
+*  sent, and the update is retried after SHADOW_CLIENT_UPDATE_DELAY_MS if the
+*  send fails. This is run by the wake scheduler in a shared host wake window.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void shadow_client_update(void)
+{
+    uint8_t included[SHADOW_CLIENT_MAX_FIELDS];
+    shadow_client_field_t *field;
+    uint32_t fields;
+    uint32_t index;
+    cy_rslt_t result;
+    int length;
+    int used;
+
+    (void)xSemaphoreTake(shadow_client.mutex, portMAX_DELAY);
+
+    while (0 != shadow_client.dirty)
+    {
+        used = snprintf(shadow_client_document, sizeof(shadow_client_document), SHADOW_CLIENT_DOCUMENT_HEAD);
+        fields = 0;
+
+        for (index = 0; index < shadow_client.count; index++)
+        {
+            field = &shadow_client.fields[index];
+            if (!field->dirty)
+            {
+                continue;
+            }
+
+            length = snprintf(&shadow_client_document[used], sizeof(shadow_client_document) - used, "%s\"%s\":%s",
+                              (0 != fields) ? "," : "", field->name, field->value);
+            if ((used + length + sizeof(SHADOW_CLIENT_DOCUMENT_TAIL)) > sizeof(shadow_client_document))
+            {
+                /* Sent with the next document. */
+                continue;
+            }
+
+            used += length;
+            included[fields++] = (uint8_t)index;
+        }
+
+        if (0 == fields)
+        {
+            ERR_INFO(("A shadow field does not fit into the update document.\n"));
+            break;
+        }
+
+        (void)strcpy(&shadow_client_document[used], SHADOW_CLIENT_DOCUMENT_TAIL);
+        used += sizeof(SHADOW_CLIENT_DOCUMENT_TAIL) - 1;
+
+#if MQTT_BATCH
+        /* Without delay, so that the messages queued before go out in the same send. */
+        result = mqtt_batch_publish(SHADOW_CLIENT_UPDATE_TOPIC, shadow_client_document, (uint32_t)used,
+                                    MQTT_CLIENT_QOS1, 0);
+#else
+        result = mqtt_client_publish(SHADOW_CLIENT_UPDATE_TOPIC, shadow_client_document, (uint32_t)used,
+                                     MQTT_CLIENT_QOS1);
+#endif
+        if (CY_RSLT_SUCCESS != result)
+        {
+            ERR_INFO(("Failed to send the shadow update.\n"));
+            shadow_client.deadline = xTaskGetTickCount() + pdMS_TO_TICKS(SHADOW_CLIENT_UPDATE_DELAY_MS);
+            break;
+        }
+
+        for (index = 0; index < fields; index++)
+        {
+            shadow_client.fields[included[index]].dirty = false;
+        }
+        shadow_client.dirty -= fields;
+    }
+
+    (void)xSemaphoreGive(shadow_client.mutex);
+}
+
+/*******************************************************************************
+* Function Name: shadow_client_get_next_update_ms
+********************************************************************************
+* Summary:
+*  Returns the time until the next update is due. The network stack must not
+*  stay suspended longer than this.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  uint32_t: Time in milliseconds until the update is due, or portMAX_DELAY if
+*  no field is dirty.
+*
+*******************************************************************************/
+uint32_t shadow_client_get_next_update_ms(void)
+{
+    int32_t remaining;
+    uint32_t next_ms = portMAX_DELAY;
+
+    (void)xSemaphoreTake(shadow_client.mutex, portMAX_DELAY);
+
+    if (0 != shadow_client.dirty)
+    {
+        remaining = (int32_t)(shadow_client.deadline - xTaskGetTickCount());
+        next_ms = (remaining <= 0) ? 0 : SHADOW_CLIENT_TICKS_TO_MS(remaining);
+    }
+
+    (void)xSemaphoreGive(shadow_client.mutex);
+
+    return next_ms;
+}
+
+/*******************************************************************************
+* Function Name: shadow_client_parse_delta
+********************************************************************************
+* Summary:
+*  Scans a delta document once, from start to end, and passes each top-level
+*  field of its "state" object to the handler as soon as it is scanned. Only
+*  the nesting depth, the depth of the "state" object, and the last key are
+*  kept, so the document may have any number of fields. The fields scanned
+*  before a syntax error have already been passed to the handler.
+*
+* Parameters:
+*  document : Delta document.
+*  length   : Length of the document.
+*  handler  : Called for each field.
+*
+* Return:
+*  bool: true if the document is well formed, false otherwise.
+*
+*******************************************************************************/
+bool shadow_client_parse_delta(const char *document, uint32_t length, shadow_client_delta_handler_t handler)
+{
+    const char *key = NULL;
+    const char *value;
+    uint32_t key_length = 0;
+    uint32_t value_length;
+    uint32_t depth = 0;
+    uint32_t state_depth = 0;          /* Depth of the "state" object, 0 outside of it. */
+    uint32_t position = 0;
+    uint32_t start;
+    shadow_client_value_t type;
+
+    while (position < length)
+    {
+        switch (document[position])
+        {
+            case '{':
+            case '[':
+                depth++;
+                if (('{' == document[position]) && (2 == depth) && (5 == key_length) &&
+                    (NULL != key) && (0 == memcmp(key, "state", 5)))
+                {
+                    state_depth = depth;
+                }
+                key = NULL;
+                position++;
+                continue;
+
+            case '}':
+            case ']':
+                if (0 == depth)
+                {
+                    return false;
+                }
+                if (depth == state_depth)
+                {
+                    state_depth = 0;
+                }
+                depth--;
+                key = NULL;
+                position++;
+                continue;
+
+            case ',':
+                key = NULL;
+                position++;
+                continue;
+
+            case ':':
+            case ' ':
+            case '\t':
+            case '\r':
+            case '\n':
+                position++;
+                continue;
+
+            case '"':
+                start = ++position;
+                while ((position < length) && ('"' != document[position]))
+                {
+                    /* Skips the escaped character. */
+                    position += ('\\' == document[position]) ? 2 : 1;
+                }
+                if (position >= length)
+                {
+                    return false;
+                }
+
+                value = &document[start];
+                value_length = position - start;
+                position++;
+
+                while ((position < length) && (NULL != strchr(" \t\r\n", document[position])) &&
+                       ('\0' != document[position]))
+                {
+                    position++;
+                }
+                if ((position < length) && (':' == document[position]))
+                {
+                    key = value;
+                    key_length = value_length;
+                    position++;
+                    continue;
+                }
+                type = SHADOW_CLIENT_VALUE_STRING;
+                break;
+
+            default:
+                start = position;
+                while ((position < length) && (NULL == strchr(",}] \t\r\n", document[position])))
+                {
+                    position++;
+                }
+                if (position == start)
+                {
+                    return false;
+                }
+
+                value = &document[start];
+                value_length = position - start;
+                type = ('n' == *value) ? SHADOW_CLIENT_VALUE_NULL :
+                       (('t' == *value) || ('f' == *value)) ? SHADOW_CLIENT_VALUE_BOOL : SHADOW_CLIENT_VALUE_NUMBER;
+                break;
+        }
+
+        if ((0 != state_depth) && (depth == state_depth) && (NULL != key))
+        {
+            handler(key, (uint16_t)key_length, type, value, (uint16_t)value_length);
+        }
+        key = NULL;
+    }
+
+    return (0 == depth);
+}
+
+/*******************************************************************************
+* Function Name: shadow_client_handle_publish
+********************************************************************************
+* Summary:
+*  Publish handler of the MQTT client. Passes the fields of the deltas on
+*  SHADOW_CLIENT_DELTA_TOPIC to the delta handler, and prints the messages on
+*  other topics.
+*
+* Parameters:
+*  topic          : Topic name, not NUL terminated.
+*  topic_length   : Length of the topic name.
+*  payload        : Message payload.
+*  payload_length : Length of the payload.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void shadow_client_handle_publish(const char *topic, uint16_t topic_length,
+                                  const uint8_t *payload, uint32_t payload_length)
+{
+    if ((topic_length != (sizeof(SHADOW_CLIENT_DELTA_TOPIC) - 1)) ||
+        (0 != memcmp(topic, SHADOW_CLIENT_DELTA_TOPIC, topic_length)))
+    {
+        APP_INFO(("MQTT message on %.*s, %lu bytes\n", (int)topic_length, topic, (unsigned long)payload_length));
+        return;
+    }
+
+    if (!shadow_client_parse_delta((const char *)payload, payload_length, shadow_client.handler))
+    {
+        ERR_INFO(("Malformed shadow delta document.\n"));
+    }
+}
+
+#endif /* MQTT_CLIENT && SHADOW_CLIENT */
+
+
+/* [] END OF FILE */
+
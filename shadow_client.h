@@ -0,0 +1,95 @@
+/******************************************************************************
+* File Name: shadow_client.h
+*
+* Description: This file contains the interface of the Device Shadow client
+* which reports the changed fields only and applies the received deltas.
+*
+******************************************************************************
+* Copyright (2020), Cypress Semiconductor Corporation.
+******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death (“High Risk Product”). By
+* including Cypress’s product in a High Risk Product, the manufacturer of such
+* system or application assumes all risk of such use and in doing so agrees to
+* indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef _SHADOW_CLIENT_H_
+#define _SHADOW_CLIENT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_result.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Time for which the network stack is kept resumed after an update, for the
+ * PUBACK.
+ */
+#define SHADOW_CLIENT_UPDATE_HOLD_MS         (500UL)
+
+/*******************************************************************************
+ * Type Definitions
+ ******************************************************************************/
+/* JSON type of a delta value. */
+typedef enum
+{
+    SHADOW_CLIENT_VALUE_NUMBER,
+    SHADOW_CLIENT_VALUE_BOOL,
+    SHADOW_CLIENT_VALUE_STRING,
+    SHADOW_CLIENT_VALUE_NULL
+} shadow_client_value_t;
+
+/* Called for each top-level field of the "state" object of a received delta
+ * document. Neither the name nor the value is NUL terminated. A string value
+ * is passed without the quotes, and with its escape sequences as received.
+ * Nested objects and arrays are not passed. Both buffers are valid only during
+ * the call.
+ */
+typedef void (*shadow_client_delta_handler_t)(const char *name, uint16_t name_length, shadow_client_value_t type,
+                                              const char *value, uint16_t value_length);
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+cy_rslt_t shadow_client_init(shadow_client_delta_handler_t handler);
+cy_rslt_t shadow_client_report_int(const char *name, int32_t value);
+cy_rslt_t shadow_client_report_bool(const char *name, bool value);
+cy_rslt_t shadow_client_report_string(const char *name, const char *value);
+void shadow_client_handle_publish(const char *topic, uint16_t topic_length,
+                                  const uint8_t *payload, uint32_t payload_length);
+bool shadow_client_parse_delta(const char *document, uint32_t length, shadow_client_delta_handler_t handler);
+void shadow_client_update(void);
+uint32_t shadow_client_get_next_update_ms(void);
+
+#endif /* _SHADOW_CLIENT_H_ */
+
+
+/* [] END OF FILE */
+
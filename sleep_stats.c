@@ -0,0 +1,351 @@
+/*******************************************************************************
+ * File Name:   sleep_stats.c
+ *
+ * Description: This file contains the sleep residency accounting. It measures
+ * the time the PSoC 6 MCU spends in active, sleep, and deep sleep modes with a
+ * low-power timer, which keeps counting in deep sleep, and counts the deep sleep
+ * entries and the reasons deep sleep was not entered. The sleep residency is
+ * measured from the HAL system power management callbacks around each
+ * transition, so it does not need a current probe.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+
+/* Include header files */
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdbool.h>
+#include <string.h>
+
+/* BSP & HAL includes. */
+#include "cyhal.h"
+
+#include "sleep_stats.h"
+#include "wifi_config.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define SLEEP_STATS_TICKS_TO_MS(ticks)       (((ticks) * 1000ULL) / SLEEP_STATS_LPTIMER_HZ)
+
+/*******************************************************************************
+ * Static Global Structures and variables
+ ******************************************************************************/
+/* Runtime state of the sleep accounting. The timer counts are extended to 64
+ * bits from sleep_stats_init(), so that the totals do not wrap.
+ */
+typedef struct
+{
+    uint32_t last_count;           /* Last low-power timer count read. */
+    uint64_t now;                  /* Extended count at last_count. */
+    uint64_t entered;              /* Extended count at the last sleep entry. */
+    uint64_t sleep_ticks;
+    uint64_t deepsleep_ticks;
+    uint32_t sleep_entries;
+    uint32_t deepsleep_entries;
+    uint32_t deepsleep_refused;
+    uint32_t deepsleep_skipped;
+    bool deepsleep_attempted;      /* Deep sleep was checked since the last transition. */
+} sleep_stats_state_t;
+
+static sleep_stats_state_t sleep_stats;
+static cyhal_lptimer_t sleep_stats_timer;
+static bool sleep_stats_ready = false;
+
+static bool sleep_stats_syspm_callback(cyhal_syspm_callback_state_t state,
+                                       cyhal_syspm_callback_mode_t mode, void *callback_arg);
+
+static cyhal_syspm_callback_data_t sleep_stats_syspm_data =
+{
+    .callback = sleep_stats_syspm_callback,
+    .states = (cyhal_syspm_callback_state_t)(CYHAL_SYSPM_CB_CPU_SLEEP | CYHAL_SYSPM_CB_CPU_DEEPSLEEP),
+    .ignore_modes = (cyhal_syspm_callback_mode_t)0,
+    .args = NULL,
+    .next = NULL,
+};
+
+/*******************************************************************************
+ * Function definitions
+ ******************************************************************************/
+/*******************************************************************************
+* Function Name: sleep_stats_update_now
+********************************************************************************
+* Summary:
+*  Reads the low-power timer and extends the count to 64 bits. Must be called
+*  with interrupts masked, and at least once per timer wrap (36 hours).
+*
+* Parameters:
+*  void
+*
+* Return:
+*  uint64_t: Extended timer count.
+*
+*******************************************************************************/
+static uint64_t sleep_stats_update_now(void)
+{
+    uint32_t count = cyhal_lptimer_read(&sleep_stats_timer);
+
+    sleep_stats.now += (uint32_t)(count - sleep_stats.last_count);
+    sleep_stats.last_count = count;
+
+    return sleep_stats.now;
+}
+
+/*******************************************************************************
+* Function Name: sleep_stats_syspm_callback
+********************************************************************************
+* Summary:
+*  System power management callback. Timestamps the entry to sleep and deep
+*  sleep, adds the time spent in the mode on exit, and counts the deep sleep
+*  attempts refused by a driver. Called by the idle task, with interrupts
+*  disabled.
+*
+* Parameters:
+*  state        : Power mode of the transition.
+*  mode         : Phase of the transition.
+*  callback_arg : Unused.
+*
+* Return:
+*  bool: Always true. The transition is never refused.
+*
+*******************************************************************************/
+static bool sleep_stats_syspm_callback(cyhal_syspm_callback_state_t state,
+                                       cyhal_syspm_callback_mode_t mode, void *callback_arg)
+{
+    bool deepsleep = (CYHAL_SYSPM_CB_CPU_DEEPSLEEP == state);
+
+    (void)callback_arg;
+
+    switch (mode)
+    {
+        case CYHAL_SYSPM_CHECK_READY:
+            if (deepsleep)
+            {
+                sleep_stats.deepsleep_attempted = true;
+            }
+            break;
+
+        case CYHAL_SYSPM_CHECK_FAIL:
+            if (deepsleep)
+            {
+                sleep_stats.deepsleep_refused++;
+            }
+            break;
+
+        case CYHAL_SYSPM_BEFORE_TRANSITION:
+            if (!deepsleep && !sleep_stats.deepsleep_attempted)
+            {
+                sleep_stats.deepsleep_skipped++;
+            }
+            sleep_stats.deepsleep_attempted = false;
+            sleep_stats.entered = sleep_stats_update_now();
+            break;
+
+        case CYHAL_SYSPM_AFTER_TRANSITION:
+            if (deepsleep)
+            {
+                sleep_stats.deepsleep_ticks += sleep_stats_update_now() - sleep_stats.entered;
+                sleep_stats.deepsleep_entries++;
+            }
+            else
+            {
+                sleep_stats.sleep_ticks += sleep_stats_update_now() - sleep_stats.entered;
+                sleep_stats.sleep_entries++;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    return true;
+}
+
+/*******************************************************************************
+* Function Name: sleep_stats_init
+********************************************************************************
+* Summary:
+*  Starts the low-power timer used as the timebase, and registers the system
+*  power management callback. The accounting starts from this call.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  cy_rslt_t: Returns CY_RSLT_SUCCESS if the accounting is started, an error
+*  code otherwise.
+*
+*******************************************************************************/
+cy_rslt_t sleep_stats_init(void)
+{
+    cy_rslt_t result;
+
+    /* The tickless idle uses another low-power timer instance. */
+    result = cyhal_lptimer_init(&sleep_stats_timer);
+    if (CY_RSLT_SUCCESS != result)
+    {
+        return result;
+    }
+
+    sleep_stats.last_count = cyhal_lptimer_read(&sleep_stats_timer);
+    cyhal_syspm_register_callback(&sleep_stats_syspm_data);
+    sleep_stats_ready = true;
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: sleep_stats_on_idle
+********************************************************************************
+* Summary:
+*  Keeps the timer count extension up to date. This is called from the idle
+*  hook, which runs before every sleep attempt.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void sleep_stats_on_idle(void)
+{
+    if (sleep_stats_ready)
+    {
+        taskENTER_CRITICAL();
+        (void)sleep_stats_update_now();
+        taskEXIT_CRITICAL();
+    }
+}
+
+/*******************************************************************************
+* Function Name: sleep_stats_read_timer
+********************************************************************************
+* Summary:
+*  Returns the raw count of the low-power timer. It keeps counting in deep
+*  sleep, so it is also used as the FreeRTOS run-time stats timebase.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  uint32_t: Timer count at SLEEP_STATS_LPTIMER_HZ, or 0 if the accounting is
+*  not started.
+*
+*******************************************************************************/
+uint32_t sleep_stats_read_timer(void)
+{
+    return sleep_stats_ready ? cyhal_lptimer_read(&sleep_stats_timer) : 0;
+}
+
+/*******************************************************************************
+* Function Name: sleep_stats_get
+********************************************************************************
+* Summary:
+*  Returns the cumulative power mode residency and counters since
+*  sleep_stats_init(). The active time is the remainder of the elapsed time.
+*
+* Parameters:
+*  stats : Filled with the totals. All zero if the accounting is not started.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void sleep_stats_get(sleep_stats_t *stats)
+{
+    sleep_stats_state_t snapshot;
+
+    if (!sleep_stats_ready)
+    {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    (void)sleep_stats_update_now();
+    snapshot = sleep_stats;
+    taskEXIT_CRITICAL();
+
+    stats->sleep_ms = SLEEP_STATS_TICKS_TO_MS(snapshot.sleep_ticks);
+    stats->deepsleep_ms = SLEEP_STATS_TICKS_TO_MS(snapshot.deepsleep_ticks);
+    stats->active_ms = SLEEP_STATS_TICKS_TO_MS(snapshot.now - snapshot.sleep_ticks - snapshot.deepsleep_ticks);
+    stats->sleep_entries = snapshot.sleep_entries;
+    stats->deepsleep_entries = snapshot.deepsleep_entries;
+    stats->deepsleep_refused = snapshot.deepsleep_refused;
+    stats->deepsleep_skipped = snapshot.deepsleep_skipped;
+}
+
+/*******************************************************************************
+* Function Name: sleep_stats_print
+********************************************************************************
+* Summary:
+*  Prints the power mode residency on the serial terminal. This is run by the
+*  wake scheduler in the first host wake window after every
+*  SLEEP_STATS_REPORT_INTERVAL_SEC seconds.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void sleep_stats_print(void)
+{
+    sleep_stats_t stats;
+    uint64_t total_ms;
+
+    sleep_stats_get(&stats);
+
+    total_ms = stats.active_ms + stats.sleep_ms + stats.deepsleep_ms;
+    if (0 == total_ms)
+    {
+        return;
+    }
+
+    APP_INFO(("Residency: active %lu.%lu%%, sleep %lu.%lu%%, deep sleep %lu.%lu%% of %lu s\n",
+              (unsigned long)((stats.active_ms * 1000) / total_ms / 10),
+              (unsigned long)((stats.active_ms * 1000) / total_ms % 10),
+              (unsigned long)((stats.sleep_ms * 1000) / total_ms / 10),
+              (unsigned long)((stats.sleep_ms * 1000) / total_ms % 10),
+              (unsigned long)((stats.deepsleep_ms * 1000) / total_ms / 10),
+              (unsigned long)((stats.deepsleep_ms * 1000) / total_ms % 10),
+              (unsigned long)(total_ms / 1000)));
+    APP_INFO(("Deep sleep entries: %lu, refused by a driver: %lu, skipped: %lu, sleep entries: %lu\n",
+              (unsigned long)stats.deepsleep_entries, (unsigned long)stats.deepsleep_refused,
+              (unsigned long)stats.deepsleep_skipped, (unsigned long)stats.sleep_entries));
+}
+
+
+/* [] END OF FILE */
+
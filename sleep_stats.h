@@ -0,0 +1,84 @@
+/******************************************************************************
+* File Name: sleep_stats.h
+*
+* Description: This file contains the interface of the sleep residency
+* accounting of the PSoC 6 MCU.
+*
+******************************************************************************
+* Copyright (2020), Cypress Semiconductor Corporation.
+******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death (“High Risk Product”). By
+* including Cypress’s product in a High Risk Product, the manufacturer of such
+* system or application assumes all risk of such use and in doing so agrees to
+* indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef _SLEEP_STATS_H_
+#define _SLEEP_STATS_H_
+
+#include <stdint.h>
+#include "cy_result.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Frequency of the low-power timer, which is clocked by LFCLK (WCO). */
+#define SLEEP_STATS_LPTIMER_HZ               (32768UL)
+
+/*******************************************************************************
+ * Type Definitions
+ ******************************************************************************/
+/* Cumulative power mode residency since sleep_stats_init(). */
+typedef struct
+{
+    uint64_t active_ms;            /* Time in active mode. */
+    uint64_t sleep_ms;             /* Time in sleep mode. */
+    uint64_t deepsleep_ms;         /* Time in deep sleep mode. */
+    uint32_t sleep_entries;        /* Number of sleep mode entries. */
+    uint32_t deepsleep_entries;    /* Number of deep sleep mode entries. */
+    uint32_t deepsleep_refused;    /* Deep sleep attempts refused by a driver. */
+    uint32_t deepsleep_skipped;    /* Sleep entries without a deep sleep attempt, because
+                                    * deep sleep was locked, or the expected idle time was
+                                    * shorter than the deep sleep latency. */
+} sleep_stats_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+cy_rslt_t sleep_stats_init(void);
+void sleep_stats_on_idle(void);
+uint32_t sleep_stats_read_timer(void);
+void sleep_stats_get(sleep_stats_t *stats);
+void sleep_stats_print(void);
+
+#endif /* _SLEEP_STATS_H_ */
+
+
+/* [] END OF FILE */
+
@@ -0,0 +1,171 @@
+/*******************************************************************************
+ * File Name:   task_stats.c
+ *
+ * Description: This file contains the per-task CPU time snapshots. The FreeRTOS
+ * run-time stats are counted with the low-power timer of the sleep residency
+ * accounting, which keeps counting in deep sleep, so the time spent in sleep
+ * and deep sleep is charged to the idle task. Each snapshot prints the CPU time
+ * of each task since the previous snapshot, which shows the tasks that keep the
+ * MCU awake, such as the logging task, the tcpip thread, the Wi-Fi tasks, the
+ * WHD thread, and the application task.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+
+/* Include header files */
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdbool.h>
+
+#include "sleep_stats.h"
+#include "task_stats.h"
+#include "wifi_config.h"
+
+#if TASK_STATS
+
+#if !SLEEP_STATS
+#error "The task run-time stats use the timebase of the sleep residency accounting. Enable SLEEP_STATS."
+#endif
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Maximum number of tasks in a snapshot. */
+#define TASK_STATS_MAX_TASKS                 (24)
+
+#define TASK_STATS_TICKS_TO_MS(ticks)        ((uint32_t)(((uint64_t)(ticks) * 1000ULL) / SLEEP_STATS_LPTIMER_HZ))
+
+/*******************************************************************************
+ * Static Global Structures and variables
+ ******************************************************************************/
+/* Run-time counter of a task at the previous snapshot. */
+typedef struct
+{
+    UBaseType_t task_number;
+    uint32_t run_time;
+} task_stats_entry_t;
+
+static TaskStatus_t task_stats_status[TASK_STATS_MAX_TASKS];
+static task_stats_entry_t task_stats_last[TASK_STATS_MAX_TASKS];
+static UBaseType_t task_stats_last_count = 0;
+static uint32_t task_stats_last_total = 0;
+
+/*******************************************************************************
+ * Function definitions
+ ******************************************************************************/
+/*******************************************************************************
+* Function Name: task_stats_get_last_run_time
+********************************************************************************
+* Summary:
+*  Returns the run-time counter of a task at the previous snapshot.
+*
+* Parameters:
+*  task_number : Unique number of the task.
+*
+* Return:
+*  uint32_t: Run-time counter, or 0 if the task was created after the previous
+*  snapshot.
+*
+*******************************************************************************/
+static uint32_t task_stats_get_last_run_time(UBaseType_t task_number)
+{
+    UBaseType_t index;
+
+    for (index = 0; index < task_stats_last_count; index++)
+    {
+        if (task_number == task_stats_last[index].task_number)
+        {
+            return task_stats_last[index].run_time;
+        }
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+* Function Name: task_stats_print
+********************************************************************************
+* Summary:
+*  Prints the CPU time of each task which ran since the previous snapshot, and
+*  its share of the elapsed time. This is run by the wake scheduler in the
+*  first host wake window after every TASK_STATS_REPORT_INTERVAL_SEC seconds.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void task_stats_print(void)
+{
+    UBaseType_t task_count;
+    UBaseType_t index;
+    uint32_t total;
+    uint32_t elapsed;
+    uint32_t run_time;
+
+    task_count = uxTaskGetSystemState(task_stats_status, TASK_STATS_MAX_TASKS, &total);
+    elapsed = total - task_stats_last_total;
+
+    if (0 != elapsed)
+    {
+        APP_INFO(("Task CPU time in the last %lu ms:\n", (unsigned long)TASK_STATS_TICKS_TO_MS(elapsed)));
+
+        for (index = 0; index < task_count; index++)
+        {
+            run_time = task_stats_status[index].ulRunTimeCounter -
+                       task_stats_get_last_run_time(task_stats_status[index].xTaskNumber);
+            if (0 != run_time)
+            {
+                APP_INFO(("  %-10s %8lu ms %3lu.%lu%%\n", task_stats_status[index].pcTaskName,
+                          (unsigned long)TASK_STATS_TICKS_TO_MS(run_time),
+                          (unsigned long)(((uint64_t)run_time * 1000) / elapsed / 10),
+                          (unsigned long)(((uint64_t)run_time * 1000) / elapsed % 10)));
+            }
+        }
+    }
+
+    for (index = 0; index < task_count; index++)
+    {
+        task_stats_last[index].task_number = task_stats_status[index].xTaskNumber;
+        task_stats_last[index].run_time = task_stats_status[index].ulRunTimeCounter;
+    }
+    task_stats_last_count = task_count;
+    task_stats_last_total = total;
+}
+
+#endif /* TASK_STATS */
+
+
+/* [] END OF FILE */
+
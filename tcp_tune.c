@@ -0,0 +1,367 @@
+/*******************************************************************************
+ * File Name:   tcp_tune.c
+ *
+ * Description: This file contains the runtime sizing of the TCP receive
+ * windows and send buffers. TCP_WND and TCP_SND_BUF are set to the maximum
+ * sizes, and each connection holds back part of them so that it uses only
+ * the base sizes, unless it is moving bulk data:
+ *  - A connection which received or had acknowledged more than
+ *    TCP_TUNE_BULK_BYTES in the last interval, or which has filled its send
+ *    buffer, is given the maximum sizes, if the total of all the connections
+ *    stays within TCP_TUNE_RX_BUDGET and TCP_TUNE_TX_BUDGET.
+ *  - A connection which was idle in the last interval is shrunk back to the
+ *    base sizes. All the connections are shrunk before the network stack is
+ *    suspended, so that a burst received on wake cannot take the Rx pbuf pool.
+ *
+ * lwIP accepts data up to rcv_nxt + rcv_wnd, so the part of the window which
+ * has been announced to the peer is never held back: the peer may send all of
+ * it. Only the part which the application has freed since the last window
+ * update is held back. A connection is therefore shrunk over the following
+ * intervals, as the peer uses up the announced window and the application
+ * reads the data, and keeps shrinking until it is at the base sizes or moves
+ * bulk data again.
+ *
+ *******************************************************************************
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+
+/* Include header files */
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdbool.h>
+#include <string.h>
+#include <lwip/tcp.h>
+#include <lwip/tcpip.h>
+#include <lwip/timeouts.h>
+#include <lwip/priv/tcp_priv.h>
+
+#include "tcp_tune.h"
+#include "wifi_config.h"
+
+#if TCP_TUNE
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Interval at which the connections are sized while the network stack runs. */
+#define TCP_TUNE_INTERVAL_MS                 (TCP_TMR_INTERVAL)
+
+/* Bytes moved in an interval above which a connection is a bulk transfer. */
+#define TCP_TUNE_BULK_BYTES                  (2 * TCP_MSS)
+
+/* Part of TCP_WND and TCP_SND_BUF held back at the base sizes. */
+#define TCP_TUNE_WND_HOLD                    (TCP_TUNE_WND_MAX - TCP_TUNE_WND_BASE)
+#define TCP_TUNE_SND_BUF_HOLD                (TCP_TUNE_SND_BUF_MAX - TCP_TUNE_SND_BUF_BASE)
+
+/*******************************************************************************
+ * Static Global Structures and variables
+ ******************************************************************************/
+/* Sizing state of a TCP connection. */
+typedef struct
+{
+    struct tcp_pcb *pcb;           /* NULL if the entry is free. */
+    tcpwnd_size_t wnd_held;        /* Part of TCP_WND held back. */
+    tcpwnd_size_t snd_buf_held;    /* Part of TCP_SND_BUF held back. */
+    u32_t rcv_nxt;                 /* Receive sequence number at the last interval. */
+    u32_t lastack;                 /* Acknowledged sequence number at the last interval. */
+    bool shrinking;                /* Not at the base sizes yet after a shrink. */
+} tcp_tune_conn_t;
+
+static tcp_tune_conn_t tcp_tune_conns[MEMP_NUM_TCP_PCB];
+
+/* lwIP TCP extension argument ID of the sizing state. */
+static u8_t tcp_tune_ext_arg_id;
+
+static void tcp_tune_pcb_destroyed(u8_t id, void *data);
+
+static const struct tcp_ext_arg_callbacks tcp_tune_ext_arg_callbacks =
+{
+    tcp_tune_pcb_destroyed,
+    NULL
+};
+
+/*******************************************************************************
+ * Function definitions
+ ******************************************************************************/
+/*******************************************************************************
+* Function Name: tcp_tune_pcb_destroyed
+********************************************************************************
+* Summary:
+*  lwIP TCP extension argument callback. Frees the sizing state of a
+*  connection when its PCB is freed.
+*
+* Parameters:
+*  id   : Extension argument ID.
+*  data : Sizing state of the connection.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void tcp_tune_pcb_destroyed(u8_t id, void *data)
+{
+    (void)id;
+
+    if (NULL != data)
+    {
+        ((tcp_tune_conn_t *)data)->pcb = NULL;
+    }
+}
+
+/*******************************************************************************
+* Function Name: tcp_tune_get_conn
+********************************************************************************
+* Summary:
+*  Returns the sizing state of a connection. A connection seen for the first
+*  time starts with the maximum sizes, which lwIP gave it.
+*
+* Parameters:
+*  pcb : TCP connection.
+*
+* Return:
+*  tcp_tune_conn_t *: Sizing state, or NULL if there is no free entry.
+*
+*******************************************************************************/
+static tcp_tune_conn_t *tcp_tune_get_conn(struct tcp_pcb *pcb)
+{
+    tcp_tune_conn_t *conn = (tcp_tune_conn_t *)tcp_ext_arg_get(pcb, tcp_tune_ext_arg_id);
+    uint32_t index;
+
+    if (NULL != conn)
+    {
+        return conn;
+    }
+
+    for (index = 0; index < MEMP_NUM_TCP_PCB; index++)
+    {
+        if (NULL == tcp_tune_conns[index].pcb)
+        {
+            conn = &tcp_tune_conns[index];
+            memset(conn, 0, sizeof(*conn));
+            conn->pcb = pcb;
+            conn->rcv_nxt = pcb->rcv_nxt;
+            conn->lastack = pcb->lastack;
+
+            tcp_ext_arg_set_callbacks(pcb, tcp_tune_ext_arg_id, &tcp_tune_ext_arg_callbacks);
+            tcp_ext_arg_set(pcb, tcp_tune_ext_arg_id, conn);
+            break;
+        }
+    }
+
+    return conn;
+}
+
+/*******************************************************************************
+* Function Name: tcp_tune_shrink
+********************************************************************************
+* Summary:
+*  Holds back the part of the receive window which has not been announced to
+*  the peer, and the free part of the send buffer of a connection, down to the
+*  base sizes. The connection stays marked as shrinking until both are at the
+*  base sizes.
+*
+* Parameters:
+*  conn : Sizing state of the connection.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void tcp_tune_shrink(tcp_tune_conn_t *conn)
+{
+    struct tcp_pcb *pcb = conn->pcb;
+    u32_t announced = pcb->rcv_ann_right_edge - pcb->rcv_nxt;
+    tcpwnd_size_t amount;
+
+    amount = (pcb->rcv_wnd > announced) ? (tcpwnd_size_t)(pcb->rcv_wnd - announced) : 0;
+    amount = LWIP_MIN((tcpwnd_size_t)(TCP_TUNE_WND_HOLD - conn->wnd_held), amount);
+    pcb->rcv_wnd = (tcpwnd_size_t)(pcb->rcv_wnd - amount);
+    conn->wnd_held = (tcpwnd_size_t)(conn->wnd_held + amount);
+
+    amount = LWIP_MIN((tcpwnd_size_t)(TCP_TUNE_SND_BUF_HOLD - conn->snd_buf_held), pcb->snd_buf);
+    pcb->snd_buf = (tcpwnd_size_t)(pcb->snd_buf - amount);
+    conn->snd_buf_held = (tcpwnd_size_t)(conn->snd_buf_held + amount);
+
+    conn->shrinking = (TCP_TUNE_WND_HOLD != conn->wnd_held) || (TCP_TUNE_SND_BUF_HOLD != conn->snd_buf_held);
+}
+
+/*******************************************************************************
+* Function Name: tcp_tune_timer
+********************************************************************************
+* Summary:
+*  lwIP timeout handler. Sizes each connection for the data it moved in the
+*  last interval. It is run in the tcpip thread context.
+*
+* Parameters:
+*  arg : Unused.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void tcp_tune_timer(void *arg)
+{
+    struct tcp_pcb *pcb;
+    tcp_tune_conn_t *conn;
+    u32_t wnd_total = 0;
+    u32_t snd_buf_total = 0;
+    u32_t received;
+    u32_t acked;
+    bool rx_bulk;
+    bool tx_bulk;
+    tcpwnd_size_t amount;
+
+    (void)arg;
+
+    for (pcb = tcp_active_pcbs; NULL != pcb; pcb = pcb->next)
+    {
+        conn = (tcp_tune_conn_t *)tcp_ext_arg_get(pcb, tcp_tune_ext_arg_id);
+        if (NULL != conn)
+        {
+            wnd_total += TCP_WND - conn->wnd_held;
+            snd_buf_total += TCP_SND_BUF - conn->snd_buf_held;
+        }
+    }
+
+    for (pcb = tcp_active_pcbs; NULL != pcb; pcb = pcb->next)
+    {
+        if ((ESTABLISHED != pcb->state) && (CLOSE_WAIT != pcb->state))
+        {
+            continue;
+        }
+
+        conn = tcp_tune_get_conn(pcb);
+        if (NULL == conn)
+        {
+            continue;
+        }
+
+        received = pcb->rcv_nxt - conn->rcv_nxt;
+        acked = pcb->lastack - conn->lastack;
+        conn->rcv_nxt = pcb->rcv_nxt;
+        conn->lastack = pcb->lastack;
+
+        rx_bulk = (received >= TCP_TUNE_BULK_BYTES);
+        tx_bulk = (acked >= TCP_TUNE_BULK_BYTES) || ((NULL != pcb->unsent) && (pcb->snd_buf < TCP_MSS));
+
+        if (rx_bulk && (0 != conn->wnd_held) && ((wnd_total + conn->wnd_held) <= TCP_TUNE_RX_BUDGET))
+        {
+            /* Announces the larger window right away. */
+            amount = conn->wnd_held;
+            wnd_total += amount;
+            conn->wnd_held = 0;
+            conn->shrinking = false;
+            tcp_recved(pcb, (u16_t)amount);
+        }
+
+        if (tx_bulk && (0 != conn->snd_buf_held) && ((snd_buf_total + conn->snd_buf_held) <= TCP_TUNE_TX_BUDGET))
+        {
+            snd_buf_total += conn->snd_buf_held;
+            pcb->snd_buf = (tcpwnd_size_t)(pcb->snd_buf + conn->snd_buf_held);
+            conn->snd_buf_held = 0;
+            conn->shrinking = false;
+        }
+
+        if (((0 == received) && (0 == acked)) || conn->shrinking)
+        {
+            tcp_tune_shrink(conn);
+        }
+    }
+
+    sys_timeout(TCP_TUNE_INTERVAL_MS, tcp_tune_timer, NULL);
+}
+
+/*******************************************************************************
+* Function Name: tcp_tune_init
+********************************************************************************
+* Summary:
+*  Starts sizing the TCP connections. This is called after tcpip_init().
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void tcp_tune_init(void)
+{
+    LOCK_TCPIP_CORE();
+
+    tcp_tune_ext_arg_id = tcp_ext_arg_alloc_id();
+    sys_timeout(TCP_TUNE_INTERVAL_MS, tcp_tune_timer, NULL);
+
+    UNLOCK_TCPIP_CORE();
+}
+
+/*******************************************************************************
+* Function Name: tcp_tune_on_suspend
+********************************************************************************
+* Summary:
+*  Shrinks all the connections towards the base sizes. This is called before
+*  the network stack is suspended. The window which is already announced to
+*  the peer is held back by the timer once the peer has used it.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void tcp_tune_on_suspend(void)
+{
+    struct tcp_pcb *pcb;
+    tcp_tune_conn_t *conn;
+
+    LOCK_TCPIP_CORE();
+
+    for (pcb = tcp_active_pcbs; NULL != pcb; pcb = pcb->next)
+    {
+        if ((ESTABLISHED == pcb->state) || (CLOSE_WAIT == pcb->state))
+        {
+            conn = tcp_tune_get_conn(pcb);
+            if (NULL != conn)
+            {
+                tcp_tune_shrink(conn);
+            }
+        }
+    }
+
+    UNLOCK_TCPIP_CORE();
+}
+
+#endif /* TCP_TUNE */
+
+
+/* [] END OF FILE */
+
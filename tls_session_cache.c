@@ -0,0 +1,775 @@
+/*******************************************************************************
+ * File Name:   tls_session_cache.c
+ *
+ * Description: This file contains the TLS session cache. The secure sockets
+ * run a full TLS handshake, with an ECDHE key exchange and the certificate
+ * verification, on every connect. The cache keeps the session ID, master
+ * secret, and session ticket of the last session with each server, and
+ * offers them on the next connect, so that the server can resume the session
+ * with an abbreviated handshake.
+ *
+ * The secure sockets library creates its mbedTLS context internally, so the
+ * cache is applied by wrapping mbedtls_ssl_handshake() with the GNU linker
+ * option --wrap=mbedtls_ssl_handshake, which is set in the Makefile and in
+ * CMakeLists.txt for the GCC_ARM toolchain. The server is identified by the
+ * server name (SNI) set by the secure sockets. mbedtls_ssl_setup() is wrapped
+ * as well, so that the heap allocations of the TLS contexts and handshakes are
+ * attributed to TLS in the memory usage report.
+ *
+ * The cache is kept in a CY_NOINIT RAM section, so that a session can also be
+ * resumed after a reset. A CRC over the entries is checked after the reset,
+ * and the lengths of an entry are checked before it is offered, so that a
+ * corrupted entry is never passed to mbedTLS. The time and the CPU active time of each handshake
+ * are measured whether or not TLS_SESSION_CACHE is enabled.
+ *
+ *******************************************************************************
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+
+/* Include header files */
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdbool.h>
+#include <string.h>
+#include "cy_syslib.h"
+#include "mbedtls/ssl.h"
+#include "mbedtls/platform_util.h"
+
+/* Secure sockets configuration. */
+#include "aws_secure_sockets_config.h"
+
+#include "tls_session_cache.h"
+#include "sleep_stats.h"
+#include "wifi_config.h"
+
+#if MEM_USAGE_STATS
+#include "mem_usage.h"
+#endif
+
+#if defined(__GNUC__) && !defined(__ARMCC_VERSION) && defined(MBEDTLS_SSL_CLI_C)
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define TLS_SESSION_CACHE_MAGIC              (0x544C5343UL)
+
+/* Longest server name and session ticket which are cached. */
+#define TLS_SESSION_CACHE_NAME_LENGTH        (64)
+#define TLS_SESSION_CACHE_TICKET_LENGTH      (512)
+
+/* CRC-32 (IEEE 802.3), reflected polynomial. */
+#define TLS_SESSION_CACHE_CRC_POLYNOMIAL     (0xEDB88320UL)
+
+/*******************************************************************************
+ * Static Global Structures and variables
+ ******************************************************************************/
+/* Cached session. */
+typedef struct
+{
+    bool valid;
+    uint32_t last_used;            /* Use count at the last use, for replacement. */
+    char server_name[TLS_SESSION_CACHE_NAME_LENGTH];
+    int ciphersuite;
+    int compression;
+    size_t id_len;
+    unsigned char id[32];
+    unsigned char master[48];
+    uint32_t verify_result;
+    size_t ticket_len;
+    uint32_t ticket_lifetime;
+    unsigned char ticket[TLS_SESSION_CACHE_TICKET_LENGTH];
+    unsigned char mfl_code;
+    int trunc_hmac;
+    int encrypt_then_mac;
+} tls_session_cache_entry_t;
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t size;
+    uint32_t use_count;
+    tls_session_cache_entry_t entries[TLS_SESSION_CACHE_ENTRIES];
+    uint32_t crc;                  /* CRC of the entries. */
+    uint32_t magic_end;
+} tls_session_cache_data_t;
+
+/* Client handshake in progress. */
+typedef struct
+{
+    const mbedtls_ssl_context *ssl;    /* NULL if the entry is free. */
+    TickType_t start;
+    uint32_t start_active_ms;
+    bool offered;
+    unsigned char offered_master[48];
+} tls_session_cache_handshake_t;
+
+/* Handshake measurements. */
+typedef struct
+{
+    uint32_t count;
+    uint32_t total_ms;
+    uint32_t total_active_ms;
+} tls_session_cache_stats_t;
+
+#if TLS_SESSION_CACHE
+static CY_NOINIT tls_session_cache_data_t tls_session_cache_data;
+
+static bool tls_session_cache_ready = false;
+#endif
+
+static tls_session_cache_handshake_t tls_session_cache_handshakes[socketsconfigDEFAULT_MAX_NUM_SECURE_SOCKETS];
+
+static tls_session_cache_stats_t tls_session_cache_full_stats;
+static tls_session_cache_stats_t tls_session_cache_resumed_stats;
+static uint32_t tls_session_cache_failed = 0;
+
+int __real_mbedtls_ssl_handshake(mbedtls_ssl_context *ssl);
+int __wrap_mbedtls_ssl_handshake(mbedtls_ssl_context *ssl);
+int __real_mbedtls_ssl_setup(mbedtls_ssl_context *ssl, const mbedtls_ssl_config *conf);
+int __wrap_mbedtls_ssl_setup(mbedtls_ssl_context *ssl, const mbedtls_ssl_config *conf);
+
+/*******************************************************************************
+ * Function definitions
+ ******************************************************************************/
+/*******************************************************************************
+* Function Name: tls_session_cache_get_active_ms
+********************************************************************************
+* Summary:
+*  Returns the time the CPU has spent in active mode.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  uint32_t: Active mode time in milliseconds, or 0 if SLEEP_STATS is disabled.
+*
+*******************************************************************************/
+static uint32_t tls_session_cache_get_active_ms(void)
+{
+#if SLEEP_STATS
+    sleep_stats_t stats;
+
+    sleep_stats_get(&stats);
+    return (uint32_t)stats.active_ms;
+#else
+    return 0;
+#endif
+}
+
+#if TLS_SESSION_CACHE
+/*******************************************************************************
+* Function Name: tls_session_cache_crc
+********************************************************************************
+* Summary:
+*  Calculates the CRC of the cache entries. Must be called with the scheduler
+*  suspended.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  uint32_t: CRC of the entries.
+*
+*******************************************************************************/
+static uint32_t tls_session_cache_crc(void)
+{
+    const uint8_t *data = (const uint8_t *)tls_session_cache_data.entries;
+    uint32_t crc = 0xFFFFFFFFUL;
+    uint32_t index;
+    uint32_t bit;
+
+    for (index = 0; index < sizeof(tls_session_cache_data.entries); index++)
+    {
+        crc ^= data[index];
+        for (bit = 0; bit < 8; bit++)
+        {
+            crc = (crc >> 1) ^ ((0 != (crc & 1UL)) ? TLS_SESSION_CACHE_CRC_POLYNOMIAL : 0);
+        }
+    }
+
+    return ~crc;
+}
+
+/*******************************************************************************
+* Function Name: tls_session_cache_validate
+********************************************************************************
+* Summary:
+*  Validates the retained cache, and clears it if it is not valid, such as
+*  after a power-on reset, a firmware update, or if the retained RAM was
+*  corrupted. Must be called with the scheduler suspended.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void tls_session_cache_validate(void)
+{
+    if (tls_session_cache_ready)
+    {
+        return;
+    }
+
+    if ((TLS_SESSION_CACHE_MAGIC != tls_session_cache_data.magic) ||
+        (~TLS_SESSION_CACHE_MAGIC != tls_session_cache_data.magic_end) ||
+        (sizeof(tls_session_cache_data) != tls_session_cache_data.size) ||
+        (tls_session_cache_crc() != tls_session_cache_data.crc))
+    {
+        mbedtls_platform_zeroize(&tls_session_cache_data, sizeof(tls_session_cache_data));
+        tls_session_cache_data.magic = TLS_SESSION_CACHE_MAGIC;
+        tls_session_cache_data.size = sizeof(tls_session_cache_data);
+        tls_session_cache_data.crc = tls_session_cache_crc();
+        tls_session_cache_data.magic_end = ~TLS_SESSION_CACHE_MAGIC;
+    }
+
+    tls_session_cache_ready = true;
+}
+
+/*******************************************************************************
+* Function Name: tls_session_cache_find
+********************************************************************************
+* Summary:
+*  Returns the cached session of a server. Must be called with the scheduler
+*  suspended.
+*
+* Parameters:
+*  server_name : Server name.
+*
+* Return:
+*  tls_session_cache_entry_t *: Cached session, or NULL if there is none.
+*
+*******************************************************************************/
+static tls_session_cache_entry_t *tls_session_cache_find(const char *server_name)
+{
+    uint32_t index;
+
+    for (index = 0; index < TLS_SESSION_CACHE_ENTRIES; index++)
+    {
+        if (tls_session_cache_data.entries[index].valid &&
+            (0 == strncmp(tls_session_cache_data.entries[index].server_name, server_name,
+                          TLS_SESSION_CACHE_NAME_LENGTH)))
+        {
+            return &tls_session_cache_data.entries[index];
+        }
+    }
+
+    return NULL;
+}
+
+/*******************************************************************************
+* Function Name: tls_session_cache_offer
+********************************************************************************
+* Summary:
+*  Sets the cached session of the server in the TLS context before the
+*  handshake starts, so that the client hello offers to resume it.
+*
+* Parameters:
+*  ssl    : TLS context.
+*  master : Filled with the master secret of the offered session, which is
+*           kept on resumption.
+*
+* Return:
+*  bool: True if a session was offered.
+*
+*******************************************************************************/
+static bool tls_session_cache_offer(mbedtls_ssl_context *ssl, unsigned char master[48])
+{
+    tls_session_cache_entry_t *entry;
+    mbedtls_ssl_session session;
+    bool offered = false;
+
+    mbedtls_ssl_session_init(&session);
+
+    vTaskSuspendAll();
+    tls_session_cache_validate();
+    entry = tls_session_cache_find(ssl->hostname);
+    if ((NULL != entry) &&
+        ((entry->id_len > sizeof(entry->id)) || (entry->ticket_len > TLS_SESSION_CACHE_TICKET_LENGTH)))
+    {
+        /* The lengths are used to copy the ID and the ticket. */
+        mbedtls_platform_zeroize(entry, sizeof(*entry));
+        entry = NULL;
+    }
+    if (NULL != entry)
+    {
+        entry->last_used = ++tls_session_cache_data.use_count;
+        session.ciphersuite = entry->ciphersuite;
+        session.compression = entry->compression;
+        session.id_len = entry->id_len;
+        memcpy(session.id, entry->id, sizeof(session.id));
+        memcpy(session.master, entry->master, sizeof(session.master));
+        session.verify_result = entry->verify_result;
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+        session.ticket = (0 != entry->ticket_len) ? entry->ticket : NULL;
+        session.ticket_len = entry->ticket_len;
+        session.ticket_lifetime = entry->ticket_lifetime;
+#endif
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+        session.mfl_code = entry->mfl_code;
+#endif
+#if defined(MBEDTLS_SSL_TRUNCATED_HMAC)
+        session.trunc_hmac = entry->trunc_hmac;
+#endif
+#if defined(MBEDTLS_SSL_ENCRYPT_THEN_MAC)
+        session.encrypt_then_mac = entry->encrypt_then_mac;
+#endif
+        memcpy(master, entry->master, 48);
+        offered = true;
+    }
+    tls_session_cache_data.crc = tls_session_cache_crc();
+    (void)xTaskResumeAll();
+
+    /* The session, including the ticket, is copied into the TLS context. */
+    if (offered && (0 != mbedtls_ssl_set_session(ssl, &session)))
+    {
+        offered = false;
+    }
+
+    /* The ticket points into the cache, so the session is not freed. */
+    mbedtls_platform_zeroize(&session, sizeof(session));
+
+    return offered;
+}
+
+/*******************************************************************************
+* Function Name: tls_session_cache_store
+********************************************************************************
+* Summary:
+*  Stores the established session of the TLS context, replacing the previous
+*  session of the server or the least recently used entry.
+*
+* Parameters:
+*  ssl : TLS context after a successful handshake.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void tls_session_cache_store(const mbedtls_ssl_context *ssl)
+{
+    const mbedtls_ssl_session *session = ssl->session;
+    tls_session_cache_entry_t *entry;
+    uint32_t index;
+
+    if ((NULL == session) || (strlen(ssl->hostname) >= TLS_SESSION_CACHE_NAME_LENGTH))
+    {
+        return;
+    }
+
+    vTaskSuspendAll();
+    tls_session_cache_validate();
+
+    entry = tls_session_cache_find(ssl->hostname);
+    for (index = 0; (NULL == entry) && (index < TLS_SESSION_CACHE_ENTRIES); index++)
+    {
+        if (!tls_session_cache_data.entries[index].valid)
+        {
+            entry = &tls_session_cache_data.entries[index];
+        }
+    }
+    if (NULL == entry)
+    {
+        entry = &tls_session_cache_data.entries[0];
+        for (index = 1; index < TLS_SESSION_CACHE_ENTRIES; index++)
+        {
+            if (tls_session_cache_data.entries[index].last_used < entry->last_used)
+            {
+                entry = &tls_session_cache_data.entries[index];
+            }
+        }
+    }
+
+    mbedtls_platform_zeroize(entry, sizeof(*entry));
+    strncpy(entry->server_name, ssl->hostname, TLS_SESSION_CACHE_NAME_LENGTH - 1);
+    entry->last_used = ++tls_session_cache_data.use_count;
+    entry->ciphersuite = session->ciphersuite;
+    entry->compression = session->compression;
+    entry->id_len = (session->id_len <= sizeof(entry->id)) ? session->id_len : 0;
+    memcpy(entry->id, session->id, sizeof(entry->id));
+    memcpy(entry->master, session->master, sizeof(entry->master));
+    entry->verify_result = session->verify_result;
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+    if ((NULL != session->ticket) && (session->ticket_len <= TLS_SESSION_CACHE_TICKET_LENGTH))
+    {
+        memcpy(entry->ticket, session->ticket, session->ticket_len);
+        entry->ticket_len = session->ticket_len;
+        entry->ticket_lifetime = session->ticket_lifetime;
+    }
+#endif
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+    entry->mfl_code = session->mfl_code;
+#endif
+#if defined(MBEDTLS_SSL_TRUNCATED_HMAC)
+    entry->trunc_hmac = session->trunc_hmac;
+#endif
+#if defined(MBEDTLS_SSL_ENCRYPT_THEN_MAC)
+    entry->encrypt_then_mac = session->encrypt_then_mac;
+#endif
+
+    /* A session without an ID or a ticket cannot be resumed. */
+    entry->valid = ((0 != entry->id_len) || (0 != entry->ticket_len));
+    tls_session_cache_data.crc = tls_session_cache_crc();
+
+    (void)xTaskResumeAll();
+}
+
+/*******************************************************************************
+* Function Name: tls_session_cache_remove
+********************************************************************************
+* Summary:
+*  Removes the cached session of a server, after a handshake in which it was
+*  offered has failed.
+*
+* Parameters:
+*  server_name : Server name.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void tls_session_cache_remove(const char *server_name)
+{
+    tls_session_cache_entry_t *entry;
+
+    vTaskSuspendAll();
+    entry = tls_session_cache_find(server_name);
+    if (NULL != entry)
+    {
+        mbedtls_platform_zeroize(entry, sizeof(*entry));
+        tls_session_cache_data.crc = tls_session_cache_crc();
+    }
+    (void)xTaskResumeAll();
+}
+#endif /* TLS_SESSION_CACHE */
+
+/*******************************************************************************
+* Function Name: tls_session_cache_get_handshake
+********************************************************************************
+* Summary:
+*  Returns the state of the handshake of a TLS context.
+*
+* Parameters:
+*  ssl   : TLS context.
+*  start : True to allocate the state for a handshake which starts.
+*
+* Return:
+*  tls_session_cache_handshake_t *: Handshake state, or NULL if there is none.
+*
+*******************************************************************************/
+static tls_session_cache_handshake_t *tls_session_cache_get_handshake(const mbedtls_ssl_context *ssl, bool start)
+{
+    tls_session_cache_handshake_t *handshake = NULL;
+    uint32_t index;
+
+    vTaskSuspendAll();
+    for (index = 0; (NULL == handshake) && (index < socketsconfigDEFAULT_MAX_NUM_SECURE_SOCKETS); index++)
+    {
+        if (ssl == tls_session_cache_handshakes[index].ssl)
+        {
+            handshake = &tls_session_cache_handshakes[index];
+        }
+    }
+    for (index = 0; start && (NULL == handshake) && (index < socketsconfigDEFAULT_MAX_NUM_SECURE_SOCKETS); index++)
+    {
+        if (NULL == tls_session_cache_handshakes[index].ssl)
+        {
+            handshake = &tls_session_cache_handshakes[index];
+            handshake->ssl = ssl;
+        }
+    }
+    (void)xTaskResumeAll();
+
+    return handshake;
+}
+
+/*******************************************************************************
+* Function Name: tls_session_cache_record
+********************************************************************************
+* Summary:
+*  Adds a handshake to the measurements and prints it.
+*
+* Parameters:
+*  ssl       : TLS context.
+*  resumed   : True if the session was resumed.
+*  elapsed   : Handshake time in milliseconds.
+*  active_ms : CPU active time during the handshake in milliseconds.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void tls_session_cache_record(const mbedtls_ssl_context *ssl, bool resumed,
+                                     uint32_t elapsed, uint32_t active_ms)
+{
+    tls_session_cache_stats_t *stats = resumed ? &tls_session_cache_resumed_stats : &tls_session_cache_full_stats;
+
+    vTaskSuspendAll();
+    stats->count++;
+    stats->total_ms += elapsed;
+    stats->total_active_ms += active_ms;
+    (void)xTaskResumeAll();
+
+    APP_INFO(("TLS handshake with %s: %s, %lu ms, %lu ms active\n",
+              (NULL != ssl->hostname) ? ssl->hostname : "server", resumed ? "resumed" : "full",
+              (unsigned long)elapsed, (unsigned long)active_ms));
+}
+
+/*******************************************************************************
+* Function Name: tls_session_cache_handshake
+********************************************************************************
+* Summary:
+*  Offers the cached session of the server before a client handshake starts,
+*  stores the session after it completes, and measures it.
+*
+* Parameters:
+*  ssl : TLS context.
+*
+* Return:
+*  int: Result of mbedtls_ssl_handshake().
+*
+*******************************************************************************/
+static int tls_session_cache_handshake(mbedtls_ssl_context *ssl)
+{
+    tls_session_cache_handshake_t *handshake = NULL;
+    bool resumed;
+    int result;
+
+    if (MBEDTLS_SSL_IS_CLIENT != ssl->conf->endpoint)
+    {
+        return __real_mbedtls_ssl_handshake(ssl);
+    }
+
+    /* The secure sockets call this again while the handshake wants to read
+     * or write, so only the first call of a handshake starts it.
+     */
+    if (MBEDTLS_SSL_HELLO_REQUEST == ssl->state)
+    {
+        handshake = tls_session_cache_get_handshake(ssl, true);
+        if (NULL != handshake)
+        {
+            handshake->start = xTaskGetTickCount();
+            handshake->start_active_ms = tls_session_cache_get_active_ms();
+            handshake->offered = false;
+#if TLS_SESSION_CACHE
+            if (NULL != ssl->hostname)
+            {
+                handshake->offered = tls_session_cache_offer(ssl, handshake->offered_master);
+            }
+#endif
+        }
+    }
+    else
+    {
+        handshake = tls_session_cache_get_handshake(ssl, false);
+    }
+
+    result = __real_mbedtls_ssl_handshake(ssl);
+
+    if ((NULL == handshake) || (MBEDTLS_ERR_SSL_WANT_READ == result) || (MBEDTLS_ERR_SSL_WANT_WRITE == result))
+    {
+        return result;
+    }
+
+    if (0 != result)
+    {
+        tls_session_cache_failed++;
+#if TLS_SESSION_CACHE
+        if (handshake->offered)
+        {
+            tls_session_cache_remove(ssl->hostname);
+        }
+#endif
+    }
+    else
+    {
+        /* A resumed session keeps the master secret of the offered session. */
+        resumed = handshake->offered && (NULL != ssl->session) &&
+                  (0 == memcmp(ssl->session->master, handshake->offered_master, sizeof(handshake->offered_master)));
+
+        tls_session_cache_record(ssl, resumed, (xTaskGetTickCount() - handshake->start) * portTICK_PERIOD_MS,
+                                 tls_session_cache_get_active_ms() - handshake->start_active_ms);
+#if TLS_SESSION_CACHE
+        if (!resumed && (NULL != ssl->hostname))
+        {
+            tls_session_cache_store(ssl);
+        }
+#endif
+    }
+
+    /* Frees the handshake state. */
+    mbedtls_platform_zeroize(handshake, sizeof(*handshake));
+
+    return result;
+}
+
+/*******************************************************************************
+* Function Name: __wrap_mbedtls_ssl_handshake
+********************************************************************************
+* Summary:
+*  Replaces mbedtls_ssl_handshake() at link time. Runs the handshake with the
+*  session cache, with the heap allocations attributed to TLS.
+*
+* Parameters:
+*  ssl : TLS context.
+*
+* Return:
+*  int: Result of mbedtls_ssl_handshake().
+*
+*******************************************************************************/
+int __wrap_mbedtls_ssl_handshake(mbedtls_ssl_context *ssl)
+{
+#if MEM_USAGE_STATS
+    uint8_t previous = mem_usage_set_tag(MEM_USAGE_TAG_TLS);
+    int result = tls_session_cache_handshake(ssl);
+
+    (void)mem_usage_set_tag(previous);
+
+    return result;
+#else
+    return tls_session_cache_handshake(ssl);
+#endif
+}
+
+/*******************************************************************************
+* Function Name: __wrap_mbedtls_ssl_setup
+********************************************************************************
+* Summary:
+*  Replaces mbedtls_ssl_setup() at link time, which the secure sockets call on
+*  connect. Attributes the allocations of the TLS context, such as the record
+*  buffers, to TLS.
+*
+* Parameters:
+*  ssl  : TLS context.
+*  conf : TLS configuration.
+*
+* Return:
+*  int: Result of mbedtls_ssl_setup().
+*
+*******************************************************************************/
+int __wrap_mbedtls_ssl_setup(mbedtls_ssl_context *ssl, const mbedtls_ssl_config *conf)
+{
+#if MEM_USAGE_STATS
+    uint8_t previous = mem_usage_set_tag(MEM_USAGE_TAG_TLS);
+    int result = __real_mbedtls_ssl_setup(ssl, conf);
+
+    (void)mem_usage_set_tag(previous);
+
+    return result;
+#else
+    return __real_mbedtls_ssl_setup(ssl, conf);
+#endif
+}
+
+/*******************************************************************************
+* Function Name: tls_session_cache_clear
+********************************************************************************
+* Summary:
+*  Removes all the cached sessions, such as after the device credentials have
+*  changed.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void tls_session_cache_clear(void)
+{
+#if TLS_SESSION_CACHE
+    vTaskSuspendAll();
+    tls_session_cache_ready = false;
+    tls_session_cache_data.magic = 0;
+    tls_session_cache_validate();
+    (void)xTaskResumeAll();
+#endif
+}
+
+/*******************************************************************************
+* Function Name: tls_session_cache_print
+********************************************************************************
+* Summary:
+*  Prints the average time and CPU active time of the full and the resumed
+*  handshakes. Nothing is printed before the first handshake.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void tls_session_cache_print(void)
+{
+    tls_session_cache_stats_t full;
+    tls_session_cache_stats_t resumed;
+    uint32_t failed;
+
+    vTaskSuspendAll();
+    full = tls_session_cache_full_stats;
+    resumed = tls_session_cache_resumed_stats;
+    failed = tls_session_cache_failed;
+    (void)xTaskResumeAll();
+
+    if ((0 == full.count) && (0 == resumed.count) && (0 == failed))
+    {
+        return;
+    }
+
+    APP_INFO(("TLS handshakes: %lu full, average %lu ms, %lu ms active\n", (unsigned long)full.count,
+              (unsigned long)((0 != full.count) ? (full.total_ms / full.count) : 0),
+              (unsigned long)((0 != full.count) ? (full.total_active_ms / full.count) : 0)));
+    APP_INFO(("TLS handshakes: %lu resumed, average %lu ms, %lu ms active, %lu failed\n",
+              (unsigned long)resumed.count,
+              (unsigned long)((0 != resumed.count) ? (resumed.total_ms / resumed.count) : 0),
+              (unsigned long)((0 != resumed.count) ? (resumed.total_active_ms / resumed.count) : 0),
+              (unsigned long)failed));
+}
+
+#else
+
+/* The handshake is not wrapped with this toolchain. */
+void tls_session_cache_clear(void)
+{
+}
+
+void tls_session_cache_print(void)
+{
+}
+
+#endif /* __GNUC__ && !__ARMCC_VERSION && MBEDTLS_SSL_CLI_C */
+
+
+/* [] END OF FILE */
+
@@ -0,0 +1,250 @@
+#******************************************************************************
+# File Name:   trace_decode.py
+#
+# Description: Host converter for the kernel event stream of trace_stream.c.
+# It reads the debug UART output, or a capture of it, and prints a timeline of
+# the task switches, the interrupts, the queue operations, the tickless idle,
+# and the network stack suspend and resume markers, followed by the wake
+# latency from each tickless idle exit to the first task other than idle.
+#
+#******************************************************************************
+# (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+#******************************************************************************
+# This software, including source code, documentation and related materials
+# ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+# subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+# protection (United States and foreign), United States copyright laws and
+# international treaty provisions. Therefore, you may use this Software only
+# as provided in the license agreement accompanying the software package from
+# which you obtained this Software ("EULA").
+#
+# If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+# non-transferable license to copy, modify, and compile the Software source
+# code solely for use in connection with Cypress's integrated circuit products.
+# Any reproduction, modification, translation, compilation, or representation
+# of this Software except as specified above is prohibited without the express
+# written permission of Cypress.
+#
+# Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+# EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+# WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+# reserves the right to make changes to the Software without notice. Cypress
+# does not assume any liability arising out of the application or use of the
+# Software or any product or circuit described in the Software. Cypress does
+# not authorize its products for use in any products where a malfunction or
+# failure of the Cypress product may reasonably be expected to result in
+# significant property damage, injury or death ("High Risk Product"). By
+# including Cypress's product in a High Risk Product, the manufacturer of such
+# system or application assumes all risk of such use and in doing so agrees to
+# indemnify Cypress against all liability.
+#******************************************************************************/
+
+#!/usr/bin/python
+
+"""
+Host converter for the kernel event stream of trace_stream.c.
+
+Usage:
+    python trace_decode.py -p COM3
+    python trace_decode.py -f capture.bin -c 100000000
+
+The serial port option needs the pyserial package. All other output on the
+debug UART, such as the text logs, is skipped.
+"""
+
+import optparse
+import struct
+import sys
+
+# Must match trace_stream.h and trace_stream.c.
+FRAME_SYNC = b'\xa5\x5c'
+EVENT_SIZE = 8
+
+EVT_SYNC = 0x1
+EVT_TASK_CREATE = 0x2
+EVT_TASK_NAME = 0x3
+EVT_TASK_SWITCH_IN = 0x4
+EVT_QUEUE_SEND = 0x5
+EVT_QUEUE_RECEIVE = 0x6
+EVT_QUEUE_BLOCK_SEND = 0x7
+EVT_QUEUE_BLOCK_RECEIVE = 0x8
+EVT_NOTIFY_FROM_ISR = 0x9
+EVT_LOW_POWER_BEGIN = 0xA
+EVT_LOW_POWER_END = 0xB
+EVT_MARK = 0xC
+EVT_DROPPED = 0xF
+
+# Events time stamped with the low-power timer instead of the cycle counter.
+LOW_POWER_TIMER_EVENTS = (EVT_SYNC, EVT_LOW_POWER_BEGIN, EVT_LOW_POWER_END)
+
+QUEUE_EVENTS = {
+    EVT_QUEUE_SEND: "queue send",
+    EVT_QUEUE_RECEIVE: "queue receive",
+    EVT_QUEUE_BLOCK_SEND: "block on queue send",
+    EVT_QUEUE_BLOCK_RECEIVE: "block on queue receive",
+}
+
+MARKS = {1: "network stack suspend wait", 2: "network stack resumed"}
+
+# The queue addresses are in the SRAM of the PSoC 6 MCU.
+SRAM_BASE = 0x08000000
+
+LOW_POWER_TIMER_HZ = 32768
+IDLE_TASK_NAME = "IDLE"
+
+class Timeline:
+    """Rebuilds the time of each event and prints the timeline. The cycle
+    counter stops in deep sleep, so the time is resynchronized with the
+    low-power timer on the tickless idle events."""
+
+    def __init__(self, cpu_hz, write):
+        self.cpu_hz = float(cpu_hz)
+        self.write = write
+        self.names = {}
+        self.time = 0.0
+        self.low_power_count = None
+        self.low_power_ticks = 0
+        self.cycles = None
+        self.wake_time = None
+        self.sleep_time = None
+        self.latencies = []
+
+    def task_name(self, number):
+        return self.names.get(number, "task #%d" % number)
+
+    def update_time(self, code, stamp):
+        if code in LOW_POWER_TIMER_EVENTS:
+            if self.low_power_count is not None:
+                self.low_power_ticks += (stamp - self.low_power_count) & 0xFFFFFFFF
+            self.low_power_count = stamp
+            self.time = max(self.time, self.low_power_ticks / float(LOW_POWER_TIMER_HZ))
+            self.cycles = None
+        elif self.cycles is None:
+            self.cycles = stamp
+        else:
+            self.time += ((stamp - self.cycles) & 0xFFFFFFFF) / self.cpu_hz
+            self.cycles = stamp
+
+    def event(self, stamp, info):
+        code = info & 0xF
+        context = (info >> 4) & 0xFF
+        arg = info >> 12
+
+        if code == EVT_TASK_NAME:
+            self.names[arg] = self.names.get(arg, "") + struct.pack('<I', stamp).rstrip(b'\0').decode('ascii', 'replace')
+            return
+
+        self.update_time(code, stamp)
+
+        if context == 0:
+            where = "task"
+        elif context >= 16:
+            where = "IRQ %d" % (context - 16)
+        else:
+            where = "exc %d" % context
+
+        if code == EVT_SYNC:
+            text = "trace start"
+        elif code == EVT_TASK_CREATE:
+            self.names[arg] = ""
+            text = "create task #%d" % arg
+        elif code == EVT_TASK_SWITCH_IN:
+            name = self.task_name(arg)
+            text = "switch to %s" % name
+            if self.wake_time is not None and name != IDLE_TASK_NAME:
+                self.latencies.append((self.wake_time, self.time - self.wake_time, name))
+                self.wake_time = None
+        elif code in QUEUE_EVENTS:
+            text = "%s 0x%08x" % (QUEUE_EVENTS[code], SRAM_BASE | arg)
+        elif code == EVT_NOTIFY_FROM_ISR:
+            text = "notify %s" % self.task_name(arg)
+        elif code == EVT_LOW_POWER_BEGIN:
+            self.sleep_time = self.time
+            text = "tickless idle begin"
+        elif code == EVT_LOW_POWER_END:
+            slept = (self.time - self.sleep_time) if self.sleep_time is not None else 0.0
+            self.wake_time = self.time
+            text = "tickless idle end, slept %.3f ms" % (slept * 1000.0)
+        elif code == EVT_MARK:
+            text = MARKS.get(arg, "marker %d" % arg)
+        elif code == EVT_DROPPED:
+            text = "%d events lost" % arg
+        else:
+            text = "unknown event 0x%x" % code
+
+        self.write("%12.6f  %-8s %s\n" % (self.time, where, text))
+
+    def summary(self):
+        if not self.latencies:
+            return
+        self.write("\nWake latency, from the tickless idle exit to the first task:\n")
+        for (wake_time, latency, name) in self.latencies:
+            self.write("%12.6f  %8.1f us  %s\n" % (wake_time, latency * 1e6, name))
+        values = [latency for (_, latency, _) in self.latencies]
+        self.write("min %.1f us, average %.1f us, max %.1f us over %d wakes\n" %
+                   (min(values) * 1e6, sum(values) * 1e6 / len(values), max(values) * 1e6, len(values)))
+
+def decode_stream(read, timeline):
+    """Finds the event frames in the byte stream."""
+    pending = b''
+
+    while True:
+        data = read()
+        if data is None:
+            break
+        pending += data
+
+        while True:
+            start = pending.find(FRAME_SYNC)
+            if start < 0:
+                pending = pending[-1:]
+                break
+            pending = pending[start:]
+
+            if len(pending) < 3:
+                break
+            count = pending[2]
+            frame_length = 3 + count * EVENT_SIZE + 1
+            if len(pending) < frame_length:
+                break
+
+            if count and (sum(pending[2:frame_length - 1]) & 0xFF) == pending[frame_length - 1]:
+                for index in range(count):
+                    stamp, info = struct.unpack_from('<II', pending, 3 + index * EVENT_SIZE)
+                    timeline.event(stamp, info)
+                pending = pending[frame_length:]
+            else:
+                # Not a frame.
+                pending = pending[1:]
+
+def write_text(text):
+    sys.stdout.write(text)
+    sys.stdout.flush()
+
+if __name__ == '__main__':
+    parser = optparse.OptionParser()
+    parser.add_option("-p", "--port", dest="port", help="Serial port of the debug UART.")
+    parser.add_option("-b", "--baud", dest="baud", type="int", default=115200, help="Baud rate [default: %default].")
+    parser.add_option("-f", "--file", dest="file", help="Capture of the debug UART output.")
+    parser.add_option("-c", "--cpu-hz", dest="cpu_hz", type="int", default=100000000,
+                      help="CM4 CPU clock frequency [default: %default].")
+
+    (options, args) = parser.parse_args()
+
+    if not options.port and not options.file:
+        parser.error("either a serial port or a capture file is required")
+
+    timeline = Timeline(options.cpu_hz, write_text)
+
+    try:
+        if options.file:
+            with open(options.file, 'rb') as capture:
+                decode_stream(lambda: capture.read(4096) or None, timeline)
+        else:
+            import serial
+            port = serial.Serial(options.port, options.baud, timeout=0.1)
+            decode_stream(lambda: port.read(4096), timeline)
+    except KeyboardInterrupt:
+        pass
+
+    timeline.summary()
@@ -0,0 +1,388 @@
+/*******************************************************************************
+ * File Name:   trace_stream.c
+ *
+ * Description: This file contains the kernel event stream used for the wake
+ * latency analysis. The FreeRTOS trace hooks set in FreeRTOSConfig.h record the
+ * task switches, the queue and semaphore operations, the task notifications
+ * from interrupts, and the tickless idle entry and exit into a small RAM ring,
+ * together with the application markers for the network stack suspend and
+ * resume. A low priority task streams the ring to the debug UART, and
+ * trace_decode.py converts the stream into a timeline on the host.
+ *
+ * Each event is two words. The first word is the DWT cycle count, or the
+ * low-power timer count for the events around deep sleep, when the cycle
+ * counter stops. The second word holds the event code, the active exception
+ * number (0 in a task), and a 20-bit argument.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+
+/* Include header files */
+#include "FreeRTOS.h"
+#include "task.h"
+#include <stdbool.h>
+#include <string.h>
+
+/* BSP & HAL includes. */
+#include "cy_device_headers.h"
+#include "cyhal.h"
+#include "cy_retarget_io.h"
+
+#include "trace_stream.h"
+#include "sleep_stats.h"
+#include "log_uart_dma.h"
+
+#if TRACE_STREAM
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Number of events in the ring. Must be a power of two. */
+#define TRACE_STREAM_RING_EVENTS             (256)
+
+/* The idle hook wakes up the streaming task when this many events are pending,
+ * so that the task switches of the streaming task do not keep it running.
+ */
+#define TRACE_STREAM_DRAIN_THRESHOLD         (64)
+
+/* Number of events per UART frame. */
+#define TRACE_STREAM_FRAME_EVENTS            (16)
+
+/* Frame: sync (2), event count (1), events, checksum (1). */
+#define TRACE_STREAM_FRAME_SYNC_0            (0xA5)
+#define TRACE_STREAM_FRAME_SYNC_1            (0x5C)
+#define TRACE_STREAM_FRAME_OVERHEAD          (4)
+
+#define TRACE_STREAM_TASK_STACK_SIZE         (configMINIMAL_STACK_SIZE * 2)
+#define TRACE_STREAM_TASK_PRIORITY           (tskIDLE_PRIORITY + 1)
+
+#define TRACE_STREAM_INFO(code, arg)         ((code) | ((__get_IPSR() & 0xFFUL) << 4) | \
+                                              (((arg) & 0xFFFFFUL) << 12))
+
+/*******************************************************************************
+ * Static Global Structures and variables
+ ******************************************************************************/
+typedef struct
+{
+    uint32_t time;
+    uint32_t info;
+} trace_stream_event_t;
+
+static trace_stream_event_t trace_stream_ring[TRACE_STREAM_RING_EVENTS];
+static volatile uint32_t trace_stream_head = 0;
+static volatile uint32_t trace_stream_tail = 0;
+static uint32_t trace_stream_dropped = 0;
+
+static TaskHandle_t trace_stream_task_handle = NULL;
+static bool trace_stream_ready = false;
+
+/*******************************************************************************
+ * Function definitions
+ ******************************************************************************/
+/*******************************************************************************
+* Function Name: trace_stream_put
+********************************************************************************
+* Summary:
+*  Writes an event into the ring. If the ring is full, the event is counted as
+*  dropped, and a DROPPED event is written once there is room again. Can be
+*  called from a task or an interrupt.
+*
+* Parameters:
+*  time : Time stamp, or the event data.
+*  info : Event code, exception number, and argument.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void trace_stream_put(uint32_t time, uint32_t info)
+{
+    UBaseType_t mask;
+    uint32_t head;
+
+    if (!trace_stream_ready)
+    {
+        return;
+    }
+
+    mask = taskENTER_CRITICAL_FROM_ISR();
+
+    head = trace_stream_head;
+    if ((0 != trace_stream_dropped) && ((head - trace_stream_tail) < (TRACE_STREAM_RING_EVENTS - 1)))
+    {
+        trace_stream_ring[head & (TRACE_STREAM_RING_EVENTS - 1)].time = DWT->CYCCNT;
+        trace_stream_ring[head & (TRACE_STREAM_RING_EVENTS - 1)].info =
+            TRACE_STREAM_INFO(TRACE_STREAM_EVT_DROPPED, trace_stream_dropped);
+        trace_stream_dropped = 0;
+        head++;
+    }
+
+    if ((head - trace_stream_tail) < TRACE_STREAM_RING_EVENTS)
+    {
+        trace_stream_ring[head & (TRACE_STREAM_RING_EVENTS - 1)].time = time;
+        trace_stream_ring[head & (TRACE_STREAM_RING_EVENTS - 1)].info = info;
+        head++;
+    }
+    else
+    {
+        trace_stream_dropped++;
+    }
+
+    trace_stream_head = head;
+
+    taskEXIT_CRITICAL_FROM_ISR(mask);
+}
+
+/*******************************************************************************
+* Function Name: trace_stream_event
+********************************************************************************
+* Summary:
+*  Records a kernel event with the cycle count. The queue operations of the
+*  streaming task itself are not recorded.
+*
+* Parameters:
+*  code : TRACE_STREAM_EVT_* event code.
+*  arg  : Task number or queue address.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void trace_stream_event(uint32_t code, uint32_t arg)
+{
+    if ((TRACE_STREAM_EVT_TASK_SWITCH_IN != code) && (0 == __get_IPSR()) &&
+        (NULL != trace_stream_task_handle) && (xTaskGetCurrentTaskHandle() == trace_stream_task_handle))
+    {
+        return;
+    }
+
+    trace_stream_put(DWT->CYCCNT, TRACE_STREAM_INFO(code, arg));
+}
+
+/*******************************************************************************
+* Function Name: trace_stream_task_create
+********************************************************************************
+* Summary:
+*  Records the creation of a task, followed by its name in chunks of four
+*  characters.
+*
+* Parameters:
+*  task_number : Task number.
+*  name        : Task name.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void trace_stream_task_create(uint32_t task_number, const char *name)
+{
+    uint32_t chunk;
+    size_t length = strnlen(name, configMAX_TASK_NAME_LEN);
+    size_t index;
+
+    trace_stream_put(DWT->CYCCNT, TRACE_STREAM_INFO(TRACE_STREAM_EVT_TASK_CREATE, task_number));
+
+    for (index = 0; index < length; index += sizeof(chunk))
+    {
+        chunk = 0;
+        memcpy(&chunk, &name[index], ((length - index) < sizeof(chunk)) ? (length - index) : sizeof(chunk));
+        trace_stream_put(chunk, TRACE_STREAM_INFO(TRACE_STREAM_EVT_TASK_NAME, task_number));
+    }
+}
+
+/*******************************************************************************
+* Function Name: trace_stream_low_power
+********************************************************************************
+* Summary:
+*  Records the entry to or exit from the tickless idle with the low-power timer
+*  count, which is used on the host to resynchronize the cycle count after
+*  deep sleep.
+*
+* Parameters:
+*  code : TRACE_STREAM_EVT_LOW_POWER_BEGIN or TRACE_STREAM_EVT_LOW_POWER_END.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void trace_stream_low_power(uint32_t code)
+{
+    trace_stream_put(sleep_stats_read_timer(), TRACE_STREAM_INFO(code, 0));
+}
+
+/*******************************************************************************
+* Function Name: trace_stream_mark
+********************************************************************************
+* Summary:
+*  Records an application marker and streams the pending events. Must be
+*  called from a task.
+*
+* Parameters:
+*  mark : TRACE_STREAM_MARK_* marker.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void trace_stream_mark(uint32_t mark)
+{
+    trace_stream_put(DWT->CYCCNT, TRACE_STREAM_INFO(TRACE_STREAM_EVT_MARK, mark));
+
+    if (NULL != trace_stream_task_handle)
+    {
+        xTaskNotifyGive(trace_stream_task_handle);
+    }
+}
+
+/*******************************************************************************
+* Function Name: trace_stream_on_idle
+********************************************************************************
+* Summary:
+*  Wakes up the streaming task if TRACE_STREAM_DRAIN_THRESHOLD events are
+*  pending. This is called from the idle hook.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void trace_stream_on_idle(void)
+{
+    if ((NULL != trace_stream_task_handle) &&
+        ((trace_stream_head - trace_stream_tail) >= TRACE_STREAM_DRAIN_THRESHOLD))
+    {
+        xTaskNotifyGive(trace_stream_task_handle);
+    }
+}
+
+/*******************************************************************************
+* Function Name: trace_stream_task
+********************************************************************************
+* Summary:
+*  Sends the pending events to the debug UART in frames of up to
+*  TRACE_STREAM_FRAME_EVENTS events.
+*
+* Parameters:
+*  arg : Unused.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void trace_stream_task(void *arg)
+{
+    static uint8_t frame[TRACE_STREAM_FRAME_OVERHEAD + (TRACE_STREAM_FRAME_EVENTS * sizeof(trace_stream_event_t))];
+    uint32_t tail;
+    uint32_t count;
+    uint32_t index;
+    uint8_t checksum;
+    size_t length;
+
+    (void)arg;
+
+    while (true)
+    {
+        (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        while (trace_stream_head != trace_stream_tail)
+        {
+            tail = trace_stream_tail;
+            count = trace_stream_head - tail;
+            if (count > TRACE_STREAM_FRAME_EVENTS)
+            {
+                count = TRACE_STREAM_FRAME_EVENTS;
+            }
+
+            frame[0] = TRACE_STREAM_FRAME_SYNC_0;
+            frame[1] = TRACE_STREAM_FRAME_SYNC_1;
+            frame[2] = (uint8_t)count;
+            length = 3;
+            for (index = 0; index < count; index++)
+            {
+                memcpy(&frame[length], &trace_stream_ring[(tail + index) & (TRACE_STREAM_RING_EVENTS - 1)],
+                       sizeof(trace_stream_event_t));
+                length += sizeof(trace_stream_event_t);
+            }
+
+            /* Releases the slots once copied. */
+            trace_stream_tail = tail + count;
+
+            checksum = 0;
+            for (index = 2; index < length; index++)
+            {
+                checksum += frame[index];
+            }
+            frame[length++] = checksum;
+
+#if LOG_UART_DMA
+            log_uart_dma_write(frame, length);
+#else
+            (void)cyhal_uart_write(&cy_retarget_io_uart_obj, frame, &length);
+#endif
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: trace_stream_init
+********************************************************************************
+* Summary:
+*  Starts the cycle counter, starts recording, and creates the streaming task.
+*  This is called in main() before the other tasks are created, so that the
+*  names of all the tasks are recorded.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void trace_stream_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    trace_stream_ready = true;
+    trace_stream_put(sleep_stats_read_timer(), TRACE_STREAM_INFO(TRACE_STREAM_EVT_SYNC, 0));
+
+    (void)xTaskCreate(trace_stream_task, "Trace", TRACE_STREAM_TASK_STACK_SIZE, NULL,
+                      TRACE_STREAM_TASK_PRIORITY, &trace_stream_task_handle);
+}
+
+#endif /* TRACE_STREAM */
+
+
+/* [] END OF FILE */
+
@@ -0,0 +1,84 @@
+/******************************************************************************
+* File Name: trace_stream.h
+*
+* Description: This file contains the interface of the kernel event stream
+* used for the wake latency analysis. It is included by FreeRTOSConfig.h, and
+* must not include the FreeRTOS headers.
+*
+******************************************************************************
+* Copyright (2020), Cypress Semiconductor Corporation.
+******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death (“High Risk Product”). By
+* including Cypress’s product in a High Risk Product, the manufacturer of such
+* system or application assumes all risk of such use and in doing so agrees to
+* indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef _TRACE_STREAM_H_
+#define _TRACE_STREAM_H_
+
+#include <stdint.h>
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Event codes. Must match trace_decode.py. */
+#define TRACE_STREAM_EVT_SYNC                (0x1)  /* Time is the low-power timer count. */
+#define TRACE_STREAM_EVT_TASK_CREATE         (0x2)  /* Argument is the task number. */
+#define TRACE_STREAM_EVT_TASK_NAME           (0x3)  /* Time holds 4 characters of the task name. */
+#define TRACE_STREAM_EVT_TASK_SWITCH_IN      (0x4)  /* Argument is the task number. */
+#define TRACE_STREAM_EVT_QUEUE_SEND          (0x5)  /* Argument is the queue address. */
+#define TRACE_STREAM_EVT_QUEUE_RECEIVE       (0x6)
+#define TRACE_STREAM_EVT_QUEUE_BLOCK_SEND    (0x7)
+#define TRACE_STREAM_EVT_QUEUE_BLOCK_RECEIVE (0x8)
+#define TRACE_STREAM_EVT_NOTIFY_FROM_ISR     (0x9)  /* Argument is the task number. */
+#define TRACE_STREAM_EVT_LOW_POWER_BEGIN     (0xA)  /* Time is the low-power timer count. */
+#define TRACE_STREAM_EVT_LOW_POWER_END       (0xB)  /* Time is the low-power timer count. */
+#define TRACE_STREAM_EVT_MARK                (0xC)  /* Argument is the marker. */
+#define TRACE_STREAM_EVT_DROPPED             (0xF)  /* Argument is the number of lost events. */
+
+/* Application markers. */
+#define TRACE_STREAM_MARK_NET_SUSPEND        (1)    /* Waiting for network inactivity to suspend. */
+#define TRACE_STREAM_MARK_NET_RESUME         (2)    /* The network stack has resumed. */
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+void trace_stream_init(void);
+void trace_stream_event(uint32_t code, uint32_t arg);
+void trace_stream_task_create(uint32_t task_number, const char *name);
+void trace_stream_low_power(uint32_t code);
+void trace_stream_mark(uint32_t mark);
+void trace_stream_on_idle(void);
+
+#endif /* _TRACE_STREAM_H_ */
+
+
+/* [] END OF FILE */
+
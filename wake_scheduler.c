@@ -0,0 +1,757 @@
+/*******************************************************************************
+ * File Name:   wake_scheduler.c
+ *
+ * Description: This file contains the wake scheduler. It collects the periodic
+ * host network duties, such as the DHCP lease renewal, the IGMP and MLD
+ * reports, the WLAN ARP host IP table refresh, and application heartbeats, and
+ * runs them in shared wake windows.
+ *
+ * The lwIP timers do not run while the network stack is suspended, so each of
+ * these duties would otherwise need a network stack resume of its own, or be
+ * delayed until an unrelated wake. The scheduler bounds the suspend time by
+ * the earliest duty, and when the host wakes up for any reason, it also runs
+ * all the duties which are due within WAKE_SCHED_SLACK_MS. Each merged duty
+ * saves a full resume and suspend cycle of the network stack.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+
+/* Include header files */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "timers.h"
+#include "iot_wifi.h"
+#include "iot_wifi_common.h"
+#include <stdbool.h>
+#include <lwip/netif.h>
+#include <lwip/dhcp.h>
+#include <lwip/prot/dhcp.h>
+#include <lwip/igmp.h>
+#include <lwip/prot/igmp.h>
+#include <lwip/tcpip.h>
+
+/* Low Power Assistant header files. */
+#include "network_activity_handler.h"
+
+/* Low Power Assistant offload and the network configuration. */
+#include "wlan_offload.h"
+#include "wake_scheduler.h"
+#include "wifi_config.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* A duty which is still due right after it has run is retried after this delay
+ * at the earliest, so that a failing duty does not keep the host awake.
+ */
+#define WAKE_SCHED_RETRY_MS                  (10000UL)
+
+/* Time for which the network stack is kept resumed for the DHCP ACK. */
+#define WAKE_SCHED_DHCP_HOLD_MS              (1000UL)
+
+/* Minimum time between the DHCP requests in the RENEWING and REBINDING states,
+ * as in RFC 2131.
+ */
+#define WAKE_SCHED_DHCP_RETRY_MIN_MS         (60000UL)
+
+/* DHCP lease time of an infinite lease. */
+#define WAKE_SCHED_INFINITE_LEASE            (0xFFFFFFFFUL)
+
+#define WAKE_SCHED_TICKS_TO_MS(ticks)        ((uint32_t)(ticks) * portTICK_PERIOD_MS)
+
+/*******************************************************************************
+ * Static Global Structures and variables
+ ******************************************************************************/
+/* Periodic host network duty. */
+typedef struct
+{
+    const char *name;
+    uint32_t period_ms;                /* Fixed period, or 0 if get_next_ms is used. */
+    wake_sched_next_fn_t get_next_ms;  /* Time until due, for duties with a runtime period. */
+    wake_sched_run_fn_t run;
+    uint32_t hold_ms;                  /* Time the network stack is kept resumed after the run. */
+    TickType_t last_run;               /* Tick at which the duty last ran. */
+    bool has_run;
+    bool passive;                      /* Only run in the wake windows of other wakes. */
+} wake_sched_duty_t;
+
+static wake_sched_duty_t wake_sched_duties[WAKE_SCHED_MAX_DUTIES];
+static uint32_t wake_sched_duty_count = 0;
+
+/* Time for which the network stack may stay suspended, counted from
+ * wake_sched_armed_at, while the application task waits in wait_net_suspend().
+ */
+static bool wake_sched_suspended = false;
+static TickType_t wake_sched_armed_at;
+static uint32_t wake_sched_armed_ms = portMAX_DELAY;
+
+/* Resumes the network stack for a deadline given to wake_sched_kick(). */
+static TimerHandle_t wake_sched_kick_timer = NULL;
+
+#if LWIP_DHCP
+/* Tick at which the current DHCP lease was bound, and the DHCP state, as seen
+ * by the scheduler, and the tick of the last renewal or rebinding request.
+ */
+static TickType_t wake_sched_dhcp_bound_since;
+static uint8_t wake_sched_dhcp_state = DHCP_STATE_OFF;
+static TickType_t wake_sched_dhcp_last_request;
+#endif
+
+#if LWIP_IGMP
+/* Tick at which the IGMP reports were last sent. */
+static TickType_t wake_sched_igmp_last_report;
+#endif
+
+/*******************************************************************************
+ * Function definitions
+ ******************************************************************************/
+#if LWIP_DHCP
+/*******************************************************************************
+* Function Name: wake_sched_dhcp_get_lease
+********************************************************************************
+* Summary:
+*  Returns the DHCP data of the interface while it holds a lease, bound or in
+*  renewal, and takes the bound tick when a lease is bound. The lease is
+*  counted from this tick until it is bound again, and the requests of the
+*  renewal from the tick at which its state was entered.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  struct dhcp *: DHCP data of the interface, or NULL if it holds no lease.
+*
+*******************************************************************************/
+static struct dhcp *wake_sched_dhcp_get_lease(void)
+{
+    struct dhcp *dhcp = netif_dhcp_data(cy_lwip_get_interface());
+    uint8_t state = (NULL != dhcp) ? dhcp->state : DHCP_STATE_OFF;
+
+    if (state != wake_sched_dhcp_state)
+    {
+        if (DHCP_STATE_BOUND == state)
+        {
+            wake_sched_dhcp_bound_since = xTaskGetTickCount();
+        }
+        else
+        {
+            /* lwIP sent the first request of the RENEWING or REBINDING state. */
+            wake_sched_dhcp_last_request = xTaskGetTickCount();
+        }
+    }
+
+    wake_sched_dhcp_state = state;
+
+    if ((DHCP_STATE_BOUND != state) && (DHCP_STATE_RENEWING != state) &&
+        (DHCP_STATE_REBINDING != state))
+    {
+        return NULL;
+    }
+
+    if ((0 == dhcp->offered_t1_renew) || (WAKE_SCHED_INFINITE_LEASE == dhcp->offered_t1_renew))
+    {
+        return NULL;
+    }
+
+    return dhcp;
+}
+
+/*******************************************************************************
+* Function Name: wake_sched_dhcp_get_retry_tick
+********************************************************************************
+* Summary:
+*  Returns the tick of the next DHCPREQUEST in the RENEWING or REBINDING state.
+*  As in RFC 2131, the request is sent again after half the time remaining
+*  until the given deadline, but no sooner than WAKE_SCHED_DHCP_RETRY_MIN_MS.
+*
+* Parameters:
+*  deadline : Tick of T2 in the RENEWING state, or of the lease expiry in the
+*             REBINDING state.
+*
+* Return:
+*  TickType_t: Tick of the next request, never after the deadline.
+*
+*******************************************************************************/
+static TickType_t wake_sched_dhcp_get_retry_tick(TickType_t deadline)
+{
+    TickType_t remaining = deadline - wake_sched_dhcp_last_request;
+    TickType_t wait = remaining / 2;
+
+    if (((int32_t)remaining <= 0) || (remaining <= pdMS_TO_TICKS(WAKE_SCHED_DHCP_RETRY_MIN_MS)))
+    {
+        return deadline;
+    }
+
+    if (wait < pdMS_TO_TICKS(WAKE_SCHED_DHCP_RETRY_MIN_MS))
+    {
+        wait = pdMS_TO_TICKS(WAKE_SCHED_DHCP_RETRY_MIN_MS);
+    }
+
+    return wake_sched_dhcp_last_request + wait;
+}
+
+/*******************************************************************************
+* Function Name: wake_sched_dhcp_get_next_ms
+********************************************************************************
+* Summary:
+*  Returns the time until the next step of the DHCP lease: T1 while the lease
+*  is bound, the next renewal request or T2 in the RENEWING state, and the
+*  next rebinding request or the lease expiry in the REBINDING state. lwIP
+*  counts these times with its coarse timer, which does not run while the
+*  network stack is suspended, so the scheduler counts them from the tick at
+*  which the lease was bound.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  uint32_t: Time in milliseconds until the next step, or portMAX_DELAY if
+*  the interface holds no lease.
+*
+*******************************************************************************/
+static uint32_t wake_sched_dhcp_get_next_ms(void)
+{
+    struct dhcp *dhcp = wake_sched_dhcp_get_lease();
+    TickType_t now = xTaskGetTickCount();
+    TickType_t due;
+
+    if (NULL == dhcp)
+    {
+        return portMAX_DELAY;
+    }
+
+    if (DHCP_STATE_BOUND == dhcp->state)
+    {
+        due = wake_sched_dhcp_bound_since + (TickType_t)dhcp->offered_t1_renew * configTICK_RATE_HZ;
+    }
+    else if (DHCP_STATE_RENEWING == dhcp->state)
+    {
+        due = wake_sched_dhcp_get_retry_tick(wake_sched_dhcp_bound_since +
+                                             (TickType_t)dhcp->offered_t2_rebind * configTICK_RATE_HZ);
+    }
+    else
+    {
+        due = wake_sched_dhcp_get_retry_tick(wake_sched_dhcp_bound_since +
+                                             (TickType_t)dhcp->offered_t0_lease * configTICK_RATE_HZ);
+    }
+
+    return ((int32_t)(due - now) <= 0) ? 0 : WAKE_SCHED_TICKS_TO_MS(due - now);
+}
+
+/*******************************************************************************
+* Function Name: wake_sched_dhcp_renew
+********************************************************************************
+* Summary:
+*  Takes the next step of the DHCP lease. Before T2, the renewal request is
+*  sent to the server of the lease. From T2, the rebinding request is sent by
+*  expiring the rebinding timer of lwIP, since lwIP has no API to start the
+*  rebinding. Once the lease has expired, it is released and the DHCP
+*  discovery is started again, as lwIP does.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void wake_sched_dhcp_renew(void)
+{
+    struct netif *netif = cy_lwip_get_interface();
+    struct dhcp *dhcp;
+    TickType_t elapsed;
+
+    LOCK_TCPIP_CORE();
+
+    dhcp = wake_sched_dhcp_get_lease();
+
+    if (NULL != dhcp)
+    {
+        elapsed = xTaskGetTickCount() - wake_sched_dhcp_bound_since;
+        wake_sched_dhcp_last_request = xTaskGetTickCount();
+
+        if (elapsed >= (TickType_t)dhcp->offered_t0_lease * configTICK_RATE_HZ)
+        {
+            APP_INFO(("DHCP lease expired. Restarting the DHCP discovery.\n"));
+            dhcp_release_and_stop(netif);
+            if (ERR_OK != dhcp_start(netif))
+            {
+                ERR_INFO(("Failed to start the DHCP discovery.\n"));
+            }
+        }
+        else if (elapsed >= (TickType_t)dhcp->offered_t2_rebind * configTICK_RATE_HZ)
+        {
+            dhcp->t2_rebind_time = 1;
+            dhcp_coarse_tmr();
+        }
+        else if (ERR_OK != dhcp_renew(netif))
+        {
+            ERR_INFO(("Failed to start the DHCP renewal.\n"));
+        }
+    }
+
+    UNLOCK_TCPIP_CORE();
+}
+#endif /* LWIP_DHCP */
+
+#if LWIP_IGMP
+/*******************************************************************************
+* Function Name: wake_sched_igmp_get_next_ms
+********************************************************************************
+* Summary:
+*  Returns the time until the IGMP reports are due. A report which lwIP delays
+*  in response to a Query is due at once. The unsolicited reports are due
+*  every WAKE_SCHED_IGMP_REPORT_INTERVAL_SEC seconds, and only while a group
+*  other than the all systems group is joined.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  uint32_t: Time in milliseconds until the reports are due, or portMAX_DELAY
+*  if no report is scheduled.
+*
+*******************************************************************************/
+static uint32_t wake_sched_igmp_get_next_ms(void)
+{
+    struct igmp_group *group = netif_igmp_data(cy_lwip_get_interface());
+    TickType_t report_ticks = pdMS_TO_TICKS(WAKE_SCHED_IGMP_REPORT_INTERVAL_SEC * 1000UL);
+    TickType_t elapsed;
+
+    /* The first group is the all systems group, which is never reported. */
+    if ((NULL == group) || (NULL == group->next))
+    {
+        return portMAX_DELAY;
+    }
+
+    for (group = group->next; NULL != group; group = group->next)
+    {
+        if (IGMP_GROUP_DELAYING_MEMBER == group->group_state)
+        {
+            return 0;
+        }
+    }
+
+    if (0 == report_ticks)
+    {
+        return portMAX_DELAY;
+    }
+
+    elapsed = xTaskGetTickCount() - wake_sched_igmp_last_report;
+
+    return (elapsed >= report_ticks) ? 0 : WAKE_SCHED_TICKS_TO_MS(report_ticks - elapsed);
+}
+
+/*******************************************************************************
+* Function Name: wake_sched_igmp_report
+********************************************************************************
+* Summary:
+*  Schedules the IGMP reports of all the IPv4 multicast groups of the
+*  interface. This also replaces any longer delay requested by a Query
+*  received while the network stack was suspended.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void wake_sched_igmp_report(void)
+{
+    struct netif *netif = cy_lwip_get_interface();
+
+    LOCK_TCPIP_CORE();
+
+    if (netif_is_up(netif) && !ip4_addr_isany_val(*netif_ip4_addr(netif)))
+    {
+        igmp_report_groups(netif);
+    }
+
+    UNLOCK_TCPIP_CORE();
+
+    wake_sched_igmp_last_report = xTaskGetTickCount();
+}
+#endif /* LWIP_IGMP */
+
+/*******************************************************************************
+* Function Name: wake_sched_duty_next_ms
+********************************************************************************
+* Summary:
+*  Returns the time until the given duty is due.
+*
+* Parameters:
+*  duty : Registered duty.
+*  now  : Current tick count.
+*
+* Return:
+*  uint32_t: Time in milliseconds until the duty is due, or portMAX_DELAY if
+*  it is not scheduled.
+*
+*******************************************************************************/
+static uint32_t wake_sched_duty_next_ms(const wake_sched_duty_t *duty, TickType_t now)
+{
+    uint32_t elapsed_ms = WAKE_SCHED_TICKS_TO_MS(now - duty->last_run);
+
+    if (NULL != duty->get_next_ms)
+    {
+        return duty->get_next_ms();
+    }
+
+    return (elapsed_ms >= duty->period_ms) ? 0 : (duty->period_ms - elapsed_ms);
+}
+
+/*******************************************************************************
+* Function Name: wake_sched_kick_expired
+********************************************************************************
+* Summary:
+*  Timer callback for a deadline given to wake_sched_kick(). It reports network
+*  activity, which resumes the suspended network stack, so that the application
+*  task runs the duties and waits again with the earlier deadline. If the
+*  network stack has not been suspended yet, the network activity is reported
+*  again every INACTIVE_INTERVAL_MS until it is.
+*
+* Parameters:
+*  timer : Kick timer.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void wake_sched_kick_expired(TimerHandle_t timer)
+{
+    if (wake_sched_suspended)
+    {
+        cy_network_activity_notify(CY_NETWORK_ACTIVITY_TX);
+        (void)xTimerChangePeriod(timer, pdMS_TO_TICKS(INACTIVE_INTERVAL_MS), 0);
+    }
+}
+
+/*******************************************************************************
+* Function Name: wake_sched_init
+********************************************************************************
+* Summary:
+*  Initializes the wake scheduler and registers the lwIP duties, the DHCP
+*  lease renewal and the IGMP reports.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void wake_sched_init(void)
+{
+    wake_sched_duty_count = 0;
+
+    if (NULL == wake_sched_kick_timer)
+    {
+        wake_sched_kick_timer = xTimerCreate("Wake kick", 1, pdFALSE, NULL, wake_sched_kick_expired);
+        if (NULL == wake_sched_kick_timer)
+        {
+            ERR_INFO(("Failed to create the wake kick timer.\n"));
+        }
+    }
+
+#if LWIP_DHCP
+    (void)wake_sched_register("DHCP renew", 0, wake_sched_dhcp_get_next_ms,
+                              wake_sched_dhcp_renew, WAKE_SCHED_DHCP_HOLD_MS);
+#endif
+#if LWIP_IGMP
+    wake_sched_igmp_last_report = xTaskGetTickCount();
+    (void)wake_sched_register("IGMP report", 0, wake_sched_igmp_get_next_ms,
+                              wake_sched_igmp_report, WAKE_SCHED_REPORT_HOLD_MS);
+#endif
+}
+
+/*******************************************************************************
+* Function Name: wake_sched_register
+********************************************************************************
+* Summary:
+*  Registers a periodic host network duty, such as an application heartbeat or
+*  a keepalive which is not offloaded to the WLAN device. A duty either has a
+*  fixed period counted from its last run, or a get_next_ms function for a
+*  period which changes at runtime. This must be called from the task which
+*  runs the scheduler.
+*
+* Parameters:
+*  name        : Name of the duty, used in the debug messages.
+*  period_ms   : Fixed period in milliseconds. Ignored if get_next_ms is given.
+*  get_next_ms : Returns the time until the duty is due, or NULL.
+*  run         : Runs the duty.
+*  hold_ms     : Time in milliseconds for which the network stack must stay
+*                resumed after the run, for the packets of the duty to go out.
+*
+* Return:
+*  cy_rslt_t: Returns CY_RSLT_SUCCESS if the duty is registered. Otherwise, it
+*  returns CY_RSLT_TYPE_ERROR.
+*
+*******************************************************************************/
+cy_rslt_t wake_sched_register(const char *name, uint32_t period_ms, wake_sched_next_fn_t get_next_ms,
+                              wake_sched_run_fn_t run, uint32_t hold_ms)
+{
+    wake_sched_duty_t *duty;
+
+    if ((NULL == run) || ((0 == period_ms) && (NULL == get_next_ms)) ||
+        (WAKE_SCHED_MAX_DUTIES <= wake_sched_duty_count))
+    {
+        ERR_INFO(("Failed to register the wake duty %s.\n", name));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    duty = &wake_sched_duties[wake_sched_duty_count];
+    duty->name = name;
+    duty->period_ms = period_ms;
+    duty->get_next_ms = get_next_ms;
+    duty->run = run;
+    duty->hold_ms = hold_ms;
+    duty->last_run = xTaskGetTickCount();
+    duty->has_run = false;
+    duty->passive = false;
+    wake_sched_duty_count++;
+
+    return CY_RSLT_SUCCESS;
+}
+
+/*******************************************************************************
+* Function Name: wake_sched_register_passive
+********************************************************************************
+* Summary:
+*  Registers a periodic duty which is run only in the wake windows of the
+*  other wakes, such as a debug report. It never limits the time the network
+*  stack stays suspended, so it does not wake the host by itself. This must be
+*  called from the task which runs the scheduler.
+*
+* Parameters:
+*  name      : Name of the duty, used in the debug messages.
+*  period_ms : Period in milliseconds.
+*  run       : Runs the duty.
+*
+* Return:
+*  cy_rslt_t: Returns CY_RSLT_SUCCESS if the duty is registered. Otherwise, it
+*  returns CY_RSLT_TYPE_ERROR.
+*
+*******************************************************************************/
+cy_rslt_t wake_sched_register_passive(const char *name, uint32_t period_ms, wake_sched_run_fn_t run)
+{
+    cy_rslt_t result = wake_sched_register(name, period_ms, NULL, run, 0);
+
+    if (CY_RSLT_SUCCESS == result)
+    {
+        wake_sched_duties[wake_sched_duty_count - 1].passive = true;
+    }
+
+    return result;
+}
+
+/*******************************************************************************
+* Function Name: wake_sched_get_next_ms
+********************************************************************************
+* Summary:
+*  Returns the time until the earliest registered duty is due. The network
+*  stack must not stay suspended longer than this. A duty which has just run
+*  and is still due is not retried before WAKE_SCHED_RETRY_MS. The passive
+*  duties are not included. While the network stack is suspended, a duty
+*  which becomes due earlier than this is reported with wake_sched_kick().
+*
+* Parameters:
+*  void
+*
+* Return:
+*  uint32_t: Time in milliseconds until the next duty, or portMAX_DELAY if no
+*  duty is scheduled.
+*
+*******************************************************************************/
+uint32_t wake_sched_get_next_ms(void)
+{
+    TickType_t now = xTaskGetTickCount();
+    uint32_t next_ms = portMAX_DELAY;
+    uint32_t duty_ms;
+    uint32_t since_run_ms;
+    uint32_t index;
+
+    for (index = 0; index < wake_sched_duty_count; index++)
+    {
+        if (wake_sched_duties[index].passive)
+        {
+            continue;
+        }
+
+        duty_ms = wake_sched_duty_next_ms(&wake_sched_duties[index], now);
+
+        since_run_ms = WAKE_SCHED_TICKS_TO_MS(now - wake_sched_duties[index].last_run);
+        if (wake_sched_duties[index].has_run && (since_run_ms < WAKE_SCHED_RETRY_MS) &&
+            (duty_ms < (WAKE_SCHED_RETRY_MS - since_run_ms)))
+        {
+            duty_ms = WAKE_SCHED_RETRY_MS - since_run_ms;
+        }
+
+        if (duty_ms < next_ms)
+        {
+            next_ms = duty_ms;
+        }
+    }
+
+    taskENTER_CRITICAL();
+    wake_sched_armed_at = now;
+    wake_sched_armed_ms = next_ms;
+    taskEXIT_CRITICAL();
+
+    return next_ms;
+}
+
+/*******************************************************************************
+* Function Name: wake_sched_set_network_suspended
+********************************************************************************
+* Summary:
+*  Marks the time in which the application task waits in wait_net_suspend()
+*  with the time returned by wake_sched_get_next_ms(). A deadline given to
+*  wake_sched_kick() in this time which is earlier resumes the network stack.
+*
+* Parameters:
+*  suspended : true before wait_net_suspend() is called, false after it
+*              returns.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void wake_sched_set_network_suspended(bool suspended)
+{
+    taskENTER_CRITICAL();
+    wake_sched_suspended = suspended;
+    wake_sched_armed_ms = portMAX_DELAY;
+    taskEXIT_CRITICAL();
+
+    if ((!suspended) && (NULL != wake_sched_kick_timer))
+    {
+        (void)xTimerStop(wake_sched_kick_timer, 0);
+    }
+}
+
+/*******************************************************************************
+* Function Name: wake_sched_kick
+********************************************************************************
+* Summary:
+*  Reports that a duty has become due earlier, such as when a message with a
+*  short delay is queued. The time until the network stack is resumed is read
+*  once, before it is suspended, so an earlier deadline would otherwise wait
+*  for the next wake. If the network stack is suspended for longer than
+*  next_ms, it is resumed when the deadline is reached. This can be called
+*  from any task.
+*
+* Parameters:
+*  next_ms : Time in milliseconds until the duty is due.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+void wake_sched_kick(uint32_t next_ms)
+{
+    uint32_t elapsed_ms;
+    bool earlier = false;
+
+    taskENTER_CRITICAL();
+    if (wake_sched_suspended)
+    {
+        elapsed_ms = WAKE_SCHED_TICKS_TO_MS(xTaskGetTickCount() - wake_sched_armed_at);
+        if ((portMAX_DELAY == wake_sched_armed_ms) ||
+            ((elapsed_ms < wake_sched_armed_ms) && (next_ms < (wake_sched_armed_ms - elapsed_ms))))
+        {
+            wake_sched_armed_at = xTaskGetTickCount();
+            wake_sched_armed_ms = next_ms;
+            earlier = true;
+        }
+    }
+    taskEXIT_CRITICAL();
+
+    if (earlier && (NULL != wake_sched_kick_timer))
+    {
+        (void)xTimerChangePeriod(wake_sched_kick_timer,
+                                 (0 == pdMS_TO_TICKS(next_ms)) ? 1 : pdMS_TO_TICKS(next_ms), 0);
+    }
+}
+
+/*******************************************************************************
+* Function Name: wake_sched_run
+********************************************************************************
+* Summary:
+*  Runs all the duties which are due within WAKE_SCHED_SLACK_MS. This is called
+*  in the host wake window after the network stack resumes, regardless of what
+*  woke the host up.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  uint32_t: Time in milliseconds for which the network stack must stay
+*  resumed before it is suspended again.
+*
+*******************************************************************************/
+uint32_t wake_sched_run(void)
+{
+    TickType_t now = xTaskGetTickCount();
+    uint32_t hold_ms = 0;
+    wake_sched_duty_t *duty;
+    uint32_t index;
+
+    for (index = 0; index < wake_sched_duty_count; index++)
+    {
+        duty = &wake_sched_duties[index];
+
+        if (duty->has_run && (WAKE_SCHED_TICKS_TO_MS(now - duty->last_run) < WAKE_SCHED_RETRY_MS))
+        {
+            continue;
+        }
+
+        if (wake_sched_duty_next_ms(duty, now) <= WAKE_SCHED_SLACK_MS)
+        {
+            APP_INFO(("Running wake duty: %s\n", duty->name));
+            duty->run();
+            duty->last_run = xTaskGetTickCount();
+            duty->has_run = true;
+
+            if (duty->hold_ms > hold_ms)
+            {
+                hold_ms = duty->hold_ms;
+            }
+        }
+    }
+
+    return hold_ms;
+}
+
+
+/* [] END OF FILE */
+
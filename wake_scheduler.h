@@ -0,0 +1,84 @@
+/******************************************************************************
+* File Name: wake_scheduler.h
+*
+* Description: This file contains the interface of the wake scheduler which
+* runs the periodic host network duties in shared wake windows.
+*
+******************************************************************************
+* Copyright (2020), Cypress Semiconductor Corporation.
+******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death (“High Risk Product”). By
+* including Cypress’s product in a High Risk Product, the manufacturer of such
+* system or application assumes all risk of such use and in doing so agrees to
+* indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef _WAKE_SCHEDULER_H_
+#define _WAKE_SCHEDULER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cy_result.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Hold time of the IGMP and MLD report duties. lwIP sends the reports with a
+ * random delay of up to 500 ms.
+ */
+#define WAKE_SCHED_REPORT_HOLD_MS            (600UL)
+
+/*******************************************************************************
+ * Type Definitions
+ ******************************************************************************/
+/* Returns the time in milliseconds until the duty is due, or portMAX_DELAY if
+ * it is not scheduled. Used for duties with a period that changes at runtime.
+ */
+typedef uint32_t (*wake_sched_next_fn_t)(void);
+
+/* Runs the duty. */
+typedef void (*wake_sched_run_fn_t)(void);
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+void wake_sched_init(void);
+cy_rslt_t wake_sched_register(const char *name, uint32_t period_ms, wake_sched_next_fn_t get_next_ms,
+                              wake_sched_run_fn_t run, uint32_t hold_ms);
+cy_rslt_t wake_sched_register_passive(const char *name, uint32_t period_ms, wake_sched_run_fn_t run);
+uint32_t wake_sched_get_next_ms(void);
+void wake_sched_set_network_suspended(bool suspended);
+void wake_sched_kick(uint32_t next_ms);
+uint32_t wake_sched_run(void);
+
+#endif /* _WAKE_SCHEDULER_H_ */
+
+
+/* [] END OF FILE */
+
@@ -56,8 +56,144 @@
 #define MAX_WIFI_RETRY_COUNT                     (3)
 #define NULL_IP_ADDRESS                          "0.0.0.0"
 
-#define APP_INFO(x)                              do { configPRINTF(("Info: ")); configPRINTF(x); } while(0);
-#define ERR_INFO(x)                              do { configPRINTF(("Error: ")); configPRINTF(x); } while(0);
+/* Enable(1) or Disable(0) the binary deferred logging of APP_INFO and ERR_INFO.
+ * When enabled, the messages are sent to the debug UART as binary records which
+ * are decoded on the host with app_log_decode.py. See app_log.c.
+ */
+#define APP_LOG_BINARY                           (0)
+
+/* Enable(1) or Disable(0) the logging benchmark, which prints the CPU cycles
+ * spent per log line by each logging method at startup. See app_log_benchmark.c.
+ */
+#define APP_LOG_BENCHMARK                        (0)
+
+/* Log levels. A lower value is more severe. */
+#define APP_LOG_LEVEL_ERROR                      (1)
+#define APP_LOG_LEVEL_INFO                       (2)
+
+/* Log records at or below this level are also kept in the retained log, which
+ * survives a reset. See retained_log.c.
+ */
+#define RETAINED_LOG_CAPTURE_LEVEL               APP_LOG_LEVEL_INFO
+
+/* While the network stack is suspended, log records less severe than this level
+ * are held back, so that they do not wake up the logging task and the UART.
+ * They are sent in one burst on the next wake. See RETAINED_LOG_DEFERRED_SIZE.
+ */
+#define APP_LOG_SUSPENDED_LEVEL                  APP_LOG_LEVEL_ERROR
+
+/* Enable(1) or Disable(0) resetting the device after a fault is recorded in the
+ * retained log, instead of halting in the fault hook.
+ */
+#define RETAINED_LOG_RESET_ON_FAULT              (0)
+
+/* Enable(1) or Disable(0) measuring the time spent in active, sleep, and deep
+ * sleep modes. See sleep_stats.c.
+ */
+#define SLEEP_STATS                              (1)
+
+/* The sleep residency is printed in the first host wake window after every
+ * SLEEP_STATS_REPORT_INTERVAL_SEC seconds. The report does not wake the host
+ * by itself. Set to 0 to only read it with sleep_stats_get().
+ */
+#define SLEEP_STATS_REPORT_INTERVAL_SEC          (600UL)
+
+/* Enable(1) or Disable(0) the network throughput benchmark. The device listens
+ * for the bulk transfers of net_benchmark.py on NET_BENCHMARK_PORT, where the
+ * payload is read in place in the WHD receive buffers with the lwIP raw API,
+ * and on NET_BENCHMARK_PORT + 1, where it is copied out with the socket API.
+ * See net_benchmark.c.
+ */
+#define NET_BENCHMARK                            (0)
+#define NET_BENCHMARK_PORT                       (50010)
+
+/* Enable(1) or Disable(0) the TLS session cache, which lets the secure sockets
+ * resume the last session with each of up to TLS_SESSION_CACHE_ENTRIES servers
+ * instead of running a full handshake. The time and the CPU active time of the
+ * full and the resumed handshakes are printed in the first host wake window
+ * after every TLS_SESSION_CACHE_REPORT_INTERVAL_SEC seconds, once a handshake
+ * has been made. Set the interval to 0 to only
+ * print each handshake. See tls_session_cache.c.
+ */
+#define TLS_SESSION_CACHE                        (1)
+#define TLS_SESSION_CACHE_ENTRIES                (2)
+#define TLS_SESSION_CACHE_REPORT_INTERVAL_SEC    (600UL)
+
+/* Enable(1) or Disable(0) the MQTT client, which connects to the broker on the
+ * TCP Keepalive offload connection TKO_MQTT_CONN_INDEX in wlan_offload.h. The
+ * WLAN device keeps the idle connection alive. With MQTT_CLIENT_KEEP_ALIVE_SEC
+ * set to 0, the broker does not expect a PINGREQ either, and an idle connection
+ * costs no host wakes. For a broker which enforces a keepalive, the PINGREQ is
+ * sent in a shared host wake window once MQTT_CLIENT_PING_PERCENT of the
+ * keepalive has passed without any other packet to the broker. See
+ * mqtt_client.c.
+ */
+#define MQTT_CLIENT                              (0)
+#define MQTT_CLIENT_ID                           "psoc6-lpa"
+#define MQTT_CLIENT_KEEP_ALIVE_SEC               (0)
+#define MQTT_CLIENT_PING_PERCENT                 (75UL)
+
+/* Topic filters which the MQTT client subscribes with QoS 1 on the TCP Keepalive
+ * offload connection. A message on these topics reaches the host, and wakes it
+ * up, as soon as it arrives. Use { NULL } for none.
+ */
+#define MQTT_URGENT_TOPICS                       { MQTT_CLIENT_ID "/cmd/#" }
+
+/* Enable(1) or Disable(0) the deferred MQTT session. The topic filters of
+ * MQTT_DEFERRED_TOPICS are subscribed with QoS 1 by a persistent session, which
+ * is connected only in a host wake window every MQTT_DEFERRED_POLL_INTERVAL_SEC
+ * seconds. In between, the broker holds their messages for the session, so they
+ * do not wake the host. See mqtt_deferred.c.
+ */
+#define MQTT_DEFERRED_SESSION                    (1)
+#define MQTT_DEFERRED_CLIENT_ID                  MQTT_CLIENT_ID "-deferred"
+#define MQTT_DEFERRED_TOPICS                     { MQTT_CLIENT_ID "/config/#", SHADOW_CLIENT_DELTA_TOPIC }
+#define MQTT_DEFERRED_POLL_INTERVAL_SEC          (900UL)
+
+/* Enable(1) or Disable(0) batching the MQTT publishes of mqtt_batch_publish().
+ * The messages are encoded into an arena of MQTT_BATCH_ARENA_SIZE bytes, and
+ * sent together in the host wake window of the earliest message deadline.
+ * See mqtt_batch.c.
+ */
+#define MQTT_BATCH                               (1)
+#define MQTT_BATCH_ARENA_SIZE                    (1024)
+
+/* Enable(1) or Disable(0) the Device Shadow client of the thing
+ * SHADOW_CLIENT_THING_NAME. Only the fields which have changed are reported,
+ * in one update document SHADOW_CLIENT_UPDATE_DELAY_MS after the first change.
+ * The deltas on SHADOW_CLIENT_DELTA_TOPIC are received by the deferred MQTT
+ * session; move the topic to MQTT_URGENT_TOPICS to apply them immediately.
+ * See shadow_client.c.
+ */
+#define SHADOW_CLIENT                            (1)
+#define SHADOW_CLIENT_THING_NAME                 MQTT_CLIENT_ID
+#define SHADOW_CLIENT_DELTA_TOPIC                "$aws/things/" SHADOW_CLIENT_THING_NAME "/shadow/update/delta"
+#define SHADOW_CLIENT_UPDATE_DELAY_MS            (5000UL)
+#define SHADOW_CLIENT_MAX_FIELDS                 (8)
+#define SHADOW_CLIENT_VALUE_SIZE                 (24)
+#define SHADOW_CLIENT_DOCUMENT_SIZE              (256)
+
+#include "retained_log.h"
+
+/* Text logging macros. The level prefix is concatenated with the format string
+ * at compile time, so that each message is a single logging task record.
+ * The format string must be a string literal.
+ */
+#define APP_LOG_TEXT_INFO(fmt, ...)              retained_log_print(APP_LOG_LEVEL_INFO, "Info: " fmt, ## __VA_ARGS__)
+#define APP_LOG_TEXT_ERROR(fmt, ...)             retained_log_print(APP_LOG_LEVEL_ERROR, "Error: " fmt, ## __VA_ARGS__)
+
+#if APP_LOG_BINARY
+#include "app_log.h"
+
+#define APP_LOG_INFO(fmt, ...)                   app_log_write(APP_LOG_LEVEL_INFO, fmt, ## __VA_ARGS__)
+#define APP_LOG_ERROR(fmt, ...)                  app_log_write(APP_LOG_LEVEL_ERROR, fmt, ## __VA_ARGS__)
+#else
+#define APP_LOG_INFO(fmt, ...)                   APP_LOG_TEXT_INFO(fmt, ## __VA_ARGS__)
+#define APP_LOG_ERROR(fmt, ...)                  APP_LOG_TEXT_ERROR(fmt, ## __VA_ARGS__)
+#endif
+
+#define APP_INFO(x)                              do { APP_LOG_INFO x; } while(0);
+#define ERR_INFO(x)                              do { APP_LOG_ERROR x; } while(0);
 
 #define PRINT_AND_ASSERT(result, msg, args...)   do                                  \
                                                  {                                   \
@@ -41,11 +41,14 @@
 /* Include header files */
 #include "FreeRTOS.h"
 #include "task.h"
+#include "semphr.h"
 #include "iot_wifi.h"
 #include "iot_wifi_common.h"
 #include "platform/iot_threads.h"
 #include <stdbool.h>
 #include <lwip/netif.h>
+#include <lwip/tcpip.h>
+#include <lwip/priv/tcp_priv.h>
 #include "cyhal.h"
 #include "cybsp.h"
 
@@ -66,6 +69,22 @@
 
 /* Low Power Assistant offload and the network configuration. */
 #include "wlan_offload.h"
+#include "wlan_offload_spec.h"
+#include "arp_offload_policy.h"
+#include "arp_cache_prewarm.h"
+#include "ipv6_nd_offload.h"
+#include "wake_scheduler.h"
+#include "sleep_stats.h"
+#include "task_stats.h"
+#include "trace_stream.h"
+#include "mem_usage.h"
+#include "net_benchmark.h"
+#include "tcp_tune.h"
+#include "tls_session_cache.h"
+#include "mqtt_client.h"
+#include "mqtt_batch.h"
+#include "mqtt_deferred.h"
+#include "shadow_client.h"
 #include "wifi_config.h"
 
 /*******************************************************************************
@@ -74,83 +93,33 @@
 #define APP_TASK_STACK_SIZE       (configMINIMAL_STACK_SIZE * 8)
 #define APP_TASK_PRIORITY         tskIDLE_PRIORITY
 
+/* Backoff between the attempts to re-establish a failed TCP socket connection. */
+#define TCP_RECONNECT_BACKOFF_MIN_MS         (10000UL)
+#define TCP_RECONNECT_BACKOFF_MAX_MS         (600000UL)
+
+/* Time for which the network stack is kept resumed after a reconnect. */
+#define TCP_RECONNECT_HOLD_MS                (1000UL)
+
 /*******************************************************************************
  * Static Global Structures and variables
  ******************************************************************************/
-#if ARP_OFFLOAD
-/*
- * Offload Manager (OLM) configuration for the ARP offload.
- * The ARP offload is active when the PSoC 6 MCU is awake or sleeping.
- * Enables ARP agent in the WLAN firmware in Peer Auto Reply mode with
- * IP Snoop enabled. This means that the WLAN will respond to ARP request
- * from any clients without soliciting the Host MCU (PSoC 6). With the snoop
- * being enabled, the WLAN monitors for ARP responses from the Host to the
- * Network, and caches them in its IP table.
- */
-static const arp_ol_cfg_t arp_offload_config =
-{
-    .awake_enable_mask = ARP_OL_AWAKE_ENABLE_MASK,
-    .sleep_enable_mask = ARP_OL_SLEEP_ENABLE_MASK,
-    .peerage = ARP_OL_PEER_AGE_SEC,
-};
-
-/* ARP offload context. */
-static arp_ol_t arpol_context;
-#endif
+/* TCP socket handle for each connection */
+Socket_t global_socket[MAX_TKO_CONN] = {NULL};
 
-#if PACKET_FILTER_OFFLOAD
-/*
- * Offload Manager (OLM) configuration for the Packet Filter offload.
- * Maximum of up to 20 packet filters can be configured.
+/* Serializes the opening and closing of the TCP socket connections between the
+ * offload monitor and the application task.
  */
-static cy_pf_ol_cfg_t packet_filter_offload_config[MAX_PACKET_FILTER];
-
-/* Packet filter offload context. */
-static pf_ol_t  pfol_context;
-#endif
+static SemaphoreHandle_t tcp_socket_mutex = NULL;
 
-#if TCP_KEEPALIVE_OFFLOAD
-/* TCP Keepalive offload context. */
-static tko_ol_t tkol_context;
-#endif
-
-/*
- * Offload Manager (OLM) configuration for the TCP Keepalive offload.
- * Maximum up to 4 socket connections can be configured.
- *   interval       - The WLAN will send TCP Keepalive packets in every 5 seconds.
- *   retry_interval - The WLAN will send a retry packet in every 3 seconds,
- *                    if no ACK was received from the server.
- *   retry_count    - The WLAN will retry for 3 times before returning error.
- *   local_port     - Local port number (TCP client).
- *   remote_port    - Remote port number (TCP server).
- *   remote_ip      - Remote TCP server IP address.
- *
- * Note: The application will establish the TCP socket connections
- * with the below configuration, irrespective of TCP_KEEPALIVE_OFFLOAD
- * enabled or disabled and when USE_CONFIGURATOR_GENERATED_CONFIG
- * is set to 0 in the file wlan_offload.h.
- */
-static const cy_tko_ol_cfg_t tcp_keepalive_offload_config =
-{
-    .interval       = TKO_INTERVAL_SECS,
-    .retry_interval = TKO_RETRY_INTERVAL_SECS,
-    .retry_count    = TKO_RETRY_COUNT,
-    .ports[0]       = {
-                        .local_port = TCP_CLIENT_PORT_NUMBER,
-                        .remote_port = TCP_SERVER_PORT_NUMBER,
-                        .remote_ip = REMOTE_TCP_SERVER_IP_ADDRESS
-                      },
-};
-
-/* Holds all the offload configuration. This will be used by the offload manager
- * (OLM) to apply the configuration to the WLAN device. The offload manager
- * requires a NULL entry as the last entry in the list. So the offload
- * list at index NUM_OFFLOAD_TYPES+1 will have all NULLs.
+/* TCP socket connections to re-establish, one bit per index, and the backoff
+ * before the next attempt, counted from tcp_socket_reconnect_last.
  */
-static ol_desc_t user_configuration_list[NUM_OFFLOAD_TYPES + 1];
+static uint32_t tcp_socket_reconnect_mask = 0;
+static uint32_t tcp_socket_reconnect_backoff_ms = 0;
+static TickType_t tcp_socket_reconnect_last;
 
-/* TCP socket handle for each connection */
-Socket_t global_socket[MAX_TKO_CONN] = {NULL};
+static uint32_t tcp_socket_reconnect_get_next_ms(void);
+static void tcp_socket_reconnect_run(void);
 
 /*******************************************************************************
  * Function definitions
@@ -175,309 +144,331 @@ void InitApplication(void)
     Iot_CreateDetachedThread(RunApplicationTask, NULL, APP_TASK_PRIORITY, APP_TASK_STACK_SIZE);
 }
 
-/***************************************************************************************
-* Function Name: add_offload_configuration_to_olm_list
-****************************************************************************************
-* Summary:
-*  Adds the given offload configuration for the given offload type to the
-*  offload manager configuration list.
-*
-* Parameters:
-*  offload_name     : Name of the offload type in string for identification.
-*                     The offload names can be "ARP" or "Pkt_Filter" or "TKO".
-*  offload_config   : Holds the offload configuration data for the given offload type.
-*  offload_functions: Initialization and management functions for the given offload type.
-*  offload_context  : Instance of the offload table.
-*
-* Return:
-*  cy_rslt_t        : Returns CY_RSLT_SUCCESS if the offload configuration has been
-*  added to the OLM successfully. Otherwise, it returns CY_RSLT_TYPE_ERROR.
-*
-***************************************************************************************/
-static cy_rslt_t add_offload_configuration_to_olm_list(const char *offload_name,
-                                                       const void *offload_config,
-                                                       const struct ol_fns *offload_functions,
-                                                       void *offload_context)
-{
-    int index = 0;
-    ol_desc_t *offload_list = user_configuration_list;
-    cy_rslt_t result = CY_RSLT_SUCCESS;
-
-    /* Go to the NULL entry list to add the new OLM configuration. */
-    for (index = 0; ((offload_list->name[0] != '\0') &&
-         (index < NUM_OFFLOAD_TYPES)); index++)
-    {
-        offload_list++;
-    }
-
-    if (NUM_OFFLOAD_TYPES == index)
-    {
-        ERR_INFO(("The OLM list is full and cannot accept more entries.\n"));
-        result = CY_RSLT_TYPE_ERROR;
-    }
-    else
-    {
-        /* Add a new OLM configuration to the list. OLM supports
-         * ARP, Packet Filter, and TCP Keepalive WLAN offloads.
-         */ 
-        offload_list->name = offload_name; 
-        offload_list->cfg  = offload_config;
-        offload_list->fns  = offload_functions;
-        offload_list->ol   = offload_context;
-    }
-
-    return result;
-}
-
-#if PACKET_FILTER_OFFLOAD
 /*******************************************************************************
-* Function Name: mark_end_of_packet_filter_configuration
+* Function Name: olm_get_active_offload_list
 ********************************************************************************
 * Summary:
-*  Marks the feature type with CY_PF_OL_FEAT_LAST in order to identify the last
-*  configuration by the offload manager.
+*  Returns the offload list the offload manager (OLM) is currently running
+*  with. This is the list of the generated cycfg_connectivity_wifi.c, which
+*  returns the list of the offload specification in wlan_offload_spec.h.
 *
 * Parameters:
 *  void
 *
 * Return:
-*  void
+*  const ol_desc_t *: Pointer to the first entry of the NULL terminated
+*  offload list.
 *
 *******************************************************************************/
-void mark_end_of_packet_filter_configuration(void)
+const ol_desc_t *olm_get_active_offload_list(void)
 {
-    uint32_t index = 0;
-
-    /* Go to end of packet filter configuration list. */
-    GO_TO_LAST_FILTER_INDEX(index);
-
-    /* Prevent buffer overrun. */
-    if (MAX_PACKET_FILTER >= (index + 1))
-    {
-        packet_filter_offload_config[index].feature = CY_PF_OL_FEAT_LAST;
-    }
-    else
-    {
-        ERR_INFO(("Failed to mark end of packet filter configuration.\n"));
-    }
+    return (const ol_desc_t *)get_default_ol_list();
 }
 
 /*******************************************************************************
-* Function Name: configure_eth_type_packet_filter
+* Function Name: RunApplicationTask
 ********************************************************************************
 * Summary:
-*  Configures network layer packet filter. This is the 16-bit EtherType field
-*  present in the ethernet packets. Valid EtherType consist of a 16-bit number
-*  greater than or equal to 0x800.
+*  Suspends the lwIP network stack forever. This allows the PSoC 6 MCU to enter
+*  into deep sleep power mode. The Host wakes up only when any network activity
+*  on Tx/Rx path is detected in the WLAN driver interface.
 *
 * Parameters:
-*  eth_type: EtherType packet.
+*  pArgument: Unused.
 *
 * Return:
 *  void
 *
 *******************************************************************************/
-void configure_eth_type_packet_filter(uint16_t eth_type)
+void RunApplicationTask(void *pArgument)
 {
-    uint32_t index = 0;
+    struct netif *wifi;
+    uint32_t hold_ms;
 
-    /* Get valid index for configuring the packet filter. */
-    GO_TO_LAST_FILTER_INDEX(index);
+    (void)pArgument;
 
-    /* Prevent buffer overrun. Packet filter configuration can take the
-     * index upto (MAX_PACKET_FILTER - 1).
+    /* Obtain the reference to the lwIP network interface. This will be
+     * used to access the Wi-Fi driver interface to configure the WLAN
+     * power save mode.
      */
-    if (MAX_PACKET_FILTER > (index + 1))
+    wifi = cy_lwip_get_interface();
+
+    /* Applies the initial ARP peer age and host IP table. */
+    arp_offload_policy_on_wake();
+
+    /* Registers the periodic host network duties, which are run together in
+     * shared wake windows.
+     */
+    wake_sched_init();
+    (void)wake_sched_register("ARP host IP refresh", 0, arp_offload_policy_get_next_refresh_ms,
+                              arp_offload_policy_on_wake, 0);
+#if IPV6_ND_OFFLOAD
+    (void)wake_sched_register("MLD report", 0, ipv6_nd_offload_get_next_report_ms,
+                              ipv6_nd_offload_send_reports, WAKE_SCHED_REPORT_HOLD_MS);
+#endif
+    /* The reports are printed only when the host is awake anyway, so that
+     * they do not change the sleep residency which they measure.
+     */
+#if SLEEP_STATS
+    if (0 != SLEEP_STATS_REPORT_INTERVAL_SEC)
     {
-        APP_INFO(("----Eth Filter----\r\nType: 0x%02x\n", eth_type));
-        packet_filter_offload_config[index].id = index;
-        packet_filter_offload_config[index].feature = CY_PF_OL_FEAT_ETHTYPE;
-        packet_filter_offload_config[index].bits = (CY_PF_ACTIVE_SLEEP | CY_PF_ACTIVE_WAKE);
-        packet_filter_offload_config[index].u.eth.eth_type = eth_type;
+        (void)wake_sched_register_passive("Sleep stats report", SLEEP_STATS_REPORT_INTERVAL_SEC * 1000UL,
+                                          sleep_stats_print);
     }
-    else
+#endif
+#if TASK_STATS
+    (void)wake_sched_register_passive("Task stats report", TASK_STATS_REPORT_INTERVAL_SEC * 1000UL,
+                                      task_stats_print);
+#endif
+#if MEM_USAGE_STATS
+    (void)wake_sched_register_passive("Memory usage report", MEM_USAGE_REPORT_INTERVAL_SEC * 1000UL,
+                                      mem_usage_print);
+#endif
+
+#if TLS_SESSION_CACHE
+    if (0 != TLS_SESSION_CACHE_REPORT_INTERVAL_SEC)
     {
-        ERR_INFO(("Failed to add Eth filter configuration.\n"));
+        (void)wake_sched_register_passive("TLS handshake report", TLS_SESSION_CACHE_REPORT_INTERVAL_SEC * 1000UL,
+                                          tls_session_cache_print);
     }
-}
-
-/*******************************************************************************
-* Function Name: configure_port_type_packet_filter
-********************************************************************************
-* Summary:
-*  Configures the application packet types based on the port number. They are
-*  used to identify TCP and UDP packets based on source port or destination
-*  port.
-*
-* Parameters:
-*  port_num  : PortType packet. It represents a port number.
-*  direction : Source port or Destination port.
-*  protocol  : TCP or UDP protocol.
-*
-* Return:
-*  void
-*
-*******************************************************************************/
-void configure_port_type_packet_filter(uint16_t port_num,
-                                       cy_pn_direction_t direction,
-                                       cy_pf_proto_t protocol)
-{
-    uint32_t index = 0;
+#endif
 
-    /* Get valid index for configuring the packet filter. */
-    GO_TO_LAST_FILTER_INDEX(index);
+    /* Re-establishes the TCP socket connections which failed. */
+    (void)wake_sched_register("TCP reconnect", 0, tcp_socket_reconnect_get_next_ms,
+                              tcp_socket_reconnect_run, TCP_RECONNECT_HOLD_MS);
 
-    /* Prevent buffer overrun. Packet filter configuration can take the
-     * index upto (MAX_PACKET_FILTER - 1).
+#if MQTT_CLIENT && SHADOW_CLIENT
+    (void)wake_sched_register("Shadow update", 0, shadow_client_get_next_update_ms,
+                              shadow_client_update, SHADOW_CLIENT_UPDATE_HOLD_MS);
+#endif
+#if MQTT_CLIENT && MQTT_BATCH
+    /* Registered before the MQTT ping, so that a flush in the same wake window
+     * postpones the ping.
      */
-    if (MAX_PACKET_FILTER > (index + 1))
+    (void)wake_sched_register("MQTT publish flush", 0, mqtt_batch_get_next_flush_ms,
+                              mqtt_batch_flush, MQTT_BATCH_FLUSH_HOLD_MS);
+#endif
+#if MQTT_CLIENT
+    if (0 != MQTT_CLIENT_KEEP_ALIVE_SEC)
     {
-        APP_INFO(("----Port Filter----\r\nPort number: %d, Direction: %s, Protocol: %s\n",
-                                                                                 port_num,
-                                                         ((direction == PF_PN_PORT_DEST) ?
-                                                      "Destination Port" : "Source Port"),
-                                                       ((protocol == CY_PF_PROTOCOL_TCP) ?
-                                                                         "TCP" : "UDP")));
-        packet_filter_offload_config[index].id = index;
-        packet_filter_offload_config[index].feature = CY_PF_OL_FEAT_PORTNUM;
-        packet_filter_offload_config[index].bits = (CY_PF_ACTIVE_SLEEP | CY_PF_ACTIVE_WAKE);
-        packet_filter_offload_config[index].u.pf.portnum.portnum = port_num;
-        packet_filter_offload_config[index].u.pf.portnum.range = 0;
-        packet_filter_offload_config[index].u.pf.portnum.direction = direction;
-        packet_filter_offload_config[index].u.pf.proto = protocol;
+        (void)wake_sched_register("MQTT ping", 0, mqtt_client_get_next_ping_ms,
+                                  mqtt_client_send_ping, MQTT_CLIENT_PINGRESP_HOLD_MS);
     }
-    else
+#endif
+#if MQTT_CLIENT && MQTT_DEFERRED_SESSION
+    /* The first poll creates the persistent session on the broker, which then
+     * holds the messages of the deferred topics between the polls.
+     */
+    mqtt_deferred_poll();
+    (void)wake_sched_register("MQTT deferred poll", MQTT_DEFERRED_POLL_INTERVAL_SEC * 1000UL, NULL,
+                              mqtt_deferred_poll, MQTT_DEFERRED_HOLD_MS);
+#endif
+
+#if NET_BENCHMARK
+    net_benchmark_start();
+#endif
+
+    while (true)
     {
-        ERR_INFO(("Failed to add Port filter configuration.\n"));
+
+        /* Configures an emac activity callback to the Wi-Fi interface and
+         * suspends the network stack if the network is inactive for a duration
+         * of INACTIVE_WINDOW_MS inside an interval of INACTIVE_INTERVAL_MS.
+         * The callback is used to signal the presence/absence of network activity
+         * to resume/suspend the network stack. The network stack is resumed
+         * before the next periodic host network duty is due, including a duty
+         * which becomes due earlier while it is suspended.
+         */
+#if ARP_CACHE_PREWARM
+        arp_cache_prewarm_on_suspend();
+#endif
+#if TCP_TUNE
+        tcp_tune_on_suspend();
+#endif
+        retained_log_set_network_suspended(true);
+#if TRACE_STREAM
+        trace_stream_mark(TRACE_STREAM_MARK_NET_SUSPEND);
+#endif
+        wake_sched_set_network_suspended(true);
+        wait_net_suspend(wifi, wake_sched_get_next_ms(), INACTIVE_INTERVAL_MS, INACTIVE_WINDOW_MS);
+        wake_sched_set_network_suspended(false);
+#if TRACE_STREAM
+        trace_stream_mark(TRACE_STREAM_MARK_NET_RESUME);
+#endif
+
+        /* Sends the log records held back while the network stack was suspended. */
+        retained_log_set_network_suspended(false);
+
+#if ARP_CACHE_PREWARM
+        /* Restores the gateway and peer ARP entries which aged out while the
+         * network stack was suspended, so that the next transmit does not
+         * stall on an ARP round-trip.
+         */
+        arp_cache_prewarm_on_resume();
+#endif
+
+        /* The host is awake. Runs all the periodic duties which are due within
+         * the slack in this wake window, and keeps the network stack resumed
+         * until their packets have gone out.
+         */
+        hold_ms = wake_sched_run();
+
+        vTaskDelay(pdMS_TO_TICKS((hold_ms > NETWORK_SUSPEND_DELAY_MS) ? hold_ms : NETWORK_SUSPEND_DELAY_MS));
     }
 }
-#endif /* PACKET_FILTER_OFFLOAD */
 
-/*******************************************************************************
-* Function Name: olm_apply_offload_configuration
-********************************************************************************
-* Summary:
-*  Adds the various WLAN offloads such as ARP, Packet Filter, and TCP Keepalive
-*  to the OLM and restarts it in order to apply the new configuration.
-*  Note that, any updates to the OLM configuration should be made when the Wi-Fi
-*  is in disconnected state. Enable or disable the offload type macro in the file
-*  wifi_offload.h.
-*
-* Parameters:
-*  void
-*
-* Return:
-*  cy_rslt_t: Returns CY_RSLT_SUCCESS if the offload configuration has been
-*  applied to the OLM successfully.
-*
-*******************************************************************************/
-cy_rslt_t olm_apply_offload_configuration(void)
+/************************************************************************************
+ * Function Name: tcp_socket_release_port
+ ************************************************************************************
+ * Summary:
+ *  Aborts the closed connections which still hold the given local port, such as
+ *  in the FIN-WAIT or TIME-WAIT state. The TCP Keepalive connections use fixed
+ *  local ports, and lwIP is built without SO_REUSE, so the port could not be
+ *  bound again until these connections time out.
+ *
+ * Parameters:
+ *  local_port : Local port of the closed connection.
+ *
+ * Return:
+ *  void
+ *
+ ***********************************************************************************/
+static void tcp_socket_release_port(uint16_t local_port)
 {
-    cy_rslt_t result = CY_RSLT_SUCCESS;
+    struct tcp_pcb *pcb;
 
-    /* Add the various offload configuration to the offload manager (OLM) list. */
-#if ARP_OFFLOAD
-    APP_INFO(("Applying ARP offload (Peer Auto Reply) configuration to the offload manager.\n"));
-    result = add_offload_configuration_to_olm_list((const char *)ARP_NAME,
-                                                   (const void *)&arp_offload_config,
-                                                   (const struct ol_fns *)&arp_ol_fns,
-                                                   (void *)&arpol_context);
-    PRINT_AND_ASSERT(result, "Failed to add ARP offload configuration to the OLM list.\n");
-#endif
-
-    /* Allow all the packet types required for the application. Any packet
-     * types which are not part of the below list will get blocked/filtered
-     * by the WLAN device. So the PSoC 6 MCU can stay in deep sleep power
-     * mode and wake up only for the intended packets.
-     */
-#if PACKET_FILTER_OFFLOAD
-    APP_INFO(("Applying Packet Filter offload configuration to the OLM.\n"));
+    LOCK_TCPIP_CORE();
 
-    /* All the below packet filters are necessary for a basic Wi-Fi connection
-     * to establish successfully.
-     */
-    configure_eth_type_packet_filter(ETH_TYPE_ARP_PACKET);
-    configure_eth_type_packet_filter(ETH_TYPE_8021X_PACKET);
-    configure_port_type_packet_filter(PORT_TYPE_DHCP_UDP, PF_PN_PORT_DEST, CY_PF_PROTOCOL_UDP);
-    configure_port_type_packet_filter(PORT_TYPE_DNS_UDP, PF_PN_PORT_DEST, CY_PF_PROTOCOL_UDP);
+    do
+    {
+        for (pcb = tcp_active_pcbs; (NULL != pcb) && (local_port != pcb->local_port); pcb = pcb->next)
+        {
+        }
+        if (NULL == pcb)
+        {
+            for (pcb = tcp_tw_pcbs; (NULL != pcb) && (local_port != pcb->local_port); pcb = pcb->next)
+            {
+            }
+        }
+        if (NULL != pcb)
+        {
+            tcp_abort(pcb);
+        }
+    } while (NULL != pcb);
 
-    /* Allow all the TCP ports used in this application. They are necessary for establishing
-     * TCP socket connection with the remote TCP server.
-     */
-    configure_port_type_packet_filter(PORT_TYPE_TCP_CLIENT, PF_PN_PORT_SOURCE, CY_PF_PROTOCOL_TCP);
-    configure_port_type_packet_filter(PORT_TYPE_TCP_SERVER, PF_PN_PORT_DEST, CY_PF_PROTOCOL_TCP);
-    configure_port_type_packet_filter(PORT_TYPE_TCP_CLIENT, PF_PN_PORT_DEST, CY_PF_PROTOCOL_TCP);
-    configure_port_type_packet_filter(PORT_TYPE_TCP_SERVER, PF_PN_PORT_SOURCE, CY_PF_PROTOCOL_TCP);
+    UNLOCK_TCPIP_CORE();
+}
 
-    /* Marks end of packet filter as the Last feature type. Offload manager (OLM) requires
-     * this to identify the end of offload configuration.
-     */
-    mark_end_of_packet_filter_configuration();
-
-    /* Adds the packet filters to the OLM list. */
-    result = add_offload_configuration_to_olm_list((const char *)PKT_FILTER_NAME,
-                                                   (const void *)&packet_filter_offload_config,
-                                                   (const struct ol_fns *)&pf_ol_fns,
-                                                   (void *)&pfol_context);
-    PRINT_AND_ASSERT(result, "Failed to add Packet Filter offload configuration to the OLM list.\n");
-#endif
+/************************************************************************************
+ * Function Name: tcp_socket_connection_close
+ ************************************************************************************
+ * Summary:
+ *  Closes a TCP socket connection opened by tcp_socket_connection_open(), and
+ *  releases its local port.
+ *
+ * Parameters:
+ *  index : Index of the connection in the offload specification.
+ *
+ * Return:
+ *  void
+ *
+ ***********************************************************************************/
+static void tcp_socket_connection_close(int index)
+{
+    const cy_tko_ol_cfg_t *downloaded = wlan_offload_spec_get_tko_config();
 
-#if TCP_KEEPALIVE_OFFLOAD
-    APP_INFO(("Applying TCP Keepalive offload configuration to the OLM.\n"));
-    result = add_offload_configuration_to_olm_list((const char *)TKO_NAME,
-                                                   (const void *)&tcp_keepalive_offload_config,
-                                                   (const struct ol_fns *)&tko_ol_fns,
-                                                   (void *)&tkol_context);
-    PRINT_AND_ASSERT(result, "Failed to add TCP Keepalive offload configuration to the OLM list.\n");
-#endif
+    if ((NULL != global_socket[index]) && (SOCKETS_INVALID_SOCKET != global_socket[index]))
+    {
+        (void)SOCKETS_Shutdown(global_socket[index], SOCKETS_SHUT_RDWR);
+        (void)SOCKETS_Close(global_socket[index]);
+    }
 
-    /* Applies the new configuration list to the offload manager and
-     * reinitializes with the new configuration.
-     */
-    result = cylpa_restart_olm(user_configuration_list, NULL);
+    global_socket[index] = NULL;
 
-    return result;
+    if (downloaded->ports[index].local_port > 0)
+    {
+        tcp_socket_release_port((uint16_t)downloaded->ports[index].local_port);
+    }
 }
 
-/*******************************************************************************
-* Function Name: RunApplicationTask
-********************************************************************************
-* Summary:
-*  Suspends the lwIP network stack forever. This allows the PSoC 6 MCU to enter
-*  into deep sleep power mode. The Host wakes up only when any network activity
-*  on Tx/Rx path is detected in the WLAN driver interface.
-*
-* Parameters:
-*  pArgument: Unused.
-*
-* Return:
-*  void
-*
-*******************************************************************************/
-void RunApplicationTask(void *pArgument)
+/************************************************************************************
+ * Function Name: tcp_socket_connection_open
+ ************************************************************************************
+ * Summary:
+ *  Establishes one TCP socket connection of the offload specification, and
+ *  connects the MQTT client or sends the crash report on it. A connection
+ *  which fails is retried by the TCP reconnect duty.
+ *
+ * Parameters:
+ *  index : Index of the connection in the offload specification.
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the connection is established or not
+ *  configured, an error code otherwise.
+ *
+ ***********************************************************************************/
+static cy_rslt_t tcp_socket_connection_open(int index)
 {
-    struct netif *wifi;
+    const cy_tko_ol_cfg_t *downloaded = wlan_offload_spec_get_tko_config();
+    const cy_tko_ol_connect_t *port = &downloaded->ports[index];
+    struct netif *netif = cy_lwip_get_interface();
+    cy_rslt_t result;
 
-    (void)pArgument;
+    if ((strcmp(port->remote_ip, NULL_IP_ADDRESS) == 0) ||
+        (port->remote_port <= 0) ||
+        (port->local_port <= 0))
+    {
+        APP_INFO(("Skipped TCP socket connection for socket id[%d]. Check the TCP Keepalive "
+                                                               "configuration.\n", index));
+        return CY_RSLT_SUCCESS;
+    }
 
-    /* Obtain the reference to the lwIP network interface. This will be
-     * used to access the Wi-Fi driver interface to configure the WLAN
-     * power save mode.
+    /* Configures TCP Keepalive with the given remote TCP server.
+     * This is a helper function provided by the Low Power Assistant (LPA)
+     * middleware, which helps to create a socket, bind to the socket, and
+     * then establishes TCP connection with the given remote TCP server.
+     * Enable(1) or Disable(0) the Host TCP keepalive (or lwIP TCP Keepalive)
+     * using the macro ENABLE_HOST_TCP_KEEPALIVE.
      */
-    wifi = cy_lwip_get_interface();
-
-    while (true)
+    result = cy_tcp_create_socket_connection(netif,
+                                             (void **)&global_socket[index],
+                                             port->remote_ip,
+                                             port->remote_port,
+                                             port->local_port,
+                                             (cy_tko_ol_cfg_t *)downloaded,
+                                             ENABLE_HOST_TCP_KEEPALIVE);
+
+    if (CY_RSLT_SUCCESS != result)
+    {
+        ERR_INFO(("Socket[%d]: Unable to connect. TCP Server IP: %s, Local Port: %d, "
+                        "Remote Port: %d\n", index, port->remote_ip, port->local_port,
+                                                                  port->remote_port));
+    }
+    else
     {
+        APP_INFO(("Socket[%d]: Created connection to IP %s, local port %d, remote port %d\n",
+                             index, port->remote_ip, port->local_port, port->remote_port));
 
-        /* Configures an emac activity callback to the Wi-Fi interface and
-         * suspends the network stack if the network is inactive for a duration
-         * of INACTIVE_WINDOW_MS inside an interval of INACTIVE_INTERVAL_MS.
-         * The callback is used to signal the presence/absence of network activity
-         * to resume/suspend the network stack.
-         */
-        wait_net_suspend(wifi, portMAX_DELAY, INACTIVE_INTERVAL_MS, INACTIVE_WINDOW_MS);
-        vTaskDelay(pdMS_TO_TICKS(NETWORK_SUSPEND_DELAY_MS));
+#if MQTT_CLIENT
+        if (TKO_MQTT_CONN_INDEX == index)
+        {
+            /* Connects to the MQTT broker on this connection. */
+            result = mqtt_client_attach(global_socket[index]);
+        }
+        else
+#endif
+        {
+            /* Sends the crash report of the previous boot, if any, to the TCP server. */
+            (void)retained_log_send_report(global_socket[index]);
+        }
     }
+
+    if (CY_RSLT_SUCCESS != result)
+    {
+        tcp_socket_connection_reconnect(index);
+    }
+
+    return result;
 }
 
 /************************************************************************************
@@ -499,14 +490,8 @@ void RunApplicationTask(void *pArgument)
 cy_rslt_t tcp_socket_connection_start(void)
 {
     int index = 0;
-    const cy_tko_ol_cfg_t *downloaded = NULL;
-    cy_rslt_t result = CY_RSLT_SUCCESS;
-    const cy_tko_ol_connect_t *port;
-    struct netif *netif = cy_lwip_get_interface();
+    cy_rslt_t result;
     cy_rslt_t socket_connection_status = CY_RSLT_SUCCESS;
-#if (USE_CONFIGURATOR_GENERATED_CONFIG)
-    ol_desc_t *configurator_offload_list = NULL;
-#endif
 
     if (pdPASS != SOCKETS_Init())
     {
@@ -514,88 +499,185 @@ cy_rslt_t tcp_socket_connection_start(void)
         CY_ASSERT(0);
     }
 
-#if (USE_CONFIGURATOR_GENERATED_CONFIG)
-    /* Takes device configurator generated configuration. */
-    configurator_offload_list = cylpa_find_my_descriptor(TKO_NAME, (ol_desc_t *)get_default_ol_list());
-    if (NULL != configurator_offload_list)
+    if (NULL == tcp_socket_mutex)
     {
-        downloaded = (const cy_tko_ol_cfg_t *)configurator_offload_list->cfg;
+        tcp_socket_mutex = xSemaphoreCreateMutex();
+        CY_ASSERT(NULL != tcp_socket_mutex);
     }
-    else
+
+    (void)xSemaphoreTake(tcp_socket_mutex, portMAX_DELAY);
+
+    /* Starts the TCP socket connections of the offload specification. */
+    for (index = 0; index < MAX_TKO_CONN; index++)
     {
-        APP_INFO(("TCP Keepalive offload is not enabled by the user "
-                                    "in the device configurator.\n"));
+        result = tcp_socket_connection_open(index);
+        if (CY_RSLT_SUCCESS != result)
+        {
+            socket_connection_status = result;
+        }
     }
-#else
-    /* Takes reference to the local TCP Keepalive configuration defined by the user. */
-    downloaded = &tcp_keepalive_offload_config;
-#endif
 
-    if (NULL != downloaded)
+    (void)xSemaphoreGive(tcp_socket_mutex);
+
+    return socket_connection_status;
+}
+
+/************************************************************************************
+ * Function Name: tcp_socket_connection_restart
+ ************************************************************************************
+ * Summary:
+ *  Closes all the TCP socket connections opened by tcp_socket_connection_start()
+ *  and establishes them again. This is used when the local IP address changes,
+ *  since the connections bound to the previous address are no longer valid and
+ *  the TCP Keepalive offload would otherwise keep refreshing a dead 4-tuple.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  cy_rslt_t: Returns CY_RSLT_SUCCESS if the connection is successfully created
+ *  for all the configured sockets, a socket error code otherwise.
+ *
+ ***********************************************************************************/
+cy_rslt_t tcp_socket_connection_restart(void)
+{
+    int index = 0;
+
+    (void)xSemaphoreTake(tcp_socket_mutex, portMAX_DELAY);
+
+    for (index = 0; index < MAX_TKO_CONN; index++)
     {
-        /* Offload descriptor was found. Start TCP socket connection to the
-         * configured TCP server.
-         */
-        for (index = 0; index < MAX_TKO_CONN; index++)
+        tcp_socket_connection_close(index);
+    }
+
+    /* The connections are all established again. */
+    taskENTER_CRITICAL();
+    tcp_socket_reconnect_mask = 0;
+    tcp_socket_reconnect_backoff_ms = 0;
+    taskEXIT_CRITICAL();
+
+    (void)xSemaphoreGive(tcp_socket_mutex);
+
+    return tcp_socket_connection_start();
+}
+
+/************************************************************************************
+ * Function Name: tcp_socket_connection_reconnect
+ ************************************************************************************
+ * Summary:
+ *  Requests that one TCP socket connection is established again, such as after
+ *  a send on it has failed. The other connections are not touched. The
+ *  connection is re-established by the TCP reconnect duty of the wake
+ *  scheduler, and retried with an exponential backoff until it succeeds. This
+ *  can be called from any task.
+ *
+ * Parameters:
+ *  index : Index of the connection in the offload specification.
+ *
+ * Return:
+ *  void
+ *
+ ***********************************************************************************/
+void tcp_socket_connection_reconnect(int index)
+{
+    if ((index < 0) || (index >= MAX_TKO_CONN))
+    {
+        return;
+    }
+
+    taskENTER_CRITICAL();
+    tcp_socket_reconnect_mask |= (1UL << index);
+    taskEXIT_CRITICAL();
+}
+
+/************************************************************************************
+ * Function Name: tcp_socket_reconnect_get_next_ms
+ ************************************************************************************
+ * Summary:
+ *  Returns the time until the next attempt to re-establish the failed TCP
+ *  socket connections.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  uint32_t: Time in milliseconds until the next attempt, or portMAX_DELAY if
+ *  no connection needs to be re-established.
+ *
+ ***********************************************************************************/
+static uint32_t tcp_socket_reconnect_get_next_ms(void)
+{
+    uint32_t elapsed_ms;
+    uint32_t next_ms = portMAX_DELAY;
+
+    taskENTER_CRITICAL();
+    if (0 != tcp_socket_reconnect_mask)
+    {
+        elapsed_ms = (uint32_t)(xTaskGetTickCount() - tcp_socket_reconnect_last) * portTICK_PERIOD_MS;
+        next_ms = (elapsed_ms >= tcp_socket_reconnect_backoff_ms) ? 0 :
+                  (tcp_socket_reconnect_backoff_ms - elapsed_ms);
+    }
+    taskEXIT_CRITICAL();
+
+    return next_ms;
+}
+
+/************************************************************************************
+ * Function Name: tcp_socket_reconnect_run
+ ************************************************************************************
+ * Summary:
+ *  Closes and establishes again the TCP socket connections requested with
+ *  tcp_socket_connection_reconnect(). After a failure, the time to the next
+ *  attempt is doubled from TCP_RECONNECT_BACKOFF_MIN_MS up to
+ *  TCP_RECONNECT_BACKOFF_MAX_MS. Once all the connections are established,
+ *  the next request is attempted at once.
+ *
+ * Parameters:
+ *  void
+ *
+ * Return:
+ *  void
+ *
+ ***********************************************************************************/
+static void tcp_socket_reconnect_run(void)
+{
+    uint32_t mask;
+    int index;
+
+    (void)xSemaphoreTake(tcp_socket_mutex, portMAX_DELAY);
+
+    taskENTER_CRITICAL();
+    mask = tcp_socket_reconnect_mask;
+    tcp_socket_reconnect_mask = 0;
+    taskEXIT_CRITICAL();
+
+    for (index = 0; index < MAX_TKO_CONN; index++)
+    {
+        if (0 != (mask & (1UL << index)))
         {
-             port = &downloaded->ports[index];
-
-             if ((strcmp(port->remote_ip, NULL_IP_ADDRESS) != 0) &&
-                 (port->remote_port > 0) &&
-                 (port->local_port > 0))
-             {
-                 /* Configures TCP Keepalive with the given remote TCP server.
-                  * This is a helper function provided by the Low Power Assistant (LPA)
-                  * middleware, which helps to create a socket, bind to the socket, and
-                  * then establishes TCP connection with the given remote TCP server.
-                  * Enable(1) or Disable(0) the Host TCP keepalive (or lwIP TCP Keepalive)
-                  * using the macro ENABLE_HOST_TCP_KEEPALIVE.
-                  */
-                 result = cy_tcp_create_socket_connection(netif,
-                                                          (void **)&global_socket[index],
-                                                          port->remote_ip,
-                                                          port->remote_port,
-                                                          port->local_port,
-                                                          (cy_tko_ol_cfg_t *)downloaded,
-                                                          ENABLE_HOST_TCP_KEEPALIVE);
-
-                 if (CY_RSLT_SUCCESS != result)
-                 {
-                     ERR_INFO(("Socket[%d]: Unable to connect. TCP Server IP: %s, Local Port: %d, "
-                                     "Remote Port: %d\n", index, port->remote_ip, port->local_port,
-                                                                               port->remote_port));
-                     socket_connection_status = result;
-                 }
-                 else
-                 {
-                     APP_INFO(("Socket[%d]: Created connection to IP %s, local port %d, remote port %d\n",
-                                          index, port->remote_ip, port->local_port, port->remote_port));
-                 }
-             }
-             else
-             {
-                 APP_INFO(("Skipped TCP socket connection for socket id[%d]. Check the TCP Keepalive "
-                                                                        "configuration.\n", index));
-             }
+            APP_INFO(("Socket[%d]: Re-establishing the TCP connection.\n", index));
+            tcp_socket_connection_close(index);
+
+            /* A failure requests the connection again. */
+            (void)tcp_socket_connection_open(index);
         }
     }
-#if !(USE_CONFIGURATOR_GENERATED_CONFIG)
-    else
+
+    taskENTER_CRITICAL();
+    if (0 == tcp_socket_reconnect_mask)
     {
-        ERR_INFO(("%s: Offload descriptor %s not found. No TCP connection has been established.\n", __func__, "TKO"));
-        socket_connection_status = CY_RSLT_TYPE_ERROR;
+        tcp_socket_reconnect_backoff_ms = 0;
     }
-#else
     else
     {
-        /* TCP Keepalive is not enabled in the device configurator and no socket connection is expected
-         * to be established.
-         */
-        socket_connection_status = CY_RSLT_SUCCESS;
+        tcp_socket_reconnect_backoff_ms = (0 == tcp_socket_reconnect_backoff_ms) ? TCP_RECONNECT_BACKOFF_MIN_MS :
+                                          ((tcp_socket_reconnect_backoff_ms >= (TCP_RECONNECT_BACKOFF_MAX_MS / 2)) ?
+                                           TCP_RECONNECT_BACKOFF_MAX_MS : (tcp_socket_reconnect_backoff_ms * 2));
     }
-#endif
+    tcp_socket_reconnect_last = xTaskGetTickCount();
+    taskEXIT_CRITICAL();
 
-    return socket_connection_status;
+    (void)xSemaphoreGive(tcp_socket_mutex);
 }
 
 /*******************************************************************************
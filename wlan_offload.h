@@ -42,15 +42,8 @@
 #ifndef _WLAN_OFFLOAD_H_
 #define _WLAN_OFFLOAD_H_
 
-
-/* When enabled (1), the application takes the offload configuration from
- * the device-configurator generated sources. By default, the offload
- * manager (OLM) initializes with the generated sources configuration.
- * When disabled (0), the application takes the locally defined offload
- * configuration by the user. It then applies the offload configuration to
- * the OLM, and restarts the OLM to initialize with the new configuration.
- */
-#define USE_CONFIGURATOR_GENERATED_CONFIG    (1)
+/* Low Power Assistant offload descriptor definitions. */
+#include "cy_lpa_wifi_ol.h"
 
 /* 
  * Macros related to suspending and resuming the network stack.
@@ -77,27 +70,49 @@
  */
 #define NETWORK_SUSPEND_DELAY_MS             (100)
 
+/*
+ * Macros related to aligning the periodic host network duties (DHCP renewal,
+ * IGMP/MLD reports, ARP host IP refresh, and application heartbeats) to shared
+ * wake windows. See wake_scheduler.c.
+ */
+/* A duty which is due within WAKE_SCHED_SLACK_MS milliseconds is run early in
+ * the current wake window instead of waking the host once more. A larger slack
+ * merges more wakes at the cost of running the duties earlier than needed.
+ */
+#define WAKE_SCHED_SLACK_MS                  (30000UL)
+
+/* Maximum number of duties that can be registered with the wake scheduler. */
+#define WAKE_SCHED_MAX_DUTIES                (16)
+
+/* The IGMP reports which lwIP delays in response to a Query are sent in the
+ * next host wake window. On a network without an IGMP querier, set this to
+ * send unsolicited IGMP reports in a host wake window at least every
+ * WAKE_SCHED_IGMP_REPORT_INTERVAL_SEC seconds, while an IPv4 multicast group is
+ * joined, to keep the groups alive in IGMP snooping switches. 0 disables the
+ * unsolicited reports, which would otherwise limit the time the network stack
+ * stays suspended.
+ */
+#define WAKE_SCHED_IGMP_REPORT_INTERVAL_SEC  (0UL)
+
 /*******************************************************************************
- * The following defines the user-specified offload configuration.
- * These are used when Configurator generated configuration is not used.
+ * The following defines the offload configuration. The packet filters and the
+ * TCP Keepalive offload connections built from it are listed in
+ * wlan_offload_spec.h.
  ******************************************************************************/
 /* Enable(1) or Disable(0) Address Resolution Protocol (ARP) offload. */
 #define ARP_OFFLOAD                          (1)
 
-/* Enable(1) or Disable(0) Packet Filters. Packet filters are configured
- * via code when this option is enabled. However, it is the responsibility
- * of the user to configure the required packet types needed by the application
- * in the code.
- */
+/* Enable(1) or Disable(0) Packet Filter offload. */
 #define PACKET_FILTER_OFFLOAD                (1)
 
-/* Enable(1) or Disable(0) TCP Keepalive offload. It is the responsibility of the user
- * to configure the TCP socket connection parameters.
- */
+/* Enable(1) or Disable(0) TCP Keepalive offload. */
 #define TCP_KEEPALIVE_OFFLOAD                (1)
 
-/* Three types of LPA offloads available: ARP, Packet Filter, and TCP Keepalive. */
-#define NUM_OFFLOAD_TYPES                    (3)
+/* Enable(1) or Disable(0) re-applying the ARP, Packet Filter, and TCP Keepalive
+ * offload state after link and IP address changes, such as a roam, a
+ * reassociation, or a new DHCP lease. See wlan_offload_monitor.c.
+ */
+#define OFFLOAD_MONITOR                      (1)
 
 /************************ARP OFFLOAD CONFIGURATION*******************************/
 #if ARP_OFFLOAD
@@ -112,6 +127,33 @@
 /* The ARP cache table in the WLAN device expires after ARP_OL_PEER_AGE_SEC seconds. */
 #define ARP_OL_PEER_AGE_SEC                  (1200UL)
 #endif
+
+/*
+ * Enable(1) or Disable(0) the adaptive ARP peer age. When enabled, the peer age
+ * is selected from the DHCP lease time and the host IP address stability instead
+ * of the fixed peer age in the ARP offload configuration, and the WLAN host IP
+ * table is refreshed before it ages out. See arp_offload_policy.c.
+ */
+#define ARP_OL_ADAPTIVE_PEER_AGE             (1)
+
+/* Range of the peer age selected by the adaptive ARP peer age. */
+#define ARP_OL_PEER_AGE_MIN_SEC              (300UL)
+#define ARP_OL_PEER_AGE_MAX_SEC              (7200UL)
+
+/* The host IP address is considered stable once it has not changed for
+ * ARP_OL_ADDRESS_STABLE_SEC seconds. Until then, the minimum peer age is used.
+ */
+#define ARP_OL_ADDRESS_STABLE_SEC            (600UL)
+
+/* The WLAN host IP table is refreshed once ARP_OL_REFRESH_PERCENT of the peer
+ * age has elapsed since the last refresh.
+ */
+#define ARP_OL_REFRESH_PERCENT               (75UL)
+
+/* Enable(1) or Disable(0) restoring the gateway and peer entries of the lwIP
+ * ARP cache when the network stack resumes. See arp_cache_prewarm.c.
+ */
+#define ARP_CACHE_PREWARM                    (1)
 /*******************************************************************************/
 
 /*************************TCP KEEPALIVE OFFLOAD*********************************/
@@ -128,6 +170,14 @@
 #define TKO_RETRY_INTERVAL_SECS              (3) /* The WLAN will send a retry packet in every 3 seconds, if no ACK was received from the server. */
 #define TKO_RETRY_COUNT                      (3) /* The WLAN will retry for 3 times before returning error. */
 #define REMOTE_TCP_SERVER_IP_ADDRESS         "192.168.0.108"
+
+/* TCP Keepalive offload connection of the MQTT client, used when MQTT_CLIENT is
+ * enabled in wifi_config.h.
+ */
+#define TKO_MQTT_CONN_INDEX                  (1)
+#define MQTT_CLIENT_PORT_NUMBER              (3354)
+#define MQTT_BROKER_PORT_NUMBER              (1883)
+#define MQTT_BROKER_IP_ADDRESS               REMOTE_TCP_SERVER_IP_ADDRESS
 /*******************************************************************************/
 
 /*************************PACKET FILTER OFFLOAD*********************************/
@@ -139,9 +189,6 @@
  */
 #define MAX_PACKET_FILTER                    (20)
 
-/* A macro which indicates an empty packet filter configuration. */
-#define FEATURE_TYPE_EMPTY                   (0)
-
 /* Allow the following EtherType and PortType packets for this application. */
 #define ETH_TYPE_ARP_PACKET                  (0x806)
 #define ETH_TYPE_8021X_PACKET                (0x888E)
@@ -149,23 +196,42 @@
 #define PORT_TYPE_DNS_UDP                    (53)
 #define PORT_TYPE_TCP_CLIENT                 TCP_CLIENT_PORT_NUMBER
 #define PORT_TYPE_TCP_SERVER                 TCP_SERVER_PORT_NUMBER
-
-#define GO_TO_LAST_FILTER_INDEX(x)           while ((FEATURE_TYPE_EMPTY != packet_filter_offload_config[x].feature) && \
-                                                    (MAX_PACKET_FILTER > x)) \
-                                             { \
-                                                 x++; \
-                                             }
-
+#define PORT_TYPE_MQTT_CLIENT                MQTT_CLIENT_PORT_NUMBER
+#define PORT_TYPE_MQTT_BROKER                MQTT_BROKER_PORT_NUMBER
 #endif
 /******************************************************************************/
 
+/*******************IPV6 NEIGHBOR DISCOVERY OFFLOAD*****************************/
+/* Enable(1) or Disable(0) the IPv6 counterpart of the ARP offload. It adds a
+ * packet filter profile which lets ICMPv6 (neighbor discovery, router
+ * advertisements, and MLD) reach the host in both power states while the rest
+ * of the IPv6 traffic is allowed only when the host is awake, and sends the
+ * MLD reports delayed in response to a Query in the host wake windows. See
+ * ipv6_nd_offload.c.
+ */
+#define IPV6_ND_OFFLOAD                      (1)
+#define ETH_TYPE_IPV6_PACKET                 (0x86DD)
+#define IP_TYPE_ICMPV6                       (58)
+
+/* On a network without an MLD querier, set this to send unsolicited MLD reports
+ * in a host wake window at least every IPV6_MLD_REPORT_INTERVAL_SEC seconds, to
+ * keep the solicited-node multicast group of the host alive in MLD snooping
+ * switches. It must be below the default Multicast Listener Interval of 260
+ * seconds. 0 disables the unsolicited reports, which would otherwise limit the
+ * time the network stack stays suspended.
+ */
+#define IPV6_MLD_REPORT_INTERVAL_SEC         (0UL)
+/******************************************************************************/
+
 /*******************************************************************************
  * Function Prototypes
  ******************************************************************************/
 void RunApplicationTask(void *pArgument);
 cy_rslt_t prvWifiConnect(void);
 cy_rslt_t tcp_socket_connection_start(void);
-cy_rslt_t olm_apply_offload_configuration(void);
+cy_rslt_t tcp_socket_connection_restart(void);
+void tcp_socket_connection_reconnect(int index);
+const ol_desc_t *olm_get_active_offload_list(void);
 
 #endif /* _WLAN_OFFLOAD_H_ */
 
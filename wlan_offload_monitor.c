@@ -0,0 +1,440 @@
+/*******************************************************************************
+ * File Name:   wlan_offload_monitor.c
+ *
+ * Description: This file contains the offload monitor. It subscribes to the
+ * lwIP link and IP address change events, and to the WLAN roam events, and
+ * re-applies only the affected ARP, Packet Filter, and TCP Keepalive offload
+ * state after a roam, a reassociation, or a DHCP address change.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+
+/* Include header files */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "iot_wifi.h"
+#include "iot_wifi_common.h"
+#include <stdbool.h>
+#include <lwip/netif.h>
+#include <lwip/tcpip.h>
+#include "cyhal.h"
+#include "cybsp.h"
+
+/* Low Power Assistant header files. */
+#include "network_activity_handler.h"
+#include "cy_lpa_wifi_arp_ol.h"
+#include "cy_lpa_wifi_pf_ol.h"
+#include "cy_lpa_wifi_tko_ol.h"
+
+/* LPA offload manager (OLM) header file. */
+#include "cy_OlmInterface.h"
+
+/* Wi-Fi Host Driver (WHD) header files. */
+#include "whd_wifi_api.h"
+
+/* Low Power Assistant offload and the network configuration. */
+#include "wlan_offload.h"
+#include "wlan_offload_monitor.h"
+#include "arp_offload_policy.h"
+#include "arp_cache_prewarm.h"
+#include "wifi_config.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define OFFLOAD_MONITOR_TASK_STACK_SIZE      (configMINIMAL_STACK_SIZE * 8)
+#define OFFLOAD_MONITOR_TASK_PRIORITY        (tskIDLE_PRIORITY + 1)
+
+/* Offload state that needs to be re-validated. These are posted as task
+ * notification bits to the offload monitor task.
+ */
+#define OFFLOAD_MONITOR_ARP_HOST_IP_STALE    (1UL << 0)
+#define OFFLOAD_MONITOR_ARP_PEERS_STALE      (1UL << 1)
+#define OFFLOAD_MONITOR_PF_STALE             (1UL << 2)
+#define OFFLOAD_MONITOR_TKO_STALE            (1UL << 3)
+
+#define OFFLOAD_MONITOR_ALL_STALE            (OFFLOAD_MONITOR_ARP_HOST_IP_STALE | \
+                                              OFFLOAD_MONITOR_ARP_PEERS_STALE   | \
+                                              OFFLOAD_MONITOR_PF_STALE          | \
+                                              OFFLOAD_MONITOR_TKO_STALE)
+
+/*******************************************************************************
+ * Static Global Structures and variables
+ ******************************************************************************/
+/* Offload monitor task handle. The lwIP and WHD callbacks post the stale
+ * offload state to this task as notification bits.
+ */
+static TaskHandle_t offload_monitor_task_handle = NULL;
+
+/* Host IP address last pushed to the WLAN ARP agent and used by the
+ * TCP Keepalive socket connections.
+ */
+static ip4_addr_t offload_monitor_applied_ip;
+
+/* lwIP extended netif status callback entry. */
+NETIF_DECLARE_EXT_CALLBACK(offload_monitor_netif_callback_entry)
+
+/* WLAN events that indicate the host is now associated with a different AP. */
+static const uint32_t offload_monitor_whd_events[] = { WLC_E_ROAM, WLC_E_NONE };
+static uint16_t offload_monitor_whd_event_index;
+
+/*******************************************************************************
+ * Function definitions
+ ******************************************************************************/
+/*******************************************************************************
+* Function Name: offload_monitor_mark_stale
+********************************************************************************
+* Summary:
+*  Posts the given stale offload state to the offload monitor task. The WLAN
+*  firmware commands block, so they are never issued from the lwIP or WHD
+*  callback context.
+*
+* Parameters:
+*  stale_mask: Bitmask of OFFLOAD_MONITOR_*_STALE flags.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void offload_monitor_mark_stale(uint32_t stale_mask)
+{
+    if ((NULL != offload_monitor_task_handle) && (0 != stale_mask))
+    {
+        (void)xTaskNotify(offload_monitor_task_handle, stale_mask, eSetBits);
+    }
+}
+
+/*******************************************************************************
+* Function Name: offload_monitor_netif_callback
+********************************************************************************
+* Summary:
+*  lwIP extended netif status callback. Maps link and IPv4 address changes to
+*  the offload state which becomes stale because of them. It is called from
+*  the tcpip thread context.
+*
+* Parameters:
+*  netif  : Network interface on which the change happened.
+*  reason : Bitmask of LWIP_NSC_* change reasons.
+*  args   : Reason specific arguments.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void offload_monitor_netif_callback(struct netif *netif,
+                                           netif_nsc_reason_t reason,
+                                           const netif_ext_callback_args_t *args)
+{
+    uint32_t stale_mask = 0;
+
+    if (netif != cy_lwip_get_interface())
+    {
+        return;
+    }
+
+    /* The link came back up after a reassociation, possibly with a different
+     * AP. The peers learned on the previous BSS are no longer valid, and the
+     * packet filters pushed before the link went down need to be re-validated.
+     */
+    if ((0 != (reason & LWIP_NSC_LINK_CHANGED)) && (NULL != args) &&
+        (0 != args->link_changed.state))
+    {
+        stale_mask |= OFFLOAD_MONITOR_ALL_STALE;
+    }
+
+    /* A new address or subnet invalidates the host IP table of the WLAN ARP
+     * agent, its peer cache, and the 4-tuple of the TCP Keepalive connections.
+     */
+    if (0 != (reason & (LWIP_NSC_IPV4_ADDRESS_CHANGED |
+                        LWIP_NSC_IPV4_NETMASK_CHANGED |
+                        LWIP_NSC_IPV4_GATEWAY_CHANGED)))
+    {
+        stale_mask |= (OFFLOAD_MONITOR_ARP_HOST_IP_STALE |
+                       OFFLOAD_MONITOR_ARP_PEERS_STALE   |
+                       OFFLOAD_MONITOR_TKO_STALE);
+    }
+
+    offload_monitor_mark_stale(stale_mask);
+}
+
+/*******************************************************************************
+* Function Name: offload_monitor_whd_event_handler
+********************************************************************************
+* Summary:
+*  WLAN event handler for roam events. A roam within the same ESS does not
+*  bring the lwIP link down, so it is not seen by the netif status callback.
+*
+* Parameters:
+*  ifp          : WHD interface on which the event was received.
+*  event_header : Event header.
+*  event_data   : Event data.
+*  user_data    : Unused.
+*
+* Return:
+*  void *: The user data, as required by WHD.
+*
+*******************************************************************************/
+static void *offload_monitor_whd_event_handler(whd_interface_t ifp,
+                                               const whd_event_header_t *event_header,
+                                               const uint8_t *event_data,
+                                               void *user_data)
+{
+    (void)ifp;
+    (void)event_data;
+
+    if ((WLC_E_ROAM == event_header->event_type) &&
+        (WLC_E_STATUS_SUCCESS == event_header->status))
+    {
+        /* Same IP address, new BSS. Only the peers learned on the previous
+         * BSS and the packet filters need to be re-validated.
+         */
+        offload_monitor_mark_stale(OFFLOAD_MONITOR_ARP_PEERS_STALE | OFFLOAD_MONITOR_PF_STALE);
+    }
+
+    return user_data;
+}
+
+/*******************************************************************************
+* Function Name: offload_monitor_refresh_arp
+********************************************************************************
+* Summary:
+*  Re-validates the host IP table of the WLAN ARP agent against the current
+*  host IP address and updates it only if it differs. Clears the WLAN ARP peer
+*  cache when the peers learned earlier are no longer valid.
+*
+* Parameters:
+*  ifp        : WHD interface.
+*  host_ip    : Current host IPv4 address.
+*  stale_mask : Bitmask of OFFLOAD_MONITOR_*_STALE flags.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void offload_monitor_refresh_arp(whd_interface_t ifp,
+                                        const ip4_addr_t *host_ip,
+                                        uint32_t stale_mask)
+{
+    if (NULL == cylpa_find_my_descriptor(ARP_NAME, (ol_desc_t *)olm_get_active_offload_list()))
+    {
+        /* ARP offload is not enabled. */
+        return;
+    }
+
+    if (0 != (stale_mask & OFFLOAD_MONITOR_ARP_HOST_IP_STALE))
+    {
+        arp_offload_policy_refresh_host_ip(ifp, host_ip, false);
+    }
+
+    if (0 != (stale_mask & OFFLOAD_MONITOR_ARP_PEERS_STALE))
+    {
+        (void)whd_arp_cache_clear(ifp);
+#if ARP_CACHE_PREWARM
+        arp_cache_prewarm_invalidate();
+#endif
+    }
+}
+
+/*******************************************************************************
+* Function Name: offload_monitor_refresh_pf
+********************************************************************************
+* Summary:
+*  Re-validates that every packet filter of the active offload configuration
+*  is still installed in the WLAN firmware. Re-pushes the packet filter
+*  offload only if one or more filters are missing.
+*
+* Parameters:
+*  ifp : WHD interface.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void offload_monitor_refresh_pf(whd_interface_t ifp)
+{
+    const ol_desc_t *pf_desc;
+    const cy_pf_ol_cfg_t *pf_cfg;
+    whd_pkt_filter_stats_t stats;
+    olm_t *olm = (olm_t *)cy_get_olm_instance();
+    bool missing = false;
+
+    pf_desc = cylpa_find_my_descriptor(PKT_FILTER_NAME, (ol_desc_t *)olm_get_active_offload_list());
+    if ((NULL == pf_desc) || (NULL == olm))
+    {
+        /* Packet filter offload is not enabled. */
+        return;
+    }
+
+    for (pf_cfg = (const cy_pf_ol_cfg_t *)pf_desc->cfg;
+         CY_PF_OL_FEAT_LAST != pf_cfg->feature;
+         pf_cfg++)
+    {
+        if (WHD_SUCCESS != whd_pf_get_packet_filter_stats(ifp, pf_cfg->id, &stats))
+        {
+            missing = true;
+            break;
+        }
+    }
+
+    if (missing)
+    {
+        APP_INFO(("Re-applying the packet filter offload after reassociation.\n"));
+
+        pf_desc->fns->deinit(pf_desc->ol);
+        if (0 != pf_desc->fns->init(pf_desc->ol, &olm->ol_info, pf_desc->cfg))
+        {
+            ERR_INFO(("Failed to re-apply the packet filter offload.\n"));
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: offload_monitor_task
+********************************************************************************
+* Summary:
+*  Waits for stale offload state posted by the lwIP and WHD callbacks, and
+*  re-applies it. The TCP Keepalive connections are re-established only when
+*  the host IP address has changed, since the TCP Keepalive offload picks up
+*  the new connections the next time the host enters sleep.
+*
+* Parameters:
+*  pArgument: Unused.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static void offload_monitor_task(void *pArgument)
+{
+    uint32_t stale_mask = 0;
+    struct netif *netif = cy_lwip_get_interface();
+    whd_interface_t ifp = (whd_interface_t)netif->state;
+    ip4_addr_t host_ip;
+
+    (void)pArgument;
+
+    while (true)
+    {
+        uint32_t posted_mask = 0;
+
+        (void)xTaskNotifyWait(0, UINT32_MAX, &posted_mask, portMAX_DELAY);
+        stale_mask |= posted_mask;
+
+        ip4_addr_copy(host_ip, *netif_ip4_addr(netif));
+
+        /* DHCP has not bound an address yet after the link came up. Keep
+         * the stale state until the address change event arrives.
+         */
+        if (!netif_is_link_up(netif) || ip4_addr_isany_val(host_ip))
+        {
+            continue;
+        }
+
+        if (ip4_addr_cmp(&host_ip, &offload_monitor_applied_ip))
+        {
+            /* Same address: the TCP connections are still valid. */
+            stale_mask &= ~OFFLOAD_MONITOR_TKO_STALE;
+        }
+
+        offload_monitor_refresh_arp(ifp, &host_ip, stale_mask);
+
+        if (0 != (stale_mask & OFFLOAD_MONITOR_PF_STALE))
+        {
+            offload_monitor_refresh_pf(ifp);
+        }
+
+        if (0 != (stale_mask & OFFLOAD_MONITOR_TKO_STALE))
+        {
+            APP_INFO(("Host IP address changed. Re-establishing the TCP Keepalive connections.\n"));
+
+            if (CY_RSLT_SUCCESS != tcp_socket_connection_restart())
+            {
+                ERR_INFO(("One or more TCP socket connections failed.\n"));
+            }
+        }
+
+        ip4_addr_copy(offload_monitor_applied_ip, host_ip);
+        stale_mask = 0;
+    }
+}
+
+/*******************************************************************************
+* Function Name: wlan_offload_monitor_init
+********************************************************************************
+* Summary:
+*  Starts the offload monitor. This must be called once the Wi-Fi is connected
+*  and the TCP socket connections are established, so that the current host
+*  IP address is taken as the applied state.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  cy_rslt_t: Returns CY_RSLT_SUCCESS if the offload monitor is started.
+*  Otherwise, it returns CY_RSLT_TYPE_ERROR.
+*
+*******************************************************************************/
+cy_rslt_t wlan_offload_monitor_init(void)
+{
+    struct netif *netif = cy_lwip_get_interface();
+    whd_result_t whd_result;
+
+    ip4_addr_copy(offload_monitor_applied_ip, *netif_ip4_addr(netif));
+
+    if (pdPASS != xTaskCreate(offload_monitor_task, "OL-Mon", OFFLOAD_MONITOR_TASK_STACK_SIZE,
+                              NULL, OFFLOAD_MONITOR_TASK_PRIORITY, &offload_monitor_task_handle))
+    {
+        ERR_INFO(("Failed to create the offload monitor task.\n"));
+        return CY_RSLT_TYPE_ERROR;
+    }
+
+    LOCK_TCPIP_CORE();
+    netif_add_ext_callback(&offload_monitor_netif_callback_entry, offload_monitor_netif_callback);
+    UNLOCK_TCPIP_CORE();
+
+    whd_result = whd_wifi_set_event_handler((whd_interface_t)netif->state, offload_monitor_whd_events,
+                                            offload_monitor_whd_event_handler, NULL,
+                                            &offload_monitor_whd_event_index);
+    if (WHD_SUCCESS != whd_result)
+    {
+        /* Roams that do not bring the link down will only be detected
+         * through the IP address change events.
+         */
+        ERR_INFO(("Failed to register the WLAN roam event handler.\n"));
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+
+/* [] END OF FILE */
+
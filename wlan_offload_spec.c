@@ -0,0 +1,332 @@
+/*******************************************************************************
+ * File Name:   wlan_offload_spec.c
+ *
+ * Description: This file builds the offload list of the offload manager (OLM)
+ * from the offload specification in wlan_offload_spec.h. All the tables are
+ * constant and are checked when they are compiled: the number of packet
+ * filters, duplicate filters and connection slots, and the port filters of
+ * every TCP Keepalive offload connection. The generated
+ * cycfg_connectivity_wifi.c of each board returns this list, so the OLM
+ * starts with it when the Wi-Fi is turned on and no offload configuration is
+ * built at boot.
+ *
+ *******************************************************************************
+ * (c) 2020, Cypress Semiconductor Corporation. All rights reserved.
+ *******************************************************************************
+ * This software, including source code, documentation and related materials
+ * ("Software"), is owned by Cypress Semiconductor Corporation or one of its
+ * subsidiaries ("Cypress") and is protected by and subject to worldwide patent
+ * protection (United States and foreign), United States copyright laws and
+ * international treaty provisions. Therefore, you may use this Software only
+ * as provided in the license agreement accompanying the software package from
+ * which you obtained this Software ("EULA").
+ *
+ * If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+ * non-transferable license to copy, modify, and compile the Software source
+ * code solely for use in connection with Cypress's integrated circuit products.
+ * Any reproduction, modification, translation, compilation, or representation
+ * of this Software except as specified above is prohibited without the express
+ * written permission of Cypress.
+ *
+ * Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+ * reserves the right to make changes to the Software without notice. Cypress
+ * does not assume any liability arising out of the application or use of the
+ * Software or any product or circuit described in the Software. Cypress does
+ * not authorize its products for use in any products where a malfunction or
+ * failure of the Cypress product may reasonably be expected to result in
+ * significant property damage, injury or death ("High Risk Product"). By
+ * including Cypress's product in a High Risk Product, the manufacturer of such
+ * system or application assumes all risk of such use and in doing so agrees to
+ * indemnify Cypress against all liability.
+ ******************************************************************************/
+
+/* Include header files */
+#include <stdint.h>
+#include "cy_lpa_wifi_ol.h"
+#include "cy_lpa_wifi_arp_ol.h"
+#include "cy_lpa_wifi_pf_ol.h"
+#include "cy_lpa_wifi_tko_ol.h"
+
+#include "wlan_offload_spec.h"
+#include "wlan_offload.h"
+#include "wifi_config.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Filter kinds in the key of a packet filter. */
+#define WLAN_OFFLOAD_PF_KIND_ETHTYPE         (1UL)
+#define WLAN_OFFLOAD_PF_KIND_IPTYPE          (2UL)
+#define WLAN_OFFLOAD_PF_KIND_PORTNUM         (3UL)
+
+/* Integer constant which identifies what a packet filter matches. */
+#define WLAN_OFFLOAD_PF_KEY(kind, number, dir, protocol) \
+    ((WLAN_OFFLOAD_PF_KIND_##kind << 28) | (((uint32_t)(dir) & 0xFUL) << 24) | \
+     (((uint32_t)(protocol) & 0xFFUL) << 16) | ((uint32_t)(number) & 0xFFFFUL))
+
+/* Filter ID of each row of WLAN_OFFLOAD_PF_SPEC. */
+#define WLAN_OFFLOAD_PF_ID(arg, name, kind, number, dir, protocol, active) \
+    WLAN_OFFLOAD_PF_ID_##name,
+
+/* Packet filter configuration of each row of WLAN_OFFLOAD_PF_SPEC. */
+#define WLAN_OFFLOAD_PF_MATCH_ETHTYPE(number, dir, protocol) \
+    .u.eth.eth_type = (number)
+#define WLAN_OFFLOAD_PF_MATCH_IPTYPE(number, dir, protocol) \
+    .u.ip.ip_type = (number)
+#define WLAN_OFFLOAD_PF_MATCH_PORTNUM(number, dir, protocol) \
+    .u.pf.portnum.portnum = (number), .u.pf.portnum.range = 0, .u.pf.portnum.direction = (dir), .u.pf.proto = (protocol)
+
+#define WLAN_OFFLOAD_PF_ENTRY(arg, name, kind, number, dir, protocol, active) \
+    [WLAN_OFFLOAD_PF_ID_##name] = { \
+        .feature = CY_PF_OL_FEAT_##kind, \
+        .bits = (active), \
+        .id = WLAN_OFFLOAD_PF_ID_##name, \
+        WLAN_OFFLOAD_PF_MATCH_##kind(number, dir, protocol) \
+    },
+
+/* Power states in which the rows of WLAN_OFFLOAD_PF_SPEC pass the key. */
+#define WLAN_OFFLOAD_PF_ACTIVE_IF(key, name, kind, number, dir, protocol, active) \
+    | ((WLAN_OFFLOAD_PF_KEY(kind, number, dir, protocol) == (key)) ? (uint32_t)(active) : 0UL)
+#define WLAN_OFFLOAD_PF_ACTIVE_OF(kind, number, dir, protocol) \
+    (0UL WLAN_OFFLOAD_PF_SPEC(WLAN_OFFLOAD_PF_ACTIVE_IF, WLAN_OFFLOAD_PF_KEY(kind, number, dir, protocol)))
+
+/* True if the packet filters pass a flow in all the given power states. */
+#define WLAN_OFFLOAD_PF_PASSES(kind, number, dir, protocol, active) \
+    ((WLAN_OFFLOAD_PF_ACTIVE_OF(kind, number, dir, protocol) & (uint32_t)(active)) == (uint32_t)(active))
+
+/* True if a TCP port has both Source and Destination port filters, active
+ * while the host is awake and sleeping.
+ */
+#define WLAN_OFFLOAD_PF_COVERS_TCP_PORT(port) \
+    (WLAN_OFFLOAD_PF_PASSES(PORTNUM, port, PF_PN_PORT_SOURCE, CY_PF_PROTOCOL_TCP, WLAN_OFFLOAD_PF_ALWAYS) && \
+     WLAN_OFFLOAD_PF_PASSES(PORTNUM, port, PF_PN_PORT_DEST, CY_PF_PROTOCOL_TCP, WLAN_OFFLOAD_PF_ALWAYS))
+
+/* True if a row of WLAN_OFFLOAD_PF_REQUIRED matches the key. */
+#define WLAN_OFFLOAD_PF_REQUIRES(key, kind, number, dir, protocol, active) \
+    || (WLAN_OFFLOAD_PF_KEY(kind, number, dir, protocol) == (key))
+#define WLAN_OFFLOAD_PF_IS_REQUIRED(kind, number, dir, protocol) \
+    (0 WLAN_OFFLOAD_PF_REQUIRED(WLAN_OFFLOAD_PF_REQUIRES, WLAN_OFFLOAD_PF_KEY(kind, number, dir, protocol)))
+
+/* True if a connection of WLAN_OFFLOAD_TKO_SPEC uses the TCP port. */
+#define WLAN_OFFLOAD_TKO_USES(port, index, local, remote, address) \
+    || ((local) == (port)) || ((remote) == (port))
+#define WLAN_OFFLOAD_TKO_USES_PORT(port) \
+    (0 WLAN_OFFLOAD_TKO_SPEC(WLAN_OFFLOAD_TKO_USES, port))
+
+/* True if a packet filter matches a required flow or a port of a TCP
+ * Keepalive offload connection.
+ */
+#define WLAN_OFFLOAD_PF_IS_USED(kind, number, dir, protocol) \
+    (WLAN_OFFLOAD_PF_IS_REQUIRED(kind, number, dir, protocol) || \
+     ((WLAN_OFFLOAD_PF_KIND_##kind == WLAN_OFFLOAD_PF_KIND_PORTNUM) && \
+      (CY_PF_PROTOCOL_TCP == (protocol)) && WLAN_OFFLOAD_TKO_USES_PORT(number)))
+
+/* Connection of each row of WLAN_OFFLOAD_TKO_SPEC. */
+#define WLAN_OFFLOAD_TKO_ENTRY(arg, index, local, remote, address) \
+    .ports[index] = { .local_port = (local), .remote_port = (remote), .remote_ip = address },
+
+/* Case labels of the duplicate checks. */
+#define WLAN_OFFLOAD_PF_CASE(arg, name, kind, number, dir, protocol, active) \
+    case WLAN_OFFLOAD_PF_KEY(kind, number, dir, protocol):
+#define WLAN_OFFLOAD_TKO_CASE(arg, index, local, remote, address) \
+    case (index):
+
+/* Checks of each row of WLAN_OFFLOAD_PF_SPEC and WLAN_OFFLOAD_PF_REQUIRED. */
+#define WLAN_OFFLOAD_PF_CHECK(arg, name, kind, number, dir, protocol, active) \
+    _Static_assert(0 != (active), "Packet filter " #name " is never active"); \
+    _Static_assert(WLAN_OFFLOAD_PF_IS_USED(kind, number, dir, protocol), \
+                   "Packet filter " #name " matches neither a required flow nor a TCP Keepalive offload connection");
+
+#define WLAN_OFFLOAD_PF_CHECK_REQUIRED(arg, kind, number, dir, protocol, active) \
+    _Static_assert(WLAN_OFFLOAD_PF_PASSES(kind, number, dir, protocol, active), \
+                   "The packet filters do not pass the required flow " #kind " " #number);
+
+/* Checks of each row of WLAN_OFFLOAD_TKO_SPEC. */
+#if PACKET_FILTER_OFFLOAD
+#define WLAN_OFFLOAD_TKO_CHECK_FILTERS(local, remote) \
+    _Static_assert(WLAN_OFFLOAD_PF_COVERS_TCP_PORT(local) && WLAN_OFFLOAD_PF_COVERS_TCP_PORT(remote), \
+                   "A TCP Keepalive offload connection needs Source and Destination port filters for both its ports");
+#else
+#define WLAN_OFFLOAD_TKO_CHECK_FILTERS(local, remote)
+#endif
+
+#define WLAN_OFFLOAD_TKO_CHECK(arg, index, local, remote, address) \
+    _Static_assert((index) < MAX_TKO_CONN, "TCP Keepalive offload connection index out of range"); \
+    WLAN_OFFLOAD_TKO_CHECK_FILTERS(local, remote)
+
+/*******************************************************************************
+ * Static Global Structures and variables
+ ******************************************************************************/
+/* Filter IDs, in the order of WLAN_OFFLOAD_PF_SPEC. A name which is used twice
+ * fails the build with a redeclared enumerator.
+ */
+enum
+{
+    WLAN_OFFLOAD_PF_SPEC(WLAN_OFFLOAD_PF_ID, 0)
+    WLAN_OFFLOAD_PF_COUNT
+};
+
+#if PACKET_FILTER_OFFLOAD
+/* The last entry of the packet filter configuration is reserved for the
+ * CY_PF_OL_FEAT_LAST marker.
+ */
+_Static_assert(WLAN_OFFLOAD_PF_COUNT < MAX_PACKET_FILTER, "Too many packet filters in WLAN_OFFLOAD_PF_SPEC");
+
+WLAN_OFFLOAD_PF_SPEC(WLAN_OFFLOAD_PF_CHECK, 0)
+WLAN_OFFLOAD_PF_REQUIRED(WLAN_OFFLOAD_PF_CHECK_REQUIRED, 0)
+#endif
+
+WLAN_OFFLOAD_TKO_SPEC(WLAN_OFFLOAD_TKO_CHECK, 0)
+
+#if ARP_OFFLOAD
+/*
+ * Offload Manager (OLM) configuration for the ARP offload.
+ * The ARP offload is active when the PSoC 6 MCU is awake or sleeping.
+ * Enables ARP agent in the WLAN firmware in Peer Auto Reply mode with
+ * IP Snoop enabled. This means that the WLAN will respond to ARP request
+ * from any clients without soliciting the Host MCU (PSoC 6). With the snoop
+ * being enabled, the WLAN monitors for ARP responses from the Host to the
+ * Network, and caches them in its IP table.
+ */
+static const arp_ol_cfg_t arp_offload_config =
+{
+    .awake_enable_mask = ARP_OL_AWAKE_ENABLE_MASK,
+    .sleep_enable_mask = ARP_OL_SLEEP_ENABLE_MASK,
+    .peerage = ARP_OL_PEER_AGE_SEC,
+};
+
+/* ARP offload context. */
+static arp_ol_t arpol_context;
+#endif
+
+#if PACKET_FILTER_OFFLOAD
+/* Offload Manager (OLM) configuration for the Packet Filter offload. */
+static const cy_pf_ol_cfg_t packet_filter_offload_config[WLAN_OFFLOAD_PF_COUNT + 1] =
+{
+    WLAN_OFFLOAD_PF_SPEC(WLAN_OFFLOAD_PF_ENTRY, 0)
+    [WLAN_OFFLOAD_PF_COUNT] = { .feature = CY_PF_OL_FEAT_LAST },
+};
+
+/* Packet filter offload context. */
+static pf_ol_t pfol_context;
+#endif
+
+/*
+ * Offload Manager (OLM) configuration for the TCP Keepalive offload.
+ *   interval       - The WLAN will send TCP Keepalive packets in every 5 seconds.
+ *   retry_interval - The WLAN will send a retry packet in every 3 seconds,
+ *                    if no ACK was received from the server.
+ *   retry_count    - The WLAN will retry for 3 times before returning error.
+ * The connections are those of WLAN_OFFLOAD_TKO_SPEC.
+ */
+static const cy_tko_ol_cfg_t tcp_keepalive_offload_config =
+{
+    .interval       = TKO_INTERVAL_SECS,
+    .retry_interval = TKO_RETRY_INTERVAL_SECS,
+    .retry_count    = TKO_RETRY_COUNT,
+    WLAN_OFFLOAD_TKO_SPEC(WLAN_OFFLOAD_TKO_ENTRY, 0)
+};
+
+#if TCP_KEEPALIVE_OFFLOAD
+/* TCP Keepalive offload context. */
+static tko_ol_t tkol_context;
+#endif
+
+/* Holds all the offload configuration. The offload manager requires a NULL
+ * entry as the last entry in the list.
+ */
+static const ol_desc_t offload_list[] =
+{
+#if PACKET_FILTER_OFFLOAD
+    { PKT_FILTER_NAME, &packet_filter_offload_config, &pf_ol_fns, &pfol_context },
+#endif
+#if ARP_OFFLOAD
+    { ARP_NAME, &arp_offload_config, &arp_ol_fns, &arpol_context },
+#endif
+#if TCP_KEEPALIVE_OFFLOAD
+    { TKO_NAME, &tcp_keepalive_offload_config, &tko_ol_fns, &tkol_context },
+#endif
+    { NULL, NULL, NULL, NULL },
+};
+
+/*******************************************************************************
+ * Function definitions
+ ******************************************************************************/
+/*******************************************************************************
+* Function Name: wlan_offload_spec_check_duplicates
+********************************************************************************
+* Summary:
+*  Never called. A packet filter or a TCP Keepalive offload connection slot
+*  which is listed twice in the offload specification fails the build with a
+*  duplicate case value.
+*
+* Parameters:
+*  key   : Unused.
+*  index : Unused.
+*
+* Return:
+*  void
+*
+*******************************************************************************/
+static inline void wlan_offload_spec_check_duplicates(uint32_t key, uint32_t index)
+{
+    switch (key)
+    {
+        WLAN_OFFLOAD_PF_SPEC(WLAN_OFFLOAD_PF_CASE, 0)
+        default:
+            break;
+    }
+
+    switch (index)
+    {
+        WLAN_OFFLOAD_TKO_SPEC(WLAN_OFFLOAD_TKO_CASE, 0)
+        default:
+            break;
+    }
+}
+
+/*******************************************************************************
+* Function Name: wlan_offload_spec_get_ol_list
+********************************************************************************
+* Summary:
+*  Returns the offload list of the offload specification. The generated
+*  cycfg_get_default_ol_list() of each board returns this list.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  const ol_desc_t *: Pointer to the first entry of the NULL terminated
+*  offload list.
+*
+*******************************************************************************/
+const ol_desc_t *wlan_offload_spec_get_ol_list(void)
+{
+    return offload_list;
+}
+
+/*******************************************************************************
+* Function Name: wlan_offload_spec_get_tko_config
+********************************************************************************
+* Summary:
+*  Returns the TCP Keepalive offload configuration of the offload
+*  specification. Its connections are established even if the TCP Keepalive
+*  offload is disabled.
+*
+* Parameters:
+*  void
+*
+* Return:
+*  const cy_tko_ol_cfg_t *: TCP Keepalive offload configuration.
+*
+*******************************************************************************/
+const cy_tko_ol_cfg_t *wlan_offload_spec_get_tko_config(void)
+{
+    return &tcp_keepalive_offload_config;
+}
+
+
+/* [] END OF FILE */
+
@@ -0,0 +1,164 @@
+/******************************************************************************
+* File Name: wlan_offload_spec.h
+*
+* Description: This file contains the offload specification: the packet
+* filters and the TCP Keepalive offload connections of the application, as
+* lists from which wlan_offload_spec.c builds the constant offload tables for
+* every board.
+*
+******************************************************************************
+* Copyright (2020), Cypress Semiconductor Corporation.
+******************************************************************************
+* This software, including source code, documentation and related materials
+* (“Software”), is owned by Cypress Semiconductor Corporation or one of its
+* subsidiaries (“Cypress”) and is protected by and subject to worldwide patent
+* protection (United States and foreign), United States copyright laws and
+* international treaty provisions. Therefore, you may use this Software only
+* as provided in the license agreement accompanying the software package from
+* which you obtained this Software (“EULA”).
+*
+* If no EULA applies, Cypress hereby grants you a personal, nonexclusive,
+* non-transferable license to copy, modify, and compile the Software source
+* code solely for use in connection with Cypress’s integrated circuit products.
+* Any reproduction, modification, translation, compilation, or representation
+* of this Software except as specified above is prohibited without the express
+* written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death (“High Risk Product”). By
+* including Cypress’s product in a High Risk Product, the manufacturer of such
+* system or application assumes all risk of such use and in doing so agrees to
+* indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+* Include guard
+*******************************************************************************/
+#ifndef _WLAN_OFFLOAD_SPEC_H_
+#define _WLAN_OFFLOAD_SPEC_H_
+
+#include "cy_lpa_wifi_ol.h"
+#include "cy_lpa_wifi_tko_ol.h"
+#include "wlan_offload.h"
+#include "wifi_config.h"
+
+/*******************************************************************************
+ * Packet filters
+ ******************************************************************************/
+/* Each row of WLAN_OFFLOAD_PF_SPEC is
+ *   X(arg, name, kind, number, dir, protocol, active)
+ *   name     : Unique name of the filter. Its position in the list is its ID.
+ *   kind     : ETHTYPE, IPTYPE, or PORTNUM.
+ *   number   : EtherType, IP protocol number, or port number.
+ *   dir      : PF_PN_PORT_SOURCE or PF_PN_PORT_DEST for PORTNUM, 0 otherwise.
+ *   protocol : CY_PF_PROTOCOL_TCP or CY_PF_PROTOCOL_UDP for PORTNUM, 0 otherwise.
+ *   active   : CY_PF_ACTIVE_SLEEP and/or CY_PF_ACTIVE_WAKE.
+ * The rows are applied in this order. A duplicate filter, a filter which is
+ * never active, or more filters than MAX_PACKET_FILTER allows, fails the build.
+ */
+#define WLAN_OFFLOAD_PF_ALWAYS               (CY_PF_ACTIVE_SLEEP | CY_PF_ACTIVE_WAKE)
+
+#if IPV6_ND_OFFLOAD
+/* IPv6 counterpart of the ARP filter. Neighbor discovery, router advertisements,
+ * and MLD queries are ICMPv6 and must reach the host in both power states. The
+ * rest of the IPv6 traffic is allowed only while the host is awake, so that it
+ * does not wake up the host.
+ */
+#define WLAN_OFFLOAD_PF_SPEC_IPV6(X, arg) \
+    X(arg, ICMPV6,      IPTYPE,  IP_TYPE_ICMPV6,        0,                 0,                  WLAN_OFFLOAD_PF_ALWAYS) \
+    X(arg, IPV6,        ETHTYPE, ETH_TYPE_IPV6_PACKET,  0,                 0,                  CY_PF_ACTIVE_WAKE)
+#else
+#define WLAN_OFFLOAD_PF_SPEC_IPV6(X, arg)
+#endif
+
+#if MQTT_CLIENT
+#define WLAN_OFFLOAD_PF_SPEC_MQTT(X, arg) \
+    X(arg, MQTT_CLIENT_SRC, PORTNUM, PORT_TYPE_MQTT_CLIENT, PF_PN_PORT_SOURCE, CY_PF_PROTOCOL_TCP, WLAN_OFFLOAD_PF_ALWAYS) \
+    X(arg, MQTT_BROKER_DST, PORTNUM, PORT_TYPE_MQTT_BROKER, PF_PN_PORT_DEST,   CY_PF_PROTOCOL_TCP, WLAN_OFFLOAD_PF_ALWAYS) \
+    X(arg, MQTT_CLIENT_DST, PORTNUM, PORT_TYPE_MQTT_CLIENT, PF_PN_PORT_DEST,   CY_PF_PROTOCOL_TCP, WLAN_OFFLOAD_PF_ALWAYS) \
+    X(arg, MQTT_BROKER_SRC, PORTNUM, PORT_TYPE_MQTT_BROKER, PF_PN_PORT_SOURCE, CY_PF_PROTOCOL_TCP, WLAN_OFFLOAD_PF_ALWAYS)
+#else
+#define WLAN_OFFLOAD_PF_SPEC_MQTT(X, arg)
+#endif
+
+/* The first four filters are necessary for a basic Wi-Fi connection to be
+ * established. The DNS responses come from the source port 53 of the server.
+ * The TCP ports are necessary for the connections of WLAN_OFFLOAD_TKO_SPEC.
+ */
+#define WLAN_OFFLOAD_PF_SPEC(X, arg) \
+    X(arg, ARP,         ETHTYPE, ETH_TYPE_ARP_PACKET,   0,                 0,                  WLAN_OFFLOAD_PF_ALWAYS) \
+    X(arg, EAPOL,       ETHTYPE, ETH_TYPE_8021X_PACKET, 0,                 0,                  WLAN_OFFLOAD_PF_ALWAYS) \
+    X(arg, DHCP,        PORTNUM, PORT_TYPE_DHCP_UDP,    PF_PN_PORT_DEST,   CY_PF_PROTOCOL_UDP, WLAN_OFFLOAD_PF_ALWAYS) \
+    X(arg, DNS,         PORTNUM, PORT_TYPE_DNS_UDP,     PF_PN_PORT_SOURCE, CY_PF_PROTOCOL_UDP, WLAN_OFFLOAD_PF_ALWAYS) \
+    WLAN_OFFLOAD_PF_SPEC_IPV6(X, arg) \
+    X(arg, TCP_CLIENT_SRC, PORTNUM, PORT_TYPE_TCP_CLIENT, PF_PN_PORT_SOURCE, CY_PF_PROTOCOL_TCP, WLAN_OFFLOAD_PF_ALWAYS) \
+    X(arg, TCP_SERVER_DST, PORTNUM, PORT_TYPE_TCP_SERVER, PF_PN_PORT_DEST,   CY_PF_PROTOCOL_TCP, WLAN_OFFLOAD_PF_ALWAYS) \
+    X(arg, TCP_CLIENT_DST, PORTNUM, PORT_TYPE_TCP_CLIENT, PF_PN_PORT_DEST,   CY_PF_PROTOCOL_TCP, WLAN_OFFLOAD_PF_ALWAYS) \
+    X(arg, TCP_SERVER_SRC, PORTNUM, PORT_TYPE_TCP_SERVER, PF_PN_PORT_SOURCE, CY_PF_PROTOCOL_TCP, WLAN_OFFLOAD_PF_ALWAYS) \
+    WLAN_OFFLOAD_PF_SPEC_MQTT(X, arg)
+
+/* Each row of WLAN_OFFLOAD_PF_REQUIRED is
+ *   X(arg, kind, number, dir, protocol, active)
+ * and is a flow which the packet filters must pass in the given power states.
+ * The build fails if a flow is not passed, or if a filter matches neither a
+ * required flow nor a port of a WLAN_OFFLOAD_TKO_SPEC connection, so that a
+ * slot is not spent on packets which only wake up the host.
+ */
+#if IPV6_ND_OFFLOAD
+#define WLAN_OFFLOAD_PF_REQUIRED_IPV6(X, arg) \
+    X(arg, IPTYPE,  IP_TYPE_ICMPV6,        0,                 0,                  WLAN_OFFLOAD_PF_ALWAYS) \
+    X(arg, ETHTYPE, ETH_TYPE_IPV6_PACKET,  0,                 0,                  CY_PF_ACTIVE_WAKE)
+#else
+#define WLAN_OFFLOAD_PF_REQUIRED_IPV6(X, arg)
+#endif
+
+#define WLAN_OFFLOAD_PF_REQUIRED(X, arg) \
+    X(arg, ETHTYPE, ETH_TYPE_ARP_PACKET,   0,                 0,                  WLAN_OFFLOAD_PF_ALWAYS) \
+    X(arg, ETHTYPE, ETH_TYPE_8021X_PACKET, 0,                 0,                  WLAN_OFFLOAD_PF_ALWAYS) \
+    X(arg, PORTNUM, PORT_TYPE_DHCP_UDP,    PF_PN_PORT_DEST,   CY_PF_PROTOCOL_UDP, WLAN_OFFLOAD_PF_ALWAYS) \
+    X(arg, PORTNUM, PORT_TYPE_DNS_UDP,     PF_PN_PORT_SOURCE, CY_PF_PROTOCOL_UDP, WLAN_OFFLOAD_PF_ALWAYS) \
+    WLAN_OFFLOAD_PF_REQUIRED_IPV6(X, arg)
+
+/*******************************************************************************
+ * TCP Keepalive offload connections
+ ******************************************************************************/
+/* Each row of WLAN_OFFLOAD_TKO_SPEC is
+ *   X(arg, index, local, remote, address)
+ *   index   : Connection slot, below MAX_TKO_CONN.
+ *   local   : Local port number (TCP client).
+ *   remote  : Remote port number (TCP server).
+ *   address : Remote TCP server IP address.
+ * The application establishes these connections whether or not
+ * TCP_KEEPALIVE_OFFLOAD is enabled. Both of their ports need Source and
+ * Destination port filters in WLAN_OFFLOAD_PF_SPEC, active while the host is
+ * awake and sleeping, which the build checks.
+ */
+#if MQTT_CLIENT
+#define WLAN_OFFLOAD_TKO_SPEC_MQTT(X, arg) \
+    X(arg, TKO_MQTT_CONN_INDEX, MQTT_CLIENT_PORT_NUMBER, MQTT_BROKER_PORT_NUMBER, MQTT_BROKER_IP_ADDRESS)
+#else
+#define WLAN_OFFLOAD_TKO_SPEC_MQTT(X, arg)
+#endif
+
+#define WLAN_OFFLOAD_TKO_SPEC(X, arg) \
+    X(arg, 0, TCP_CLIENT_PORT_NUMBER, TCP_SERVER_PORT_NUMBER, REMOTE_TCP_SERVER_IP_ADDRESS) \
+    WLAN_OFFLOAD_TKO_SPEC_MQTT(X, arg)
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+const ol_desc_t *wlan_offload_spec_get_ol_list(void);
+const cy_tko_ol_cfg_t *wlan_offload_spec_get_tko_config(void);
+
+#endif /* _WLAN_OFFLOAD_SPEC_H_ */
+
+
+/* [] END OF FILE */
+